@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.cpp
+// ============
+// store generated and optimized mesh data in a binary file so that
+// later runs can upload it straight from a memory mapping
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshCache.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+	const char g_MeshCacheMagic[4] = { 'S', 'M', 'C', 'H' };
+	// increase when the layout of the file changes
+	const uint32_t g_MeshCacheVersion = 2;
+}
+
+/***********************************************************
+ *  MeshCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshCache::MeshCache()
+{
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping the cache file.  A file
+ *  that is missing, from another version or format, or
+ *  damaged is treated as an empty cache, and is replaced
+ *  when the cache is closed.
+ ***********************************************************/
+bool MeshCache::Open(const char* filename, uint32_t formatTag)
+{
+	CacheFile::Format format;
+	memcpy(format.magic, g_MeshCacheMagic, sizeof(g_MeshCacheMagic));
+	format.version = g_MeshCacheVersion;
+	format.formatTag = formatTag;
+	format.entrySize = sizeof(Entry);
+	format.nBlocks = 2;
+	format.blockFields[0] = offsetof(Entry, vertexOffset);
+	format.blockFields[1] = offsetof(Entry, indexOffset);
+
+	if (m_file.Open(filename, format) == false)
+	{
+		return(false);
+	}
+
+	for (uint32_t i = 0; i < m_file.GetEntryCount(); i++)
+	{
+		const Entry* pEntry = (const Entry*)m_file.GetEntry(i);
+		if (pEntry->nParts > MeshData::MAX_PARTS)
+		{
+			m_file.DropEntries();
+			return(false);
+		}
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  FindMesh()
+ *
+ *  This method is used for finding a cached mesh by key.
+ *  Found entries are kept when the file is rewritten.
+ ***********************************************************/
+const MeshCache::Entry* MeshCache::FindMesh(uint64_t key)
+{
+	return((const Entry*)m_file.FindEntry(key));
+}
+
+/***********************************************************
+ *  GetData()
+ *
+ *  This method is used for getting a pointer into the
+ *  mapped file, valid until the cache is closed.
+ ***********************************************************/
+const void* MeshCache::GetData(uint64_t offset) const
+{
+	return(m_file.GetData(offset));
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for copying a mesh into the list of
+ *  meshes to write when the cache is closed.
+ ***********************************************************/
+void MeshCache::AddMesh(
+	const Entry& entry,
+	const void* vertices,
+	const void* indices)
+{
+	const void* blocks[2] = { vertices, indices };
+	m_file.AddEntry(&entry, blocks);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for writing the used and added
+ *  meshes to the cache file, when any were added, and
+ *  releasing the mapping.
+ ***********************************************************/
+bool MeshCache::Close()
+{
+	return(m_file.Close());
+}
+
+/***********************************************************
+ *  MakeKey()
+ *
+ *  This method is used for hashing the passed in generator
+ *  parameters into a 64-bit key.
+ ***********************************************************/
+uint64_t MeshCache::MakeKey(const uint32_t* values, size_t nValues)
+{
+	return(CacheFile::MakeKey(values, nValues * sizeof(uint32_t)));
+}
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.h
+// ============
+// store generated and optimized mesh data in a binary file so that
+// later runs can upload it straight from a memory mapping
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+#include "CacheFile.h"
+
+#include <cstdint>
+
+/***********************************************************
+ *  MeshCache
+ *
+ *  This class contains the code for reading and writing the
+ *  mesh cache file.  The file starts with a header, followed
+ *  by a table of entries and then the vertex and index data
+ *  of every entry, already in the format it is uploaded in.
+ *  Entries are looked up by a key computed from the
+ *  parameters the mesh was generated from, so a mesh with
+ *  changed parameters is simply not found.  When meshes are
+ *  added, closing the cache rewrites the file with only the
+ *  entries used during this run.  The file itself is read
+ *  and written by CacheFile.
+ ***********************************************************/
+class MeshCache
+{
+public:
+	// constructor
+	MeshCache();
+
+	// the description of one cached mesh as stored in the file
+	struct Entry
+	{
+		uint64_t key;			// key of the generator parameters
+		uint32_t nVertices;		// number of vertices
+		uint32_t nIndices;		// number of indices
+		uint32_t indexType;		// GL type of the stored indices
+		uint32_t nParts;		// number of used index ranges
+		MeshPart parts[MeshData::MAX_PARTS];	// index ranges of the mesh parts
+		float boundsCenter[3];	// center of the bounding sphere
+		float boundsRadius;		// radius of the bounding sphere
+		float boundsExtent[3];	// half size of the bounding box around the center
+		uint32_t reserved;
+		uint64_t vertexOffset;	// file offset of the vertex data
+		uint64_t vertexBytes;	// size of the vertex data
+		uint64_t indexOffset;	// file offset of the index data
+		uint64_t indexBytes;	// size of the index data
+	};
+
+	// map the passed in cache file, keeping only its entries
+	// that were written with the same format tag
+	bool Open(const char* filename, uint32_t formatTag);
+	// write the cache file if meshes were added and release it
+	bool Close();
+	bool IsOpen() const { return(m_file.IsOpen()); }
+
+	// find the cached mesh with the passed in key
+	const Entry* FindMesh(uint64_t key);
+	// get a pointer to the data at a file offset of an entry
+	const void* GetData(uint64_t offset) const;
+	// add a mesh to be written when the cache is closed
+	void AddMesh(
+		const Entry& entry,
+		const void* vertices,
+		const void* indices);
+
+	// combine the passed in generator parameters into a key
+	static uint64_t MakeKey(const uint32_t* values, size_t nValues);
+
+private:
+	// the file with the entry table and the mesh data
+	CacheFile m_file;
+};
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshdata.h
+// ============
+// CPU side storage for generated mesh geometry before it is uploaded
+// into OpenGL buffers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  MeshPart
+ *
+ *  A contiguous range of triangle list indices, such as the
+ *  top cap, bottom cap or sides of a cylinder.
+ ***********************************************************/
+struct MeshPart
+{
+	GLuint firstIndex;	// offset of the first index in the range
+	GLuint indexCount;	// number of indices in the range
+};
+
+/***********************************************************
+ *  MeshData
+ *
+ *  Interleaved vertex data (position, normal, texture coords)
+ *  and triangle list indices for one mesh.  The vectors keep
+ *  their capacity between Reset() calls so a single MeshData
+ *  can be reused for every generated mesh.
+ ***********************************************************/
+struct MeshData
+{
+	// number of floats stored for every vertex
+	static const GLuint FLOATS_PER_VERTEX = 8;
+	// maximum number of index ranges tracked per mesh
+	static const GLuint MAX_PARTS = 4;
+
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	MeshPart parts[MAX_PARTS];
+	GLuint nParts;
+
+	MeshData()
+	{
+		nParts = 0;
+	}
+
+	// size the buffers for the next mesh without
+	// releasing the previously allocated memory
+	void Reset(size_t nVertices, size_t nIndices)
+	{
+		vertices.resize(nVertices * FLOATS_PER_VERTEX);
+		indices.resize(nIndices);
+		nParts = 0;
+	}
+
+	// record an index range for a sub part of the mesh
+	void AddPart(GLuint firstIndex, GLuint indexCount)
+	{
+		if (nParts < MAX_PARTS)
+		{
+			parts[nParts].firstIndex = firstIndex;
+			parts[nParts].indexCount = indexCount;
+			nParts++;
+		}
+	}
+
+	GLuint VertexCount() const
+	{
+		return (GLuint)(vertices.size() / FLOATS_PER_VERTEX);
+	}
+
+	GLuint IndexCount() const
+	{
+		return (GLuint)indices.size();
+	}
+};
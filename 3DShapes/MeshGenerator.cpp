@@ -0,0 +1,523 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.cpp
+// ============
+// procedurally generate the vertex and index data for the round
+// 3D primitives: cone, cylinder, sphere, tapered cylinder, torus
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const float g_Pi = 3.14159265358979323846f;
+	const float g_TwoPi = 6.28318530717958647692f;
+}
+
+/***********************************************************
+ *  MeshGenerator()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshGenerator::MeshGenerator()
+{
+}
+
+/***********************************************************
+ *  BuildAngleTable()
+ *
+ *  This method is used for filling the sine and cosine lookup
+ *  tables for count+1 angles, so the last entry repeats the
+ *  first one for the texture seam.
+ ***********************************************************/
+void MeshGenerator::BuildAngleTable(GLuint count, float startAngle)
+{
+	BuildAngleTable(m_sinTable, m_cosTable, count, startAngle);
+}
+
+void MeshGenerator::BuildAngleTable(
+	std::vector<float>& sinTable,
+	std::vector<float>& cosTable,
+	GLuint count,
+	float startAngle)
+{
+	sinTable.resize(count + 1);
+	cosTable.resize(count + 1);
+
+	const float step = g_TwoPi / (float)count;
+	for (GLuint i = 0; i < count; i++)
+	{
+		float angle = startAngle + step * (float)i;
+		sinTable[i] = sinf(angle);
+		cosTable[i] = cosf(angle);
+	}
+	// close the loop exactly so the seam vertices line up
+	sinTable[count] = sinTable[0];
+	cosTable[count] = cosTable[0];
+}
+
+/***********************************************************
+ *  EmitCap()
+ *
+ *  This method is used for writing a flat disc made of a
+ *  center vertex and a ring of edge vertices.  The texture
+ *  coordinates are a planar projection of the disc.
+ ***********************************************************/
+void MeshGenerator::EmitCap(
+	MeshData& mesh,
+	GLuint segments,
+	float radius,
+	float y,
+	float normalY,
+	GLuint firstVertex,
+	GLuint firstIndex)
+{
+	GLfloat* v = &mesh.vertices[firstVertex * MeshData::FLOATS_PER_VERTEX];
+	const float* sinTable = m_sinTable.data();
+	const float* cosTable = m_cosTable.data();
+
+	// center vertex
+	v[0] = 0.0f;	v[1] = y;		v[2] = 0.0f;
+	v[3] = 0.0f;	v[4] = normalY;	v[5] = 0.0f;
+	v[6] = 0.5f;	v[7] = 0.5f;
+	v += MeshData::FLOATS_PER_VERTEX;
+
+	// edge vertices
+	for (GLuint i = 0; i < segments; i++)
+	{
+		v[0] = radius * cosTable[i];
+		v[1] = y;
+		v[2] = -radius * sinTable[i];
+		v[3] = 0.0f;
+		v[4] = normalY;
+		v[5] = 0.0f;
+		v[6] = 0.5f - 0.5f * sinTable[i];
+		v[7] = 0.5f + 0.5f * cosTable[i];
+		v += MeshData::FLOATS_PER_VERTEX;
+	}
+
+	// one triangle per segment, wound to face along the normal
+	GLuint* idx = &mesh.indices[firstIndex];
+	for (GLuint i = 0; i < segments; i++)
+	{
+		GLuint current = firstVertex + 1 + i;
+		GLuint next = firstVertex + 1 + ((i + 1) % segments);
+		idx[0] = firstVertex;
+		idx[1] = (normalY > 0.0f) ? current : next;
+		idx[2] = (normalY > 0.0f) ? next : current;
+		idx += 3;
+	}
+}
+
+/***********************************************************
+ *  EmitSides()
+ *
+ *  This method is used for writing the sides of a tube whose
+ *  radius changes linearly from bottomRadius at y=0 to
+ *  topRadius at y=1.  A zero topRadius produces a cone with
+ *  a single triangle per segment.
+ ***********************************************************/
+void MeshGenerator::EmitSides(
+	MeshData& mesh,
+	GLuint segments,
+	float bottomRadius,
+	float topRadius,
+	GLuint firstVertex,
+	GLuint firstIndex)
+{
+	GLfloat* v = &mesh.vertices[firstVertex * MeshData::FLOATS_PER_VERTEX];
+	const float* sinTable = m_sinTable.data();
+	const float* cosTable = m_cosTable.data();
+
+	// the side slope is the same all the way around, so the
+	// normal only needs to be rotated by the segment angle
+	float slope = bottomRadius - topRadius;
+	float normalScale = 1.0f / sqrtf(1.0f + slope * slope);
+	float normalXZ = normalScale;
+	float normalY = slope * normalScale;
+
+	// bottom ring followed by top ring, with a duplicated
+	// seam column for the texture coordinates
+	for (GLuint ring = 0; ring < 2; ring++)
+	{
+		float radius = (ring == 0) ? bottomRadius : topRadius;
+		float y = (float)ring;
+		float invSegments = 1.0f / (float)segments;
+		for (GLuint i = 0; i <= segments; i++)
+		{
+			v[0] = radius * cosTable[i];
+			v[1] = y;
+			v[2] = -radius * sinTable[i];
+			v[3] = normalXZ * cosTable[i];
+			v[4] = normalY;
+			v[5] = -normalXZ * sinTable[i];
+			v[6] = (float)i * invSegments;
+			v[7] = y;
+			v += MeshData::FLOATS_PER_VERTEX;
+		}
+	}
+
+	GLuint* idx = &mesh.indices[firstIndex];
+	GLuint bottom = firstVertex;
+	GLuint top = firstVertex + segments + 1;
+	for (GLuint i = 0; i < segments; i++)
+	{
+		idx[0] = bottom + i;
+		idx[1] = bottom + i + 1;
+		idx[2] = top + i + 1;
+		idx += 3;
+		if (topRadius > 0.0f)
+		{
+			idx[0] = bottom + i;
+			idx[1] = top + i + 1;
+			idx[2] = top + i;
+			idx += 3;
+		}
+	}
+}
+
+/***********************************************************
+ *  GenerateSphere()
+ *
+ *  This method is used for generating a UV sphere with the
+ *  passed in number of slices around and stacks from pole to
+ *  pole.  The triangles are ordered from the top down so the
+ *  first half of the indices covers the upper hemisphere when
+ *  the number of stacks is even.
+ ***********************************************************/
+void MeshGenerator::GenerateSphere(
+	MeshData& mesh,
+	GLuint slices,
+	GLuint stacks)
+{
+	if (slices < 3)
+	{
+		slices = 3;
+	}
+	if (stacks < 2)
+	{
+		stacks = 2;
+	}
+
+	const GLuint ringVertices = slices + 1;
+	const GLuint rings = stacks - 1;
+	const GLuint nVertices = 2 + rings * ringVertices;
+	const GLuint nIndices = 6 * slices * rings;
+	mesh.Reset(nVertices, nIndices);
+
+	// the rings start and end on the back seam (-z) so the
+	// texture seam is hidden behind the object
+	BuildAngleTable(slices, -g_Pi);
+	const float* sinTable = m_sinTable.data();
+	const float* cosTable = m_cosTable.data();
+
+	GLfloat* v = mesh.vertices.data();
+
+	// top center point
+	v[0] = 0.0f;	v[1] = 1.0f;	v[2] = 0.0f;
+	v[3] = 0.0f;	v[4] = 1.0f;	v[5] = 0.0f;
+	v[6] = 0.5f;	v[7] = 1.0f;
+	v += MeshData::FLOATS_PER_VERTEX;
+
+	for (GLuint ring = 1; ring <= rings; ring++)
+	{
+		float phi = g_Pi * (float)ring / (float)stacks;
+		float y = cosf(phi);
+		float radius = sinf(phi);
+		float texV = 1.0f - (float)ring / (float)stacks;
+		// the u coordinate spreads with the ring radius around the
+		// front of the sphere, matching the original sphere mapping
+		float uStep = radius / (float)slices;
+		float uStart = 0.5f - 0.5f * radius;
+
+		for (GLuint i = 0; i < ringVertices; i++)
+		{
+			float x = radius * sinTable[i];
+			float z = radius * cosTable[i];
+			v[0] = x;
+			v[1] = y;
+			v[2] = z;
+			v[3] = x;
+			v[4] = y;
+			v[5] = z;
+			v[6] = uStart + uStep * (float)i;
+			v[7] = texV;
+			v += MeshData::FLOATS_PER_VERTEX;
+		}
+	}
+
+	// bottom center point
+	v[0] = 0.0f;	v[1] = -1.0f;	v[2] = 0.0f;
+	v[3] = 0.0f;	v[4] = -1.0f;	v[5] = 0.0f;
+	v[6] = 0.5f;	v[7] = 0.0f;
+
+	GLuint* idx = mesh.indices.data();
+	const GLuint bottomPole = nVertices - 1;
+
+	// top cap
+	for (GLuint i = 0; i < slices; i++)
+	{
+		idx[0] = 0;
+		idx[1] = 1 + i;
+		idx[2] = 2 + i;
+		idx += 3;
+	}
+
+	// bands between neighbouring rings
+	for (GLuint ring = 0; ring + 1 < rings; ring++)
+	{
+		GLuint upper = 1 + ring * ringVertices;
+		GLuint lower = upper + ringVertices;
+		for (GLuint i = 0; i < slices; i++)
+		{
+			idx[0] = upper + i;
+			idx[1] = lower + i;
+			idx[2] = lower + i + 1;
+			idx[3] = upper + i;
+			idx[4] = lower + i + 1;
+			idx[5] = upper + i + 1;
+			idx += 6;
+		}
+	}
+
+	// bottom cap
+	GLuint lastRing = 1 + (rings - 1) * ringVertices;
+	for (GLuint i = 0; i < slices; i++)
+	{
+		idx[0] = lastRing + i;
+		idx[1] = bottomPole;
+		idx[2] = lastRing + i + 1;
+		idx += 3;
+	}
+
+	mesh.AddPart(0, nIndices / 2);
+	mesh.AddPart(nIndices / 2, nIndices - nIndices / 2);
+}
+
+/***********************************************************
+ *  GenerateCylinder()
+ *
+ *  This method is used for generating a capped cylinder with
+ *  the passed in number of segments around.
+ ***********************************************************/
+void MeshGenerator::GenerateCylinder(
+	MeshData& mesh,
+	GLuint segments)
+{
+	GenerateTaperedCylinder(mesh, segments, 1.0f);
+}
+
+/***********************************************************
+ *  GenerateCone()
+ *
+ *  This method is used for generating a cone with a bottom cap
+ *  and the passed in number of segments around.
+ ***********************************************************/
+void MeshGenerator::GenerateCone(
+	MeshData& mesh,
+	GLuint segments)
+{
+	if (segments < 3)
+	{
+		segments = 3;
+	}
+
+	const GLuint capVertices = segments + 1;
+	const GLuint capIndices = segments * 3;
+	const GLuint sideVertices = 2 * (segments + 1);
+	const GLuint sideIndices = segments * 3;
+	mesh.Reset(capVertices + sideVertices, capIndices + sideIndices);
+
+	BuildAngleTable(segments, 0.0f);
+	EmitCap(mesh, segments, 1.0f, 0.0f, -1.0f, 0, 0);
+	EmitSides(mesh, segments, 1.0f, 0.0f, capVertices, capIndices);
+
+	mesh.AddPart(0, capIndices);
+	// cones have no top, keep the part numbering of the other
+	// capped meshes with an empty range
+	mesh.AddPart(capIndices, 0);
+	mesh.AddPart(capIndices, sideIndices);
+}
+
+/***********************************************************
+ *  GenerateTaperedCylinder()
+ *
+ *  This method is used for generating a capped cylinder whose
+ *  top radius differs from its bottom radius.
+ ***********************************************************/
+void MeshGenerator::GenerateTaperedCylinder(
+	MeshData& mesh,
+	GLuint segments,
+	float topRadius)
+{
+	if (segments < 3)
+	{
+		segments = 3;
+	}
+
+	const GLuint capVertices = segments + 1;
+	const GLuint capIndices = segments * 3;
+	const GLuint sideVertices = 2 * (segments + 1);
+	const GLuint sideIndices = segments * 6;
+	mesh.Reset(2 * capVertices + sideVertices, 2 * capIndices + sideIndices);
+
+	BuildAngleTable(segments, 0.0f);
+	EmitCap(mesh, segments, 1.0f, 0.0f, -1.0f, 0, 0);
+	EmitCap(mesh, segments, topRadius, 1.0f, 1.0f, capVertices, capIndices);
+	EmitSides(mesh, segments, 1.0f, topRadius, 2 * capVertices, 2 * capIndices);
+
+	mesh.AddPart(0, capIndices);
+	mesh.AddPart(capIndices, capIndices);
+	mesh.AddPart(2 * capIndices, sideIndices);
+}
+
+/***********************************************************
+ *  GenerateTorus()
+ *
+ *  This method is used for generating an indexed torus.  Each
+ *  grid vertex is shared by the four quads around it, with a
+ *  duplicated seam row and column for the texture coordinates,
+ *  and the normals point away from the center of the tube.
+ *  The triangles are ordered by main segment so the first
+ *  half of the indices covers half of the ring.
+ ***********************************************************/
+void MeshGenerator::GenerateTorus(
+	MeshData& mesh,
+	GLuint mainSegments,
+	GLuint tubeSegments,
+	float tubeRadius)
+{
+	if (mainSegments < 3)
+	{
+		mainSegments = 3;
+	}
+	if (tubeSegments < 3)
+	{
+		tubeSegments = 3;
+	}
+
+	const float mainRadius = 1.0f;
+	const GLuint rowVertices = tubeSegments + 1;
+	const GLuint nVertices = (mainSegments + 1) * rowVertices;
+	const GLuint nIndices = 6 * mainSegments * tubeSegments;
+	mesh.Reset(nVertices, nIndices);
+
+	BuildAngleTable(m_sinTable, m_cosTable, mainSegments, 0.0f);
+	BuildAngleTable(m_tubeSinTable, m_tubeCosTable, tubeSegments, 0.0f);
+	const float* sinMain = m_sinTable.data();
+	const float* cosMain = m_cosTable.data();
+	const float* sinTube = m_tubeSinTable.data();
+	const float* cosTube = m_tubeCosTable.data();
+
+	GLfloat* v = mesh.vertices.data();
+	const float uStep = 1.0f / (float)mainSegments;
+	const float vStep = 1.0f / (float)tubeSegments;
+	for (GLuint i = 0; i <= mainSegments; i++)
+	{
+		for (GLuint j = 0; j < rowVertices; j++)
+		{
+			float ringRadius = mainRadius + tubeRadius * cosTube[j];
+			float nx = cosTube[j] * cosMain[i];
+			float ny = cosTube[j] * sinMain[i];
+			float nz = sinTube[j];
+			v[0] = ringRadius * cosMain[i];
+			v[1] = ringRadius * sinMain[i];
+			v[2] = tubeRadius * sinTube[j];
+			v[3] = nx;
+			v[4] = ny;
+			v[5] = nz;
+			v[6] = (float)i * uStep;
+			v[7] = (float)j * vStep;
+			v += MeshData::FLOATS_PER_VERTEX;
+		}
+	}
+
+	GLuint* idx = mesh.indices.data();
+	for (GLuint i = 0; i < mainSegments; i++)
+	{
+		GLuint current = i * rowVertices;
+		GLuint next = current + rowVertices;
+		for (GLuint j = 0; j < tubeSegments; j++)
+		{
+			idx[0] = current + j;
+			idx[1] = next + j;
+			idx[2] = next + j + 1;
+			idx[3] = current + j;
+			idx[4] = next + j + 1;
+			idx[5] = current + j + 1;
+			idx += 6;
+		}
+	}
+
+	GLuint halfIndices = 6 * (mainSegments / 2) * tubeSegments;
+	mesh.AddPart(0, halfIndices);
+	mesh.AddPart(halfIndices, nIndices - halfIndices);
+}
+
+/***********************************************************
+ *  BuildFromArrays()
+ *
+ *  This method is used for copying a hand-authored indexed
+ *  mesh into the mesh data.
+ ***********************************************************/
+void MeshGenerator::BuildFromArrays(
+	MeshData& mesh,
+	const GLfloat* verts,
+	GLuint nVertices,
+	const GLuint* indices,
+	GLuint nIndices)
+{
+	mesh.Reset(nVertices, nIndices);
+	std::copy(verts, verts + nVertices * MeshData::FLOATS_PER_VERTEX, mesh.vertices.begin());
+	std::copy(indices, indices + nIndices, mesh.indices.begin());
+	mesh.AddPart(0, nIndices);
+}
+
+/***********************************************************
+ *  BuildFromStrip()
+ *
+ *  This method is used for converting a hand-authored triangle
+ *  strip into triangle list indices.  Every other triangle of
+ *  a strip has its winding flipped, and the zero-area triangles
+ *  the strips use to jump between faces are dropped.
+ ***********************************************************/
+void MeshGenerator::BuildFromStrip(
+	MeshData& mesh,
+	const GLfloat* verts,
+	GLuint nVertices)
+{
+	GLuint maxTriangles = (nVertices > 2) ? nVertices - 2 : 0;
+	mesh.Reset(nVertices, maxTriangles * 3);
+	std::copy(verts, verts + nVertices * MeshData::FLOATS_PER_VERTEX, mesh.vertices.begin());
+
+	GLuint nIndices = 0;
+	for (GLuint i = 0; i < maxTriangles; i++)
+	{
+		GLuint a = (i % 2 == 0) ? i : i + 1;
+		GLuint b = (i % 2 == 0) ? i + 1 : i;
+		GLuint c = i + 2;
+
+		const GLfloat* pa = &verts[a * MeshData::FLOATS_PER_VERTEX];
+		const GLfloat* pb = &verts[b * MeshData::FLOATS_PER_VERTEX];
+		const GLfloat* pc = &verts[c * MeshData::FLOATS_PER_VERTEX];
+		float e1x = pb[0] - pa[0], e1y = pb[1] - pa[1], e1z = pb[2] - pa[2];
+		float e2x = pc[0] - pa[0], e2y = pc[1] - pa[1], e2z = pc[2] - pa[2];
+		float cx = e1y * e2z - e1z * e2y;
+		float cy = e1z * e2x - e1x * e2z;
+		float cz = e1x * e2y - e1y * e2x;
+		if ((cx * cx + cy * cy + cz * cz) == 0.0f)
+		{
+			continue;
+		}
+
+		mesh.indices[nIndices++] = a;
+		mesh.indices[nIndices++] = b;
+		mesh.indices[nIndices++] = c;
+	}
+
+	mesh.indices.resize(nIndices);
+	mesh.AddPart(0, nIndices);
+}
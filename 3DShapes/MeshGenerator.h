@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.h
+// ============
+// procedurally generate the vertex and index data for the round
+// 3D primitives: cone, cylinder, sphere, tapered cylinder, torus
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+#include <vector>
+
+/***********************************************************
+ *  MeshGenerator
+ *
+ *  This class contains the code for generating parametric
+ *  primitive meshes at any density.  The sine and cosine of
+ *  every segment angle are computed once per call into lookup
+ *  tables, and the vertices are written straight into the
+ *  interleaved buffer of the passed in MeshData.
+ ***********************************************************/
+class MeshGenerator
+{
+public:
+	// constructor
+	MeshGenerator();
+
+	// unit sphere centered on the origin, split into
+	// top and bottom hemisphere parts
+	void GenerateSphere(
+		MeshData& mesh,
+		GLuint slices,
+		GLuint stacks);
+
+	// cylinder of radius 1 from y=0 to y=1, split into
+	// bottom, top and sides parts
+	void GenerateCylinder(
+		MeshData& mesh,
+		GLuint segments);
+
+	// cone of radius 1 from y=0 to the tip at y=1, split
+	// into bottom and sides parts
+	void GenerateCone(
+		MeshData& mesh,
+		GLuint segments);
+
+	// cylinder of radius 1 at y=0 narrowing to topRadius at
+	// y=1, split into bottom, top and sides parts
+	void GenerateTaperedCylinder(
+		MeshData& mesh,
+		GLuint segments,
+		float topRadius = 0.5f);
+
+	// welded torus in the XY plane with a main radius of 1
+	// and the passed in tube radius, split into the first and
+	// second half of the main ring
+	void GenerateTorus(
+		MeshData& mesh,
+		GLuint mainSegments,
+		GLuint tubeSegments,
+		float tubeRadius);
+
+	// copy hand-authored interleaved vertices and triangle
+	// list indices into the mesh as a single part
+	void BuildFromArrays(
+		MeshData& mesh,
+		const GLfloat* verts,
+		GLuint nVertices,
+		const GLuint* indices,
+		GLuint nIndices);
+
+	// copy hand-authored interleaved vertices that are drawn
+	// as a triangle strip, converting the strip into triangle
+	// list indices as a single part
+	void BuildFromStrip(
+		MeshData& mesh,
+		const GLfloat* verts,
+		GLuint nVertices);
+
+	// the parts generated for the capped meshes
+	enum CAPPED_PARTS
+	{
+		PART_BOTTOM = 0,
+		PART_TOP = 1,
+		PART_SIDES = 2
+	};
+
+	// the parts generated for the sphere mesh
+	enum SPHERE_PARTS
+	{
+		PART_TOP_HALF = 0,
+		PART_BOTTOM_HALF = 1
+	};
+
+	// the parts generated for the torus mesh
+	enum TORUS_PARTS
+	{
+		PART_FIRST_HALF = 0,
+		PART_SECOND_HALF = 1
+	};
+
+private:
+	// precomputed sine and cosine values for the segment angles
+	std::vector<float> m_sinTable;
+	std::vector<float> m_cosTable;
+	// second set of tables for meshes swept around two axes
+	std::vector<float> m_tubeSinTable;
+	std::vector<float> m_tubeCosTable;
+
+	// fill the lookup tables with count+1 evenly spaced angles
+	// starting at startAngle and covering a full turn
+	void BuildAngleTable(GLuint count, float startAngle);
+	void BuildAngleTable(
+		std::vector<float>& sinTable,
+		std::vector<float>& cosTable,
+		GLuint count,
+		float startAngle);
+
+	// write a disc at height y into the mesh, starting at
+	// the passed in vertex and index offsets
+	void EmitCap(
+		MeshData& mesh,
+		GLuint segments,
+		float radius,
+		float y,
+		float normalY,
+		GLuint firstVertex,
+		GLuint firstIndex);
+
+	// write the sides of a (possibly tapered) tube into the
+	// mesh, starting at the passed in vertex and index offsets
+	void EmitSides(
+		MeshData& mesh,
+		GLuint segments,
+		float bottomRadius,
+		float topRadius,
+		GLuint firstVertex,
+		GLuint firstIndex);
+};
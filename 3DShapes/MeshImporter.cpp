@@ -0,0 +1,1060 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshimporter.cpp
+// ============
+// import triangle meshes from Wavefront OBJ and binary glTF files into
+// the interleaved position, normal, texture coordinate layout
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshImporter.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+	// files smaller than this are parsed on the calling thread
+	const size_t g_MinBytesPerThread = 1 << 20;
+	// fewest glTF vertices converted by each thread
+	const size_t g_MinVerticesPerThread = 1 << 16;
+
+	// glTF constants
+	const uint32_t g_GLBMagic = 0x46546C67;		// "glTF"
+	const uint32_t g_GLBChunkJSON = 0x4E4F534A;	// "JSON"
+	const uint32_t g_GLBChunkBIN = 0x004E4942;	// "BIN\0"
+	const int g_GLTFTriangles = 4;
+	const int g_GLTFByte = 5120;
+	const int g_GLTFUnsignedByte = 5121;
+	const int g_GLTFShort = 5122;
+	const int g_GLTFUnsignedShort = 5123;
+	const int g_GLTFUnsignedInt = 5125;
+	const int g_GLTFFloat = 5126;
+
+	/***********************************************************
+	 *  ParallelFor()
+	 *
+	 *  Split the range from 0 to count into one block per
+	 *  hardware thread, with at least minPerThread items in
+	 *  each, and call func(begin, end) for every block.
+	 ***********************************************************/
+	template<typename Function>
+	void ParallelFor(size_t count, size_t minPerThread, Function func)
+	{
+		size_t nThreads = (std::max)(std::thread::hardware_concurrency(), 1u);
+		nThreads = (std::min)(nThreads, count / (std::max)(minPerThread, (size_t)1));
+		if (nThreads <= 1)
+		{
+			func((size_t)0, count);
+			return;
+		}
+
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < nThreads; i++)
+		{
+			threads.push_back(std::thread(func, count * i / nThreads, count * (i + 1) / nThreads));
+		}
+		func((size_t)0, count / nThreads);
+		for (size_t i = 0; i < threads.size(); i++)
+		{
+			threads[i].join();
+		}
+	}
+
+	/***********************************************************
+	 *  Number parsing
+	 *
+	 *  The mapped file is not null terminated, so the numbers
+	 *  are parsed with explicit end pointers.
+	 ***********************************************************/
+	const char* SkipSpaces(const char* p, const char* end)
+	{
+		while ((p < end) && ((*p == ' ') || (*p == '\t') || (*p == '\r')))
+		{
+			p++;
+		}
+		return(p);
+	}
+
+	const char* ParseInt(const char* p, const char* end, int& value)
+	{
+		bool bNegative = false;
+		if ((p < end) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+		value = 0;
+		while ((p < end) && (*p >= '0') && (*p <= '9'))
+		{
+			value = value * 10 + (*p - '0');
+			p++;
+		}
+		if (bNegative == true)
+		{
+			value = -value;
+		}
+		return(p);
+	}
+
+	const char* ParseDouble(const char* p, const char* end, double& value)
+	{
+		bool bNegative = false;
+		if ((p < end) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+
+		double result = 0.0;
+		while ((p < end) && (*p >= '0') && (*p <= '9'))
+		{
+			result = result * 10.0 + (*p - '0');
+			p++;
+		}
+		if ((p < end) && (*p == '.'))
+		{
+			double scale = 0.1;
+			p++;
+			while ((p < end) && (*p >= '0') && (*p <= '9'))
+			{
+				result += (*p - '0') * scale;
+				scale *= 0.1;
+				p++;
+			}
+		}
+		if ((p < end) && ((*p == 'e') || (*p == 'E')))
+		{
+			int exponent = 0;
+			p = ParseInt(p + 1, end, exponent);
+			result *= pow(10.0, exponent);
+		}
+
+		value = bNegative ? -result : result;
+		return(p);
+	}
+
+	const char* ParseFloat(const char* p, const char* end, float& value)
+	{
+		double result = 0.0;
+		p = ParseDouble(p, end, result);
+		value = (float)result;
+		return(p);
+	}
+
+	/***********************************************************
+	 *  JsonValue
+	 *
+	 *  A minimal JSON document, enough to read the glTF
+	 *  description chunk.
+	 ***********************************************************/
+	struct JsonValue
+	{
+		enum JSON_TYPE
+		{
+			JSON_NULL,
+			JSON_BOOL,
+			JSON_NUMBER,
+			JSON_STRING,
+			JSON_ARRAY,
+			JSON_OBJECT
+		};
+
+		JSON_TYPE type;
+		double number;
+		std::string text;
+		std::vector<JsonValue> items;
+		std::vector<std::pair<std::string, JsonValue> > members;
+
+		JsonValue()
+		{
+			type = JSON_NULL;
+			number = 0.0;
+		}
+
+		const JsonValue* Find(const char* key) const
+		{
+			for (size_t i = 0; i < members.size(); i++)
+			{
+				if (members[i].first == key)
+				{
+					return(&members[i].second);
+				}
+			}
+			return(NULL);
+		}
+
+		int GetInt(const char* key, int defaultValue) const
+		{
+			const JsonValue* pValue = Find(key);
+			if ((pValue == NULL) || (pValue->type != JSON_NUMBER))
+			{
+				return(defaultValue);
+			}
+			return((int)pValue->number);
+		}
+
+		const JsonValue* GetItem(const char* key, int index) const
+		{
+			const JsonValue* pArray = Find(key);
+			if ((pArray == NULL) || (pArray->type != JSON_ARRAY) ||
+				(index < 0) || (index >= (int)pArray->items.size()))
+			{
+				return(NULL);
+			}
+			return(&pArray->items[index]);
+		}
+	};
+
+	/***********************************************************
+	 *  JsonParser
+	 *
+	 *  Recursive descent parser for the JSON chunk.  Escape
+	 *  sequences other than the single character ones are
+	 *  kept as is, which glTF names and keys never need.
+	 ***********************************************************/
+	class JsonParser
+	{
+	public:
+		JsonParser(const char* begin, const char* end)
+		{
+			m_p = begin;
+			m_end = end;
+			m_bError = false;
+		}
+
+		bool Parse(JsonValue& value)
+		{
+			ParseValue(value, 0);
+			SkipWhitespace();
+			return((m_bError == false) && (m_p == m_end));
+		}
+
+	private:
+		const char* m_p;
+		const char* m_end;
+		bool m_bError;
+
+		void SkipWhitespace()
+		{
+			while ((m_p < m_end) && ((*m_p == ' ') || (*m_p == '\t') || (*m_p == '\r') || (*m_p == '\n')))
+			{
+				m_p++;
+			}
+		}
+
+		bool Expect(char c)
+		{
+			SkipWhitespace();
+			if ((m_p < m_end) && (*m_p == c))
+			{
+				m_p++;
+				return(true);
+			}
+			m_bError = true;
+			return(false);
+		}
+
+		bool Match(const char* word)
+		{
+			size_t length = strlen(word);
+			if (((size_t)(m_end - m_p) >= length) && (memcmp(m_p, word, length) == 0))
+			{
+				m_p += length;
+				return(true);
+			}
+			return(false);
+		}
+
+		void ParseString(std::string& text)
+		{
+			if (Expect('"') == false)
+			{
+				return;
+			}
+			while ((m_p < m_end) && (*m_p != '"'))
+			{
+				if ((*m_p == '\\') && (m_p + 1 < m_end))
+				{
+					m_p++;
+					switch (*m_p)
+					{
+					case 'n': text += '\n'; break;
+					case 't': text += '\t'; break;
+					case 'r': text += '\r'; break;
+					case 'b': text += '\b'; break;
+					case 'f': text += '\f'; break;
+					case 'u': text += "\\u"; break;
+					default: text += *m_p; break;
+					}
+				}
+				else
+				{
+					text += *m_p;
+				}
+				m_p++;
+			}
+			Expect('"');
+		}
+
+		void ParseValue(JsonValue& value, int depth)
+		{
+			SkipWhitespace();
+			if ((m_p >= m_end) || (depth > 64))
+			{
+				m_bError = true;
+				return;
+			}
+
+			if (*m_p == '{')
+			{
+				m_p++;
+				value.type = JsonValue::JSON_OBJECT;
+				SkipWhitespace();
+				if ((m_p < m_end) && (*m_p == '}'))
+				{
+					m_p++;
+					return;
+				}
+				while (m_bError == false)
+				{
+					value.members.push_back(std::pair<std::string, JsonValue>());
+					SkipWhitespace();
+					ParseString(value.members.back().first);
+					Expect(':');
+					ParseValue(value.members.back().second, depth + 1);
+					SkipWhitespace();
+					if ((m_p < m_end) && (*m_p == ','))
+					{
+						m_p++;
+						continue;
+					}
+					Expect('}');
+					break;
+				}
+			}
+			else if (*m_p == '[')
+			{
+				m_p++;
+				value.type = JsonValue::JSON_ARRAY;
+				SkipWhitespace();
+				if ((m_p < m_end) && (*m_p == ']'))
+				{
+					m_p++;
+					return;
+				}
+				while (m_bError == false)
+				{
+					value.items.push_back(JsonValue());
+					ParseValue(value.items.back(), depth + 1);
+					SkipWhitespace();
+					if ((m_p < m_end) && (*m_p == ','))
+					{
+						m_p++;
+						continue;
+					}
+					Expect(']');
+					break;
+				}
+			}
+			else if (*m_p == '"')
+			{
+				value.type = JsonValue::JSON_STRING;
+				ParseString(value.text);
+			}
+			else if (Match("true") == true)
+			{
+				value.type = JsonValue::JSON_BOOL;
+				value.number = 1.0;
+			}
+			else if (Match("false") == true)
+			{
+				value.type = JsonValue::JSON_BOOL;
+			}
+			else if (Match("null") == true)
+			{
+				value.type = JsonValue::JSON_NULL;
+			}
+			else
+			{
+				double number = 0.0;
+				const char* pStart = m_p;
+				m_p = ParseDouble(m_p, m_end, number);
+				if (m_p == pStart)
+				{
+					m_bError = true;
+					return;
+				}
+				value.type = JsonValue::JSON_NUMBER;
+				value.number = number;
+			}
+		}
+	};
+
+	/***********************************************************
+	 *  GLTFAccessor
+	 *
+	 *  The location and format of one glTF accessor inside the
+	 *  binary chunk.
+	 ***********************************************************/
+	struct GLTFAccessor
+	{
+		const unsigned char* pData;
+		size_t count;
+		size_t stride;
+		int componentType;
+		int nComponents;
+		bool bNormalized;
+
+		// read a component of an element as a float, applying
+		// the normalization of integer components
+		float Read(size_t element, int component) const
+		{
+			const unsigned char* p = pData + element * stride;
+			switch (componentType)
+			{
+			case g_GLTFFloat:
+			{
+				float value;
+				memcpy(&value, p + component * 4, 4);
+				return(value);
+			}
+			case g_GLTFUnsignedByte:
+				return(bNormalized ? p[component] / 255.0f : p[component]);
+			case g_GLTFByte:
+				return(bNormalized ? (std::max)((signed char)p[component] / 127.0f, -1.0f) : (signed char)p[component]);
+			case g_GLTFUnsignedShort:
+			{
+				uint16_t value;
+				memcpy(&value, p + component * 2, 2);
+				return(bNormalized ? value / 65535.0f : value);
+			}
+			case g_GLTFShort:
+			{
+				int16_t value;
+				memcpy(&value, p + component * 2, 2);
+				return(bNormalized ? (std::max)(value / 32767.0f, -1.0f) : value);
+			}
+			}
+			return(0.0f);
+		}
+
+		// read an element of an index accessor
+		uint32_t ReadIndex(size_t element) const
+		{
+			const unsigned char* p = pData + element * stride;
+			switch (componentType)
+			{
+			case g_GLTFUnsignedByte:
+				return(p[0]);
+			case g_GLTFUnsignedShort:
+			{
+				uint16_t value;
+				memcpy(&value, p, 2);
+				return(value);
+			}
+			case g_GLTFUnsignedInt:
+			{
+				uint32_t value;
+				memcpy(&value, p, 4);
+				return(value);
+			}
+			}
+			return(0);
+		}
+	};
+
+	int ComponentSize(int componentType)
+	{
+		switch (componentType)
+		{
+		case g_GLTFByte:
+		case g_GLTFUnsignedByte:
+			return(1);
+		case g_GLTFShort:
+		case g_GLTFUnsignedShort:
+			return(2);
+		case g_GLTFUnsignedInt:
+		case g_GLTFFloat:
+			return(4);
+		}
+		return(0);
+	}
+
+	int ComponentCount(const std::string& type)
+	{
+		if (type == "SCALAR") return(1);
+		if (type == "VEC2") return(2);
+		if (type == "VEC3") return(3);
+		if (type == "VEC4") return(4);
+		return(0);
+	}
+
+	/***********************************************************
+	 *  GetAccessor()
+	 *
+	 *  Find the passed in accessor and check that all of its
+	 *  elements are inside the binary chunk.  Accessors into
+	 *  external buffers or without a buffer view are rejected.
+	 ***********************************************************/
+	bool GetAccessor(
+		const JsonValue& document,
+		int index,
+		const unsigned char* pBinary,
+		size_t binarySize,
+		GLTFAccessor& accessor)
+	{
+		const JsonValue* pAccessor = document.GetItem("accessors", index);
+		if (pAccessor == NULL)
+		{
+			return(false);
+		}
+		const JsonValue* pView = document.GetItem("bufferViews", pAccessor->GetInt("bufferView", -1));
+		if ((pView == NULL) || (pView->GetInt("buffer", 0) != 0))
+		{
+			return(false);
+		}
+		const JsonValue* pType = pAccessor->Find("type");
+		const JsonValue* pNormalized = pAccessor->Find("normalized");
+
+		accessor.componentType = pAccessor->GetInt("componentType", 0);
+		accessor.nComponents = (pType != NULL) ? ComponentCount(pType->text) : 0;
+		accessor.count = (size_t)pAccessor->GetInt("count", 0);
+		accessor.bNormalized = (pNormalized != NULL) && (pNormalized->number != 0.0);
+
+		size_t elementSize = (size_t)ComponentSize(accessor.componentType) * accessor.nComponents;
+		size_t viewOffset = (size_t)pView->GetInt("byteOffset", 0);
+		size_t viewLength = (size_t)pView->GetInt("byteLength", 0);
+		size_t offset = (size_t)pAccessor->GetInt("byteOffset", 0);
+		accessor.stride = (size_t)pView->GetInt("byteStride", (int)elementSize);
+
+		if ((elementSize == 0) || (accessor.stride < elementSize) ||
+			(viewOffset > binarySize) || (viewLength > binarySize - viewOffset))
+		{
+			return(false);
+		}
+		if ((accessor.count > 0) && (offset + (accessor.count - 1) * accessor.stride + elementSize > viewLength))
+		{
+			return(false);
+		}
+
+		accessor.pData = pBinary + viewOffset + offset;
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  MeshImporter()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshImporter::MeshImporter()
+{
+}
+
+/***********************************************************
+ *  LoadMesh()
+ *
+ *  This method is used for loading a mesh file in the
+ *  format matching its extension.
+ ***********************************************************/
+bool MeshImporter::LoadMesh(const char* filename, MeshData& mesh)
+{
+	std::string name(filename);
+	std::string extension;
+	size_t dot = name.find_last_of('.');
+	if (dot != std::string::npos)
+	{
+		extension = name.substr(dot + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	}
+
+	if (extension == "obj")
+	{
+		return(LoadOBJ(filename, mesh));
+	}
+	if (extension == "glb")
+	{
+		return(LoadGLB(filename, mesh));
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  LoadOBJ()
+ *
+ *  This method is used for loading an OBJ file.  The file
+ *  is split into blocks of whole lines that are parsed in
+ *  parallel, then the blocks are joined and every unique
+ *  position, texture coordinate and normal combination
+ *  becomes one vertex.  Polygons are triangulated as fans.
+ ***********************************************************/
+bool MeshImporter::LoadOBJ(const char* filename, MeshData& mesh)
+{
+	MappedFile file;
+	if (file.Open(filename) == false)
+	{
+		return(false);
+	}
+
+	const char* pText = (const char*)file.GetData();
+	const size_t size = file.GetSize();
+
+	// find the block boundaries at the line starts
+	size_t nBlocks = (std::max)((std::min)((size_t)std::thread::hardware_concurrency(), size / g_MinBytesPerThread), (size_t)1);
+	std::vector<const char*> blockStarts(nBlocks + 1, pText + size);
+	blockStarts[0] = pText;
+	for (size_t i = 1; i < nBlocks; i++)
+	{
+		const char* p = (std::max)(pText + size * i / nBlocks, blockStarts[i - 1]);
+		while ((p < pText + size) && (p[-1] != '\n'))
+		{
+			p++;
+		}
+		blockStarts[i] = p;
+	}
+
+	m_objBlocks.assign(nBlocks, ObjBlock());
+	std::vector<ObjBlock>& blocks = m_objBlocks;
+	ParallelFor(nBlocks, 1, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			ParseOBJBlock(blockStarts[i], blockStarts[i + 1], blocks[i]);
+		}
+	});
+
+	// join the blocks into one set of positions, texture coords
+	// and normals, and resolve the relative corner indices
+	std::vector<float> positions;
+	std::vector<float> uvs;
+	std::vector<float> normals;
+	std::vector<ObjCorner> corners;
+	for (size_t i = 0; i < nBlocks; i++)
+	{
+		const ObjBlock& block = blocks[i];
+		const int positionBase = (int)(positions.size() / 3);
+		const int uvBase = (int)(uvs.size() / 2);
+		const int normalBase = (int)(normals.size() / 3);
+
+		for (size_t j = 0; j < block.corners.size(); j++)
+		{
+			ObjCorner corner = block.corners[j];
+			if (block.relative[j] & 1) corner.position += positionBase;
+			if (block.relative[j] & 2) corner.uv += uvBase;
+			if (block.relative[j] & 4) corner.normal += normalBase;
+			corners.push_back(corner);
+		}
+		positions.insert(positions.end(), block.positions.begin(), block.positions.end());
+		uvs.insert(uvs.end(), block.uvs.begin(), block.uvs.end());
+		normals.insert(normals.end(), block.normals.begin(), block.normals.end());
+	}
+	m_objBlocks.clear();
+
+	const int nPositions = (int)(positions.size() / 3);
+	const int nUVs = (int)(uvs.size() / 2);
+	const int nNormals = (int)(normals.size() / 3);
+
+	// weld identical corners into shared vertices, the key packs
+	// the three indices into 21 bits each
+	const bool bWeld = (nPositions < (1 << 21)) && (nUVs < (1 << 21) - 1) && (nNormals < (1 << 21) - 1);
+	std::unordered_map<uint64_t, GLuint> vertexMap;
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	std::vector<bool> bNeedsNormal;
+
+	for (size_t t = 0; t + 2 < corners.size(); t += 3)
+	{
+		bool bValid = true;
+		for (size_t k = 0; k < 3; k++)
+		{
+			bValid = bValid && (corners[t + k].position >= 0) && (corners[t + k].position < nPositions);
+		}
+		if (bValid == false)
+		{
+			continue;
+		}
+
+		for (size_t k = 0; k < 3; k++)
+		{
+			const ObjCorner& corner = corners[t + k];
+			int uv = ((corner.uv >= 0) && (corner.uv < nUVs)) ? corner.uv : -1;
+			int normal = ((corner.normal >= 0) && (corner.normal < nNormals)) ? corner.normal : -1;
+
+			if (bWeld == true)
+			{
+				uint64_t key = ((uint64_t)corner.position << 42) | ((uint64_t)(uv + 1) << 21) | (uint64_t)(normal + 1);
+				std::pair<std::unordered_map<uint64_t, GLuint>::iterator, bool> result =
+					vertexMap.insert(std::make_pair(key, (GLuint)bNeedsNormal.size()));
+				if (result.second == false)
+				{
+					indices.push_back(result.first->second);
+					continue;
+				}
+			}
+
+			indices.push_back((GLuint)bNeedsNormal.size());
+			const float* pPosition = &positions[corner.position * 3];
+			vertices.insert(vertices.end(), pPosition, pPosition + 3);
+			if (normal >= 0)
+			{
+				vertices.insert(vertices.end(), &normals[normal * 3], &normals[normal * 3] + 3);
+			}
+			else
+			{
+				vertices.insert(vertices.end(), 3, 0.0f);
+			}
+			if (uv >= 0)
+			{
+				vertices.insert(vertices.end(), &uvs[uv * 2], &uvs[uv * 2] + 2);
+			}
+			else
+			{
+				vertices.insert(vertices.end(), 2, 0.0f);
+			}
+			bNeedsNormal.push_back(normal < 0);
+		}
+	}
+
+	if (indices.empty() == true)
+	{
+		return(false);
+	}
+
+	mesh.vertices.swap(vertices);
+	mesh.indices.swap(indices);
+	mesh.nParts = 0;
+	mesh.AddPart(0, mesh.IndexCount());
+	CalculateNormals(mesh, bNeedsNormal);
+	return(true);
+}
+
+/***********************************************************
+ *  ParseOBJBlock()
+ *
+ *  This method is used for parsing the v, vt, vn and f
+ *  lines of one block.  Other statements, like groups and
+ *  materials, are skipped.
+ ***********************************************************/
+void MeshImporter::ParseOBJBlock(
+	const char* begin,
+	const char* end,
+	ObjBlock& block)
+{
+	std::vector<ObjCorner> polygon;
+	std::vector<unsigned char> polygonRelative;
+	const char* p = begin;
+
+	while (p < end)
+	{
+		const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+		if (lineEnd == NULL)
+		{
+			lineEnd = end;
+		}
+		p = SkipSpaces(p, lineEnd);
+
+		if ((lineEnd - p >= 2) && (p[0] == 'v') && (p[1] == ' '))
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				float value = 0.0f;
+				p = ParseFloat(SkipSpaces(p + (i == 0 ? 2 : 0), lineEnd), lineEnd, value);
+				block.positions.push_back(value);
+			}
+		}
+		else if ((lineEnd - p >= 3) && (p[0] == 'v') && (p[1] == 't') && (p[2] == ' '))
+		{
+			for (int i = 0; i < 2; i++)
+			{
+				float value = 0.0f;
+				p = ParseFloat(SkipSpaces(p + (i == 0 ? 3 : 0), lineEnd), lineEnd, value);
+				block.uvs.push_back(value);
+			}
+		}
+		else if ((lineEnd - p >= 3) && (p[0] == 'v') && (p[1] == 'n') && (p[2] == ' '))
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				float value = 0.0f;
+				p = ParseFloat(SkipSpaces(p + (i == 0 ? 3 : 0), lineEnd), lineEnd, value);
+				block.normals.push_back(value);
+			}
+		}
+		else if ((lineEnd - p >= 2) && (p[0] == 'f') && (p[1] == ' '))
+		{
+			polygon.clear();
+			polygonRelative.clear();
+			p += 2;
+
+			// each corner is v, v/vt, v//vn or v/vt/vn with 1-based
+			// indices, or negative ones counting back from the end
+			while (true)
+			{
+				p = SkipSpaces(p, lineEnd);
+				if ((p >= lineEnd) || (((*p < '0') || (*p > '9')) && (*p != '-')))
+				{
+					break;
+				}
+
+				int values[3] = { 0, 0, 0 };
+				for (int i = 0; i < 3; i++)
+				{
+					if ((i > 0) && ((p >= lineEnd) || (*p != '/')))
+					{
+						break;
+					}
+					if (i > 0)
+					{
+						p++;
+					}
+					p = ParseInt(p, lineEnd, values[i]);
+				}
+				while ((p < lineEnd) && (*p != ' ') && (*p != '\t') && (*p != '\r'))
+				{
+					p++;
+				}
+
+				const int counts[3] = {
+					(int)(block.positions.size() / 3),
+					(int)(block.uvs.size() / 2),
+					(int)(block.normals.size() / 3) };
+				int resolved[3];
+				unsigned char relative = 0;
+				for (int i = 0; i < 3; i++)
+				{
+					if (values[i] < 0)
+					{
+						resolved[i] = counts[i] + values[i];
+						relative |= (unsigned char)(1 << i);
+					}
+					else
+					{
+						resolved[i] = values[i] - 1;
+					}
+				}
+
+				ObjCorner corner;
+				corner.position = resolved[0];
+				corner.uv = resolved[1];
+				corner.normal = resolved[2];
+				polygon.push_back(corner);
+				polygonRelative.push_back(relative);
+			}
+
+			for (size_t i = 1; i + 1 < polygon.size(); i++)
+			{
+				block.corners.push_back(polygon[0]);
+				block.corners.push_back(polygon[i]);
+				block.corners.push_back(polygon[i + 1]);
+				block.relative.push_back(polygonRelative[0]);
+				block.relative.push_back(polygonRelative[i]);
+				block.relative.push_back(polygonRelative[i + 1]);
+			}
+		}
+
+		p = lineEnd + 1;
+	}
+}
+
+/***********************************************************
+ *  LoadGLB()
+ *
+ *  This method is used for loading a binary glTF file.  The
+ *  triangle primitives of every mesh are appended into one
+ *  mesh, converting the accessors straight from the mapped
+ *  binary chunk, in parallel for large primitives.
+ ***********************************************************/
+bool MeshImporter::LoadGLB(const char* filename, MeshData& mesh)
+{
+	MappedFile file;
+	if (file.Open(filename) == false)
+	{
+		return(false);
+	}
+
+	const unsigned char* pData = file.GetData();
+	const size_t size = file.GetSize();
+	uint32_t header[5];
+	if (size < sizeof(header) + 8)
+	{
+		return(false);
+	}
+	memcpy(header, pData, sizeof(header));
+	if ((header[0] != g_GLBMagic) || (header[1] != 2) || (header[4] != g_GLBChunkJSON) || (header[3] > size - 20))
+	{
+		return(false);
+	}
+
+	const char* pJSON = (const char*)pData + 20;
+	const size_t jsonSize = header[3];
+	const unsigned char* pBinary = NULL;
+	size_t binarySize = 0;
+	size_t binaryChunk = 20 + ((jsonSize + 3) & ~(size_t)3);
+	if (binaryChunk + 8 <= size)
+	{
+		uint32_t chunkHeader[2];
+		memcpy(chunkHeader, pData + binaryChunk, sizeof(chunkHeader));
+		if ((chunkHeader[1] == g_GLBChunkBIN) && (chunkHeader[0] <= size - binaryChunk - 8))
+		{
+			pBinary = pData + binaryChunk + 8;
+			binarySize = chunkHeader[0];
+		}
+	}
+
+	// the JSON chunk may be padded with trailing spaces
+	JsonValue document;
+	JsonParser parser(pJSON, pJSON + jsonSize);
+	if ((parser.Parse(document) == false) || (pBinary == NULL))
+	{
+		return(false);
+	}
+
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	std::vector<bool> bNeedsNormal;
+
+	const JsonValue* pMeshes = document.Find("meshes");
+	for (size_t m = 0; (pMeshes != NULL) && (m < pMeshes->items.size()); m++)
+	{
+		const JsonValue* pPrimitives = pMeshes->items[m].Find("primitives");
+		for (size_t p = 0; (pPrimitives != NULL) && (p < pPrimitives->items.size()); p++)
+		{
+			const JsonValue& primitive = pPrimitives->items[p];
+			const JsonValue* pAttributes = primitive.Find("attributes");
+			if ((primitive.GetInt("mode", g_GLTFTriangles) != g_GLTFTriangles) || (pAttributes == NULL))
+			{
+				continue;
+			}
+
+			GLTFAccessor positions;
+			GLTFAccessor normals;
+			GLTFAccessor uvs;
+			GLTFAccessor indices;
+			if ((GetAccessor(document, pAttributes->GetInt("POSITION", -1), pBinary, binarySize, positions) == false) ||
+				(positions.nComponents != 3))
+			{
+				continue;
+			}
+			bool bNormals = GetAccessor(document, pAttributes->GetInt("NORMAL", -1), pBinary, binarySize, normals) &&
+				(normals.nComponents == 3) && (normals.count == positions.count);
+			bool bUVs = GetAccessor(document, pAttributes->GetInt("TEXCOORD_0", -1), pBinary, binarySize, uvs) &&
+				(uvs.nComponents == 2) && (uvs.count == positions.count);
+			bool bIndices = GetAccessor(document, primitive.GetInt("indices", -1), pBinary, binarySize, indices) &&
+				(indices.nComponents == 1);
+
+			const size_t firstVertex = mesh.vertices.size() / MeshData::FLOATS_PER_VERTEX;
+			const size_t nVertices = positions.count;
+			mesh.vertices.resize((firstVertex + nVertices) * MeshData::FLOATS_PER_VERTEX);
+			bNeedsNormal.resize(firstVertex + nVertices, bNormals == false);
+
+			GLfloat* pVertices = &mesh.vertices[0] + firstVertex * MeshData::FLOATS_PER_VERTEX;
+			ParallelFor(nVertices, g_MinVerticesPerThread, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					GLfloat* pVertex = pVertices + i * MeshData::FLOATS_PER_VERTEX;
+					for (int k = 0; k < 3; k++)
+					{
+						pVertex[k] = positions.Read(i, k);
+						pVertex[3 + k] = bNormals ? normals.Read(i, k) : 0.0f;
+					}
+					// glTF puts the texture origin at the top left
+					pVertex[6] = bUVs ? uvs.Read(i, 0) : 0.0f;
+					pVertex[7] = bUVs ? 1.0f - uvs.Read(i, 1) : 0.0f;
+				}
+			});
+
+			const size_t nIndices = bIndices ? indices.count : nVertices;
+			const size_t firstIndex = mesh.indices.size();
+			mesh.indices.resize(firstIndex + nIndices - nIndices % 3);
+			for (size_t i = 0; i + 2 < nIndices; i += 3)
+			{
+				for (size_t k = 0; k < 3; k++)
+				{
+					size_t index = bIndices ? indices.ReadIndex(i + k) : i + k;
+					mesh.indices[firstIndex + i + k] = (GLuint)(firstVertex + (std::min)(index, nVertices - 1));
+				}
+			}
+		}
+	}
+
+	if (mesh.indices.empty() == true)
+	{
+		return(false);
+	}
+
+	mesh.nParts = 0;
+	mesh.AddPart(0, mesh.IndexCount());
+	CalculateNormals(mesh, bNeedsNormal);
+	return(true);
+}
+
+/***********************************************************
+ *  CalculateNormals()
+ *
+ *  This method is used for setting the normal of every
+ *  flagged vertex to the area weighted average of the
+ *  normals of the triangles using it.
+ ***********************************************************/
+void MeshImporter::CalculateNormals(
+	MeshData& mesh,
+	const std::vector<bool>& bNeedsNormal)
+{
+	if (std::find(bNeedsNormal.begin(), bNeedsNormal.end(), true) == bNeedsNormal.end())
+	{
+		return;
+	}
+
+	for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+	{
+		GLfloat* pCorners[3];
+		for (int k = 0; k < 3; k++)
+		{
+			pCorners[k] = &mesh.vertices[mesh.indices[t + k] * MeshData::FLOATS_PER_VERTEX];
+		}
+
+		float e1[3];
+		float e2[3];
+		for (int k = 0; k < 3; k++)
+		{
+			e1[k] = pCorners[1][k] - pCorners[0][k];
+			e2[k] = pCorners[2][k] - pCorners[0][k];
+		}
+		float normal[3] = {
+			e1[1] * e2[2] - e1[2] * e2[1],
+			e1[2] * e2[0] - e1[0] * e2[2],
+			e1[0] * e2[1] - e1[1] * e2[0] };
+
+		for (int k = 0; k < 3; k++)
+		{
+			if (bNeedsNormal[mesh.indices[t + k]] == true)
+			{
+				pCorners[k][3] += normal[0];
+				pCorners[k][4] += normal[1];
+				pCorners[k][5] += normal[2];
+			}
+		}
+	}
+
+	for (size_t i = 0; i < bNeedsNormal.size(); i++)
+	{
+		if (bNeedsNormal[i] == true)
+		{
+			GLfloat* pNormal = &mesh.vertices[i * MeshData::FLOATS_PER_VERTEX + 3];
+			float length = sqrtf(pNormal[0] * pNormal[0] + pNormal[1] * pNormal[1] + pNormal[2] * pNormal[2]);
+			if (length > 0.0f)
+			{
+				pNormal[0] /= length;
+				pNormal[1] /= length;
+				pNormal[2] /= length;
+			}
+		}
+	}
+}
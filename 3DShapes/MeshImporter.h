@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshimporter.h
+// ============
+// import triangle meshes from Wavefront OBJ and binary glTF files into
+// the interleaved position, normal, texture coordinate layout
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+#include <vector>
+
+/***********************************************************
+ *  MeshImporter
+ *
+ *  This class contains the code for loading mesh files.  The
+ *  files are memory mapped and parsed in place, and large
+ *  files are split between several threads.  Every mesh is
+ *  returned as a single part with the same vertex layout as
+ *  the generated primitives, with normals calculated when
+ *  the file does not provide them.
+ ***********************************************************/
+class MeshImporter
+{
+public:
+	// constructor
+	MeshImporter();
+
+	// load the passed in file, choosing the format from
+	// the file extension (.obj or .glb)
+	bool LoadMesh(const char* filename, MeshData& mesh);
+
+	// load the polygons of a Wavefront OBJ file
+	bool LoadOBJ(const char* filename, MeshData& mesh);
+
+	// load the triangle primitives of every mesh in a
+	// binary glTF 2.0 file, ignoring the node transforms
+	bool LoadGLB(const char* filename, MeshData& mesh);
+
+private:
+	// the vertices of an OBJ face corner, as 0-based
+	// indices or -1 when the corner has none
+	struct ObjCorner
+	{
+		int position;
+		int uv;
+		int normal;
+	};
+
+	// the data parsed from one block of lines of an OBJ file
+	struct ObjBlock
+	{
+		std::vector<float> positions;
+		std::vector<float> uvs;
+		std::vector<float> normals;
+		// three corners per triangle
+		std::vector<ObjCorner> corners;
+		// marks the corner indices that were written relative to
+		// this block and still need its starting offsets added
+		std::vector<unsigned char> relative;
+	};
+
+	std::vector<ObjBlock> m_objBlocks;
+
+	// parse the lines from begin to end into the passed in block
+	static void ParseOBJBlock(
+		const char* begin,
+		const char* end,
+		ObjBlock& block);
+
+	// calculate smooth normals for the vertices flagged as
+	// having no normal, from the triangles using them
+	static void CalculateNormals(
+		MeshData& mesh,
+		const std::vector<bool>& bNeedsNormal);
+};
@@ -0,0 +1,420 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// reorder the triangles and vertices of a mesh for the post-transform
+// vertex cache, overdraw and vertex fetch before it is uploaded
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// number of vertices the optimization targets and the cache
+	// simulation assumes to fit in the post-transform cache
+	const GLuint g_CacheSize = 16;
+	const GLuint g_NoVertex = 0xFFFFFFFF;
+
+	// orders cluster indices by descending sort key
+	struct ClusterKeyGreater
+	{
+		const std::vector<float>* pKeys;
+
+		bool operator()(GLuint a, GLuint b) const
+		{
+			return((*pKeys)[a] > (*pKeys)[b]);
+		}
+	};
+}
+
+/***********************************************************
+ *  MeshOptimizer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshOptimizer::MeshOptimizer()
+{
+}
+
+/***********************************************************
+ *  Optimize()
+ *
+ *  This method is used for reordering the triangles of every
+ *  part of the passed in mesh, followed by its vertices.
+ ***********************************************************/
+void MeshOptimizer::Optimize(
+	MeshData& mesh,
+	CacheStats* pBefore,
+	CacheStats* pAfter)
+{
+	if (pBefore != NULL)
+	{
+		*pBefore = AnalyzeCache(mesh);
+	}
+
+	// the clusters are sorted relative to the center of the mesh
+	const GLuint nVertices = mesh.VertexCount();
+	float centroid[3] = { 0.0f, 0.0f, 0.0f };
+	for (GLuint i = 0; i < nVertices; i++)
+	{
+		const GLfloat* pPosition = &mesh.vertices[i * MeshData::FLOATS_PER_VERTEX];
+		centroid[0] += pPosition[0];
+		centroid[1] += pPosition[1];
+		centroid[2] += pPosition[2];
+	}
+	if (nVertices > 0)
+	{
+		centroid[0] /= nVertices;
+		centroid[1] /= nVertices;
+		centroid[2] /= nVertices;
+	}
+
+	if (mesh.nParts == 0)
+	{
+		TipsifyPart(mesh, 0, mesh.IndexCount());
+		SortClusters(mesh, 0, centroid);
+	}
+	for (GLuint i = 0; i < mesh.nParts; i++)
+	{
+		TipsifyPart(mesh, mesh.parts[i].firstIndex, mesh.parts[i].indexCount);
+		SortClusters(mesh, mesh.parts[i].firstIndex, centroid);
+	}
+
+	RemapVertices(mesh);
+
+	if (pAfter != NULL)
+	{
+		*pAfter = AnalyzeCache(mesh);
+	}
+}
+
+/***********************************************************
+ *  AnalyzeCache()
+ *
+ *  This method is used for counting the vertex cache misses
+ *  of the passed in mesh with a simulated FIFO cache.
+ ***********************************************************/
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeCache(const MeshData& mesh)
+{
+	const GLuint nIndices = mesh.IndexCount();
+	GLuint time = g_CacheSize + 1;
+	GLuint misses = 0;
+	GLuint usedVertices = 0;
+
+	m_cacheTimes.assign(mesh.VertexCount(), 0);
+	for (GLuint i = 0; i < nIndices; i++)
+	{
+		GLuint vertex = mesh.indices[i];
+		if (m_cacheTimes[vertex] == 0)
+		{
+			usedVertices++;
+		}
+		if (time - m_cacheTimes[vertex] > g_CacheSize)
+		{
+			m_cacheTimes[vertex] = time;
+			time++;
+			misses++;
+		}
+	}
+
+	CacheStats stats;
+	stats.acmr = (nIndices >= 3) ? (float)misses / (nIndices / 3) : 0.0f;
+	stats.atvr = (usedVertices > 0) ? (float)misses / usedVertices : 0.0f;
+	return(stats);
+}
+
+/***********************************************************
+ *  TipsifyPart()
+ *
+ *  This method is used for ordering the triangles of one
+ *  part by fanning around the vertices that are still in
+ *  the cache.  Whenever the next vertex has already left
+ *  the cache a new cluster is started, because reordering
+ *  the clusters then costs no extra cache misses.
+ ***********************************************************/
+void MeshOptimizer::TipsifyPart(
+	const MeshData& mesh,
+	GLuint firstIndex,
+	GLuint indexCount)
+{
+	const GLuint nVertices = mesh.VertexCount();
+	const GLuint nTriangles = indexCount / 3;
+	const GLuint* pIndices = &mesh.indices[0] + firstIndex;
+
+	m_orderedTriangles.clear();
+	m_clusterStarts.clear();
+	m_clusterStarts.push_back(0);
+	if (nTriangles == 0)
+	{
+		return;
+	}
+
+	// build the vertex to triangle adjacency of this part
+	m_liveTriangles.assign(nVertices, 0);
+	for (GLuint i = 0; i < nTriangles * 3; i++)
+	{
+		m_liveTriangles[pIndices[i]]++;
+	}
+	m_adjacencyOffsets.resize(nVertices + 1);
+	m_adjacencyOffsets[0] = 0;
+	for (GLuint i = 0; i < nVertices; i++)
+	{
+		m_adjacencyOffsets[i + 1] = m_adjacencyOffsets[i] + m_liveTriangles[i];
+	}
+	m_adjacency.resize(nTriangles * 3);
+	m_remap.assign(m_adjacencyOffsets.begin(), m_adjacencyOffsets.end() - 1);
+	for (GLuint i = 0; i < nTriangles * 3; i++)
+	{
+		m_adjacency[m_remap[pIndices[i]]++] = i / 3;
+	}
+
+	m_cacheTimes.assign(nVertices, 0);
+	m_bEmitted.assign(nTriangles, false);
+	m_deadEnds.clear();
+
+	GLuint time = g_CacheSize + 1;
+	GLuint cursor = 0;
+	int fanVertex = (int)pIndices[0];
+
+	while (fanVertex >= 0)
+	{
+		m_candidates.clear();
+
+		for (GLuint i = m_adjacencyOffsets[fanVertex]; i < m_adjacencyOffsets[fanVertex + 1]; i++)
+		{
+			GLuint triangle = m_adjacency[i];
+			if (m_bEmitted[triangle] == true)
+			{
+				continue;
+			}
+
+			for (GLuint j = 0; j < 3; j++)
+			{
+				GLuint vertex = pIndices[triangle * 3 + j];
+				m_deadEnds.push_back(vertex);
+				m_candidates.push_back(vertex);
+				m_liveTriangles[vertex]--;
+				if (time - m_cacheTimes[vertex] > g_CacheSize)
+				{
+					m_cacheTimes[vertex] = time;
+					time++;
+				}
+			}
+			m_bEmitted[triangle] = true;
+			m_orderedTriangles.push_back(triangle);
+		}
+
+		bool bCacheFlushed = false;
+		fanVertex = NextVertex(mesh, firstIndex, nTriangles * 3, time, cursor, bCacheFlushed);
+		if ((bCacheFlushed == true) && (m_orderedTriangles.size() > m_clusterStarts.back()))
+		{
+			m_clusterStarts.push_back((GLuint)m_orderedTriangles.size());
+		}
+	}
+}
+
+/***********************************************************
+ *  NextVertex()
+ *
+ *  This method is used for choosing the next vertex to fan
+ *  around.  The candidates from the last fan are preferred
+ *  when they will still be in the cache after their
+ *  remaining triangles are emitted, then the most recently
+ *  used vertex with triangles left, then the next vertex
+ *  in input order.
+ ***********************************************************/
+int MeshOptimizer::NextVertex(
+	const MeshData& mesh,
+	GLuint firstIndex,
+	GLuint indexCount,
+	GLuint time,
+	GLuint& cursor,
+	bool& bCacheFlushed)
+{
+	int bestVertex = -1;
+	int bestPriority = -1;
+
+	for (size_t i = 0; i < m_candidates.size(); i++)
+	{
+		GLuint vertex = m_candidates[i];
+		if (m_liveTriangles[vertex] == 0)
+		{
+			continue;
+		}
+
+		int priority = 0;
+		if (time - m_cacheTimes[vertex] + 2 * m_liveTriangles[vertex] <= g_CacheSize)
+		{
+			priority = (int)(time - m_cacheTimes[vertex]);
+		}
+		if (priority > bestPriority)
+		{
+			bestPriority = priority;
+			bestVertex = (int)vertex;
+		}
+	}
+
+	if (bestVertex >= 0)
+	{
+		return(bestVertex);
+	}
+
+	// dead end, try the vertices used most recently
+	while (m_deadEnds.empty() == false)
+	{
+		GLuint vertex = m_deadEnds.back();
+		m_deadEnds.pop_back();
+		if (m_liveTriangles[vertex] > 0)
+		{
+			bCacheFlushed = (time - m_cacheTimes[vertex] > g_CacheSize);
+			return((int)vertex);
+		}
+	}
+
+	// then continue with the input order
+	while (cursor < indexCount)
+	{
+		GLuint vertex = mesh.indices[firstIndex + cursor];
+		cursor++;
+		if (m_liveTriangles[vertex] > 0)
+		{
+			bCacheFlushed = true;
+			return((int)vertex);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  SortClusters()
+ *
+ *  This method is used for writing the reordered triangles
+ *  of one part back into the mesh, with the clusters that
+ *  face away from the center of the mesh first.  Those are
+ *  the most likely to occlude the rest of the mesh, so
+ *  drawing them first reduces overdraw from any direction.
+ ***********************************************************/
+void MeshOptimizer::SortClusters(
+	MeshData& mesh,
+	GLuint firstIndex,
+	const float centroid[3])
+{
+	const GLuint nTriangles = (GLuint)m_orderedTriangles.size();
+	const GLuint nClusters = (GLuint)m_clusterStarts.size();
+	if (nTriangles == 0)
+	{
+		return;
+	}
+
+	m_indexCopy.assign(mesh.indices.begin() + firstIndex, mesh.indices.begin() + firstIndex + nTriangles * 3);
+
+	m_clusterSortKeys.resize(nClusters);
+	m_clusterOrder.resize(nClusters);
+	for (GLuint c = 0; c < nClusters; c++)
+	{
+		GLuint last = (c + 1 < nClusters) ? m_clusterStarts[c + 1] : nTriangles;
+		float center[3] = { 0.0f, 0.0f, 0.0f };
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		float totalArea = 0.0f;
+
+		for (GLuint t = m_clusterStarts[c]; t < last; t++)
+		{
+			const GLuint* pTriangle = &m_indexCopy[m_orderedTriangles[t] * 3];
+			const GLfloat* p0 = &mesh.vertices[pTriangle[0] * MeshData::FLOATS_PER_VERTEX];
+			const GLfloat* p1 = &mesh.vertices[pTriangle[1] * MeshData::FLOATS_PER_VERTEX];
+			const GLfloat* p2 = &mesh.vertices[pTriangle[2] * MeshData::FLOATS_PER_VERTEX];
+
+			// the cross product length is twice the triangle area,
+			// so both sums below are area weighted
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float cross[3] = {
+				e1[1] * e2[2] - e1[2] * e2[1],
+				e1[2] * e2[0] - e1[0] * e2[2],
+				e1[0] * e2[1] - e1[1] * e2[0] };
+			float area = sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+
+			for (int k = 0; k < 3; k++)
+			{
+				normal[k] += cross[k];
+				center[k] += area * (p0[k] + p1[k] + p2[k]) / 3.0f;
+			}
+			totalArea += area;
+		}
+
+		float key = 0.0f;
+		float normalLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if ((totalArea > 0.0f) && (normalLength > 0.0f))
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				key += (center[k] / totalArea - centroid[k]) * normal[k] / normalLength;
+			}
+		}
+		m_clusterSortKeys[c] = key;
+		m_clusterOrder[c] = c;
+	}
+
+	ClusterKeyGreater greater;
+	greater.pKeys = &m_clusterSortKeys;
+	std::stable_sort(m_clusterOrder.begin(), m_clusterOrder.end(), greater);
+
+	GLuint* pOut = &mesh.indices[0] + firstIndex;
+	for (GLuint i = 0; i < nClusters; i++)
+	{
+		GLuint c = m_clusterOrder[i];
+		GLuint last = (c + 1 < nClusters) ? m_clusterStarts[c + 1] : nTriangles;
+		for (GLuint t = m_clusterStarts[c]; t < last; t++)
+		{
+			const GLuint* pTriangle = &m_indexCopy[m_orderedTriangles[t] * 3];
+			*pOut++ = pTriangle[0];
+			*pOut++ = pTriangle[1];
+			*pOut++ = pTriangle[2];
+		}
+	}
+}
+
+/***********************************************************
+ *  RemapVertices()
+ *
+ *  This method is used for reordering the vertex buffer so
+ *  that the vertices are fetched sequentially.  Vertices no
+ *  triangle uses are kept at the end.
+ ***********************************************************/
+void MeshOptimizer::RemapVertices(MeshData& mesh)
+{
+	const GLuint nVertices = mesh.VertexCount();
+	const GLuint nIndices = mesh.IndexCount();
+	GLuint nextVertex = 0;
+
+	m_remap.assign(nVertices, g_NoVertex);
+	for (GLuint i = 0; i < nIndices; i++)
+	{
+		GLuint& newVertex = m_remap[mesh.indices[i]];
+		if (newVertex == g_NoVertex)
+		{
+			newVertex = nextVertex++;
+		}
+		mesh.indices[i] = newVertex;
+	}
+	for (GLuint i = 0; i < nVertices; i++)
+	{
+		if (m_remap[i] == g_NoVertex)
+		{
+			m_remap[i] = nextVertex++;
+		}
+	}
+
+	m_vertexCopy = mesh.vertices;
+	for (GLuint i = 0; i < nVertices; i++)
+	{
+		std::copy(
+			m_vertexCopy.begin() + i * MeshData::FLOATS_PER_VERTEX,
+			m_vertexCopy.begin() + (i + 1) * MeshData::FLOATS_PER_VERTEX,
+			mesh.vertices.begin() + m_remap[i] * MeshData::FLOATS_PER_VERTEX);
+	}
+}
@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// reorder the triangles and vertices of a mesh for the post-transform
+// vertex cache, overdraw and vertex fetch before it is uploaded
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+#include <vector>
+
+/***********************************************************
+ *  MeshOptimizer
+ *
+ *  This class contains the code for optimizing the draw order
+ *  of an indexed triangle list.  The triangles of every mesh
+ *  part are reordered with the Tipsify algorithm, the clusters
+ *  it produces are sorted so that outward facing ones are drawn
+ *  first, and the vertices are then renumbered in the order
+ *  they are first used.  Triangles never move between parts,
+ *  so partial draws like the half sphere stay valid.
+ ***********************************************************/
+class MeshOptimizer
+{
+public:
+	// constructor
+	MeshOptimizer();
+
+	// average cache miss ratio (misses per triangle) and
+	// average transform to vertex ratio (misses per used
+	// vertex) of a simulated FIFO vertex cache
+	struct CacheStats
+	{
+		float acmr;
+		float atvr;
+	};
+
+	// optimize the passed in mesh in place, optionally
+	// reporting the cache statistics before and after
+	void Optimize(
+		MeshData& mesh,
+		CacheStats* pBefore = NULL,
+		CacheStats* pAfter = NULL);
+
+	// simulate the vertex cache for the passed in mesh
+	CacheStats AnalyzeCache(const MeshData& mesh);
+
+private:
+	// triangles that use each vertex, stored as offsets
+	// into one shared list
+	std::vector<GLuint> m_adjacencyOffsets;
+	std::vector<GLuint> m_adjacency;
+	// number of not yet emitted triangles using each vertex
+	std::vector<GLuint> m_liveTriangles;
+	// time each vertex last entered the cache
+	std::vector<GLuint> m_cacheTimes;
+	std::vector<bool> m_bEmitted;
+	std::vector<GLuint> m_deadEnds;
+	std::vector<GLuint> m_candidates;
+
+	// the reordered triangles and the first triangle of
+	// every cluster in them
+	std::vector<GLuint> m_orderedTriangles;
+	std::vector<GLuint> m_clusterStarts;
+	std::vector<GLuint> m_clusterOrder;
+	std::vector<float> m_clusterSortKeys;
+
+	// scratch copies used while rewriting the mesh
+	std::vector<GLuint> m_indexCopy;
+	std::vector<GLfloat> m_vertexCopy;
+	std::vector<GLuint> m_remap;
+
+	// reorder the triangles of one part for the vertex cache
+	void TipsifyPart(
+		const MeshData& mesh,
+		GLuint firstIndex,
+		GLuint indexCount);
+
+	// pick the next vertex to fan around, or -1 when done
+	int NextVertex(
+		const MeshData& mesh,
+		GLuint firstIndex,
+		GLuint indexCount,
+		GLuint time,
+		GLuint& cursor,
+		bool& bCacheFlushed);
+
+	// reorder the clusters of one part to reduce overdraw
+	void SortClusters(
+		MeshData& mesh,
+		GLuint firstIndex,
+		const float centroid[3]);
+
+	// renumber the vertices in the order they are first used
+	void RemapVertices(MeshData& mesh);
+};
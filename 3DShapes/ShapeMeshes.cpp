@@ -9,12 +9,19 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "shapemeshes.h"
+#include "ResourceRegistry.h"
+#include "WorkerPool.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/packing.hpp>
 
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <iostream>
 #include <vector>
 
 namespace
@@ -24,11 +31,70 @@ namespace
 	const GLuint g_FloatsPerVertex = 3;	// Number of coordinates per vertex
 	const GLuint g_FloatsPerNormal = 3;	// Number of values per vertex color
 	const GLuint g_FloatsPerUV = 2;		// Number of texture coordinate values
+
+	// byte offsets of the packed normal and UV in a compact
+	// vertex, which is 20 bytes in total
+	const GLuint g_CompactNormalOffset = sizeof(GLfloat) * g_FloatsPerVertex;
+	const GLuint g_CompactUVOffset = g_CompactNormalOffset + sizeof(GLuint);
+	const GLuint g_CompactVertexSize = g_CompactUVOffset + 2 * sizeof(GLushort);
+
+	// fewest segments and sphere stacks of the coarsest detail level
+	const GLuint g_MinLODSegments = 8;
+	const GLuint g_MinLODStacks = 4;
+
+	// default projected diameters in pixels at which the coarser
+	// detail levels start, and the hysteresis fraction
+	const float g_DefaultLODThresholds[] = { 160.0f, 64.0f, 24.0f };
+	const float g_DefaultLODHysteresis = 0.15f;
+
+	// increase when the generator or optimizer output changes,
+	// so that meshes cached by an older version are not used
+	const uint32_t g_MeshCacheGeneratorVersion = 1;
+
+	// starting size of the shared arena buffers, they grow as needed
+	const GLuint g_ArenaInitialVertices = 65536;
+	const GLuint g_ArenaInitialIndexBytes = 1048576;
+
+	// attribute locations of the per-instance model transform,
+	// which takes four locations, and color in the vertex shader
+	const GLuint g_InstanceTransformLocation = 3;
+	const GLuint g_InstanceColorLocation = 7;
+	// starting size of the instance buffer, it grows as needed
+	const GLuint g_InstanceInitialBytes = 65536;
+	// starting size of the indirect command buffer, it grows as needed
+	const GLuint g_IndirectInitialBytes = 16384;
 }
 
-ShapeMeshes::ShapeMeshes()
+ShapeMeshes::ShapeMeshes(bool bUseArena, bool bCompactVertices)
 {
 	m_bMemoryLayoutDone = false;
+	m_bUseArena = bUseArena;
+	m_boundVAO = 0;
+	m_boundIndirectBuffer = 0;
+	m_bCompactVertices = bCompactVertices;
+	m_bDeferLoading = false;
+	if (m_bCompactVertices == true)
+	{
+		m_vertexStride = g_CompactVertexSize;
+	}
+	else
+	{
+		m_vertexStride = sizeof(GLfloat) * MeshData::FLOATS_PER_VERTEX;
+	}
+
+	m_bLODCameraSet = false;
+	m_lodView = glm::mat4(1.0f);
+	m_lodProjection = glm::mat4(1.0f);
+	m_lodModel = glm::mat4(1.0f);
+	m_viewportHeight = 0.0f;
+	m_lodDrawID = 0;
+	m_instanceVBO = 0;
+	m_instanceCapacity = 0;
+	m_pRecordedDraws = NULL;
+	m_recordingState = 0;
+	m_indirectBuffer = 0;
+	m_indirectCapacity = 0;
+	SetLODThresholds(g_DefaultLODThresholds, MAX_LODS - 1, g_DefaultLODHysteresis);
 }
 
 ///////////////////////////////////////////////////
@@ -102,472 +168,48 @@ void ShapeMeshes::LoadBoxMesh()
 		20,23,22
 	};
 
-	m_BoxMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_BoxMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
-
-	glGenVertexArrays(1, &m_BoxMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_BoxMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(2, m_BoxMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_BoxMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_BoxMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	m_generator.BuildFromArrays(
+		m_meshData,
+		verts,
+		sizeof(verts) / (sizeof(verts[0]) * MeshData::FLOATS_PER_VERTEX),
+		indices,
+		sizeof(indices) / sizeof(indices[0]));
+	UploadMesh(m_BoxMesh, m_meshData, "Box");
 }
 
 ///////////////////////////////////////////////////
 //	LoadConeMesh()
 //
-//	Create a cole mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	Generate a cone mesh with the passed in number of
+//  segments and store it in a VAO/VBO.  The normals
+//  and texture coordinates are also set.
 //
 //  Correct triangle drawing commands:
 //
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
+//	glDrawElements(GL_TRIANGLES, bottom.indexCount, GL_UNSIGNED_INT, bottom.firstIndex);	//bottom
+//	glDrawElements(GL_TRIANGLES, sides.indexCount, GL_UNSIGNED_INT, sides.firstIndex);		//sides
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadConeMesh()
+void ShapeMeshes::LoadConeMesh(GLuint segments)
 {
-	GLfloat verts[] = {
-		// cone bottom			// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cone sides		// normals									// texture coords
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, -0.116841137f, 		1.0f,0.5f,
-		0.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, -0.116841137f, 		0.5f, 0.5f,
-		.98f, 0.0f, -0.17f,		0.993150651f, 0.0f, -0.116841137f, 		0.983f,0.6f,
-		.98f, 0.0f, -0.17f,		0.973417103f, 0.0f, -0.229039446f, 		0.983f,0.6f,
-		0.0f, 1.0f, 0.0f,		0.973417103f, 0.0f, -0.229039446f, 		0.5f, 0.5f,
-		.94f, 0.0f, -0.34f,		0.973417103f, 0.0f, -0.229039446f, 		0.96f,0.68f,
-		.94f, 0.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f, 		0.96f,0.68f,
-		0.0f, 1.0f, 0.0f,		0.916157305f, 0.0f, -0.400818795f, 		0.5f, 0.5f,
-		.87f, 0.0f, -0.5f,		0.916157305f, 0.0f, -0.400818795f, 		0.92f,0.77f,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f, 		0.92f,0.77f,
-		0.0f, 1.0f, 0.0f,		0.813733339f, 0.0f, -0.581238329f, 		0.5f, 0.5f,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.0f, -0.581238329f, 		0.87f, 0.83f,
-		.77f, 0.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f, 		0.87f, 0.83f,
-		0.0f, 1.0f, 0.0f,		0.707106769f, 0.0f, -0.707106769f, 		0.5f, 0.5f,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.0f, -0.707106769f, 		0.83f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f, 		0.83f, 0.87f,
-		0.0f, 1.0f, 0.0f,		0.581238329f, 0.0f, -0.813733339f, 		0.5f, 0.5f,
-		.5f, 0.0f, -0.87f,		0.581238329f, 0.0f, -0.813733339f, 		0.77f, 0.92f,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f, 		0.77f, 0.92f,
-		0.0f, 1.0f, 0.0f,		0.400818795f, 0.0f, -0.916157305f, 		0.5f, 0.5f,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.0f, -0.916157305f, 		0.68f, 0.96f,
-		.34f, 0.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f, 		0.68f, 0.96f,
-		0.0f, 1.0f, 0.0f,		0.229039446f, 0.0f, -0.973417103f, 		0.5f, 0.5f,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.0f, -0.973417103f, 		0.6f, 0.983f,
-		.17f, 0.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f, 		0.6f, 0.983f,
-		0.0f, 1.0f, 0.0f,		0.116841137f, 0.0f, -0.993150651f, 		0.5f, 0.5f,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f, 		0.5f, 1.0f,
-
-		0.0f, 0.0f, -1.0f,		-0.116841137f, 0.0f, -0.993150651f, 		0.5f, 1.0f,
-		0.0f, 1.0f, 0.0f,		-0.116841137f, 0.0f, -0.993150651f, 		0.5f, 0.5f,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.0f, -0.993150651f, 		0.41f, 0.983f,
-		-.17f, 0.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f, 		0.41f, 0.983f,
-		0.0f, 1.0f, 0.0f,		-0.229039446f, 0.0f, -0.973417103f, 		0.5f, 0.5f,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.0f, -0.973417103f, 		0.33f, 0.96f,
-		-.34f, 0.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f, 		0.33f, 0.96f,
-		0.0f, 1.0f, 0.0f,		-0.400818795f, 0.0f, -0.916157305f, 		0.5f, 0.5f,
-		-.5f, 0.0f, -0.87f,		-0.400818795f, 0.0f, -0.916157305f, 		0.25f, 0.92f,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f, 		0.25f, 0.92f,
-		0.0f, 1.0f, 0.0f,		-0.581238329f, 0.0f, -0.813733339f, 		0.5f, 0.5f,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.0f, -0.813733339f, 		0.17f, 0.87f,
-		-.64f, 0.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f, 		0.17f, 0.87f,
-		0.0f, 1.0f, 0.0f,		-0.707106769f, 0.0f, -0.707106769f, 		0.5f, 0.5f,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.0f, -0.707106769f, 		0.13f, 0.83f,
-		-.77f, 0.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f, 		0.13f, 0.83f,
-		0.0f, 1.0f, 0.0f,		-0.813733339f, 0.0f, -0.581238329f, 		0.5f, 0.5f,
-		-.87f, 0.0f, -0.5f,		-0.813733339f, 0.0f, -0.581238329f, 		0.08f, 0.77f,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f, 		0.08f, 0.77f,
-		0.0f, 1.0f, 0.0f,		-0.916157305f, 0.0f, -0.400818795f, 		0.5f, 0.5f,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.0f, -0.400818795f, 		0.04f, 0.68f,
-		-.94f, 0.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f, 		0.04f, 0.68f,
-		0.0f, 1.0f, 0.0f,		-0.973417103f, 0.0f, -0.229039446f, 		0.5f, 0.5f,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.0f, -0.229039446f, 		0.017f, 0.6f,
-		-.98f, 0.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f, 		0.017f, 0.6f,
-		0.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.5f, 0.5f,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.0f, 0.5f,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.0f, 0.5f,
-		0.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, 0.116841137f, 		0.5f, 0.5f,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.0f, 0.116841137f, 		0.017f, 0.41f,
-		-.98f, 0.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f, 		0.017f, 0.41f,
-		0.0f, 1.0f, 0.0f,		-0.973417103f, 0.0f, 0.229039446f, 		0.5f, 0.5f,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.0f, 0.229039446f, 		0.04f, 0.33f,
-		-.94f, 0.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f, 		0.04f, 0.33f,
-		0.0f, 1.0f, 0.0f,		-0.916157305f, 0.0f, 0.400818795f, 		0.5f, 0.5f,
-		-.87f, 0.0f, 0.5f,		-0.916157305f, 0.0f, 0.400818795f, 		0.08f, 0.25f,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f, 		0.08f, 0.25f,
-		0.0f, 1.0f, 0.0f,		-0.813733339f, 0.0f, 0.581238329f, 		0.5f, 0.5f,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.0f, 0.581238329f, 		0.13f, 0.17f,
-		-.77f, 0.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f, 		0.13f, 0.17f,
-		0.0f, 1.0f, 0.0f,		-0.707106769f, 0.0f, 0.707106769f, 		0.5f, 0.5f,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.0f, 0.707106769f, 		0.17f, 0.13f,
-		-.64f, 0.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f, 		0.17f, 0.13f,
-		0.0f, 1.0f, 0.0f,		-0.581238329f, 0.0f, 0.813733339f, 		0.5f, 0.5f,
-		-.5f, 0.0f, 0.87f,		-0.581238329f, 0.0f, 0.813733339f, 		0.25f, 0.08f,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f, 		0.25f, 0.08f,
-		0.0f, 1.0f, 0.0f,		-0.400818795f, 0.0f, 0.916157305f, 		0.5f, 0.5f,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.0f, 0.916157305f, 		0.33f, 0.04f,
-		-.34f, 0.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f, 		0.33f, 0.04f,
-		0.0f, 1.0f, 0.0f,		-0.229039446f, 0.0f, 0.973417103f, 		0.5f, 0.5f,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.0f, 0.973417103f, 		0.41f, 0.017f,
-		-.17f, 0.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f, 		0.41f, 0.017f,
-		0.0f, 1.0f, 0.0f,		-0.116841137f, 0.0f, 0.993150651f, 		0.5f, 0.5f,
-		0.0f, 0.0f, 1.0f,		-0.116841137f, 0.0f, 0.993150651f, 		0.5f, 0.0f,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f, 	0.5f, 0.0f,
-		0.0f, 1.0f, 0.0f,		0.116841137f, 0.0f, 0.993150651f, 	0.5f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.0f, 0.993150651f, 	0.6f, 0.017f,
-		.17f, 0.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f, 	0.6f, 0.017f,
-		0.0f, 1.0f, 0.0f,		0.229039446f, 0.0f, 0.973417103f, 	0.5f, 0.5f,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.0f, 0.973417103f, 	0.68f, 0.04f,
-		.34f, 0.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f, 	0.68f, 0.04f,
-		0.0f, 1.0f, 0.0f,		0.400818795f, 0.0f, 0.916157305f, 	0.5f, 0.5f,
-		.5f, 0.0f, 0.87f,		0.400818795f, 0.0f, 0.916157305f, 	0.77f, 0.08f,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f, 	0.77f, 0.08f,
-		0.0f, 1.0f, 0.0f,		0.581238329f, 0.0f, 0.813733339f, 	0.5f, 0.5f,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.0f, 0.813733339f, 	0.83f, 0.13f,
-		.64f, 0.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f, 	0.83f, 0.13f,
-		0.0f, 1.0f, 0.0f,		0.707106769f, 0.0f, 0.707106769f, 	0.5f, 0.5f,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.0f, 0.707106769f, 	0.87f, 0.17f,
-		.77f, 0.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f, 	0.87f, 0.17f,
-		0.0f, 1.0f, 0.0f,		0.813733339f, 0.0f, 0.581238329f, 	0.5f, 0.5f,
-		.87f, 0.0f, 0.5f,		0.813733339f, 0.0f, 0.581238329f, 	0.92f, 0.25f,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f, 	0.92f, 0.25f,
-		0.0f, 1.0f, 0.0f,		0.916157305f, 0.0f, 0.400818795f, 	0.5f, 0.5f,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.0f, 0.400818795f, 	0.96f, 0.33f,
-		.94f, 0.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f, 	0.96f, 0.33f,
-		0.0f, 1.0f, 0.0f,		0.973417103f, 0.0f, 0.229039446f, 	0.5f, 0.5f,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.0f, 0.229039446f, 	0.983f, 0.41f,
-		.98f, 0.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f, 	0.983f, 0.41f,
-		0.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f, 	0.5f, 0.5f,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f, 	1.0f, 0.5f
-	};
-
-	// store vertex and index count
-	m_ConeMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_ConeMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_ConeMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_ConeMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_ConeMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_ConeMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	LoadMeshLODs(m_ConeMesh, SHAPE_CONE, segments, 0, 0.0f, "Cone");
 }
 
 ///////////////////////////////////////////////////
 //	LoadCylinderMesh()
 //
-//	Create a cylinder mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	Generate a cylinder mesh with the passed in number
+//  of segments and store it in a VAO/VBO.  The normals
+//  and texture coordinates are also set.
 //
 //  Correct triangle drawing commands:
 //
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_FAN, 36, 36);		//top
-//	glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+//	glDrawElements(GL_TRIANGLES, bottom.indexCount, GL_UNSIGNED_INT, bottom.firstIndex);	//bottom
+//	glDrawElements(GL_TRIANGLES, top.indexCount, GL_UNSIGNED_INT, top.firstIndex);			//top
+//	glDrawElements(GL_TRIANGLES, sides.indexCount, GL_UNSIGNED_INT, sides.firstIndex);		//sides
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadCylinderMesh()
+void ShapeMeshes::LoadCylinderMesh(GLuint segments)
 {
-	GLfloat verts[] = {
-		// cylinder bottom		// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder top			// normals			// texture coords
-		1.0f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 1.0f, -0.17f,		0.0f, 1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 1.0f, -0.34f,		0.0f, 1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 1.0f, -0.64f,		0.0f, 1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 1.0f, -0.77f,		0.0f, 1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 1.0f, -0.87f,		0.0f, 1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 1.0f, -0.94f,		0.0f, 1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 1.0f, -0.98f,		0.0f, 1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 1.0f, -1.0f,		0.0f, 1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 1.0f, -0.98f,	0.0f, 1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 1.0f, -0.94f,	0.0f, 1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 1.0f, -0.87f,		0.0f, 1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 1.0f, -0.77f,	0.0f, 1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 1.0f, -0.64f,	0.0f, 1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 1.0f, -0.34f,	0.0f, 1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 1.0f, -0.17f,	0.0f, 1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 1.0f, 0.34f,		0.0f, 1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 1.0f, 0.64f,		0.0f, 1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 1.0f, 0.77f,		0.0f, 1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 1.0f, 0.87f,		0.0f, 1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 1.0f, 0.94f,		0.0f, 1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 1.0f, 0.98f,		0.0f, 1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 1.0f, 1.0f,		0.0f, 1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 1.0f, 0.98f,		0.0f, 1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 1.0f, 0.94f,		0.0f, 1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 1.0f, 0.87f,		0.0f, 1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 1.0f, 0.77f,		0.0f, 1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 1.0f, 0.64f,		0.0f, 1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 1.0f, 0.34f,		0.0f, 1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder body		// normals							// texture coords
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,0.0,
-		.98f, 0.0f, -0.17f,		0.993150651f, 0.5f, -0.116841137f,	0.0277,0.0,
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,1.0,
-		.98f, 1.0f, -0.17f,		0.973417103f, 0.5f, -0.229039446f,	0.0277,1.0,
-		.98f, 0.0f, -0.17f,		0.973417103f, 0.5f, -0.229039446f,	0.0277,0.0,
-		.94f, 0.0f, -0.34f,		0.973417103f, 0.0f, -0.229039446f,	0.0554,0.0,
-		.98f, 1.0f, -0.17f,		0.973417103f, 0.0f, -0.229039446f,	0.0277,1.0,
-		.94f, 1.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,1.0,
-		.94f, 0.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,0.0,
-		.87f, 0.0f, -0.5f,		0.916157305f, 0.0f, -0.400818795f,	0.0831,0.0,
-		.94f, 1.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,1.0,
-		.87f, 1.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,1.0,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,0.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.0f, -0.581238329f,	0.1108,0.0,
-		.87f, 1.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,1.0,
-		.77f, 1.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,1.0,
-		.77f, 0.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,0.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.0f, -0.707106769f,	0.1385,0.0,
-		.77f, 1.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,1.0,
-		.64f, 1.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385,1.0,
-		.64f, 0.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385,0.0,
-		.5f, 0.0f, -0.87f,		0.581238329f, 0.0f, -0.813733339f,	0.1662,0.0,
-		.64f, 1.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385, 1.0,
-		.5f, 1.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 1.0,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 0.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.0f, -0.916157305f,	0.1939, 0.0,
-		.5f, 1.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 1.0,
-		.34f, 1.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 1.0,
-		.34f, 0.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 0.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.0f, -0.973417103f,	0.2216, 0.0,
-		.34f, 1.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 1.0,
-		.17f, 1.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 1.0,
-		.17f, 0.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 0.0,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 0.0,
-		.17f, 1.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 1.0,
-		0.0f, 1.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 1.0,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 0.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.0f, -0.993150651f,	0.277, 0.0,
-		0.0f, 1.0f, -1.0f,		-0.116841137f, 0.0f, -0.993150651f,	0.2493, 1.0,
-		-.17f, 1.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 1.0,
-		-.17f, 0.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 0.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.0f, -0.973417103f,	0.3047, 0.0,
-		-.17f, 1.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 1.0,
-		-.34f, 1.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 1.0,
-		-.34f, 0.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 0.0,
-		-.5f, 0.0f, -0.87f,		-0.400818795f, 0.0f, -0.916157305f,	0.3324, 0.0,
-		-.34f, 1.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 1.0,
-		-.5f, 1.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 1.0,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 0.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.0f, -0.813733339f,	0.3601, 0.0,
-		-.5f, 1.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 1.0,
-		-.64f, 1.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 1.0,
-		-.64f, 0.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 0.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.0f, -0.707106769f,	0.3878, 0.0,
-		-.64f, 1.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 1.0,
-		-.77f, 1.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 1.0,
-		-.77f, 0.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 0.0,
-		-.87f, 0.0f, -0.5f,		-0.813733339f, 0.0f, -0.581238329f,	0.4155, 0.0,
-		-.77f, 1.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 1.0,
-		-.87f, 1.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 1.0,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 0.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.0f, -0.400818795f,	0.4432, 0.0,
-		-.87f, 1.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 1.0,
-		-.94f, 1.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 1.0,
-		-.94f, 0.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 0.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.0f, -0.229039446f,	0.4709, 0.0,
-		-.94f, 1.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 1.0,
-		-.98f, 1.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 1.0,
-		-.98f, 0.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 0.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 1.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 1.0,
-		-1.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 1.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.0f, 0.116841137f,	0.5263, 0.0,
-		-1.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, 0.116841137f,	0.4986, 1.0,
-		-.98f, 1.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 1.0,
-		-.98f, 0.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 0.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.0f, 0.229039446f,	0.554, 0.0,
-		-.98f, 1.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 1.0,
-		-.94f, 1.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 1.0,
-		-.94f, 0.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 0.0,
-		-.87f, 0.0f, 0.5f,		-0.916157305f, 0.0f, 0.400818795f,	0.5817, 0.0,
-		-.94f, 1.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 1.0,
-		-.87f, 1.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 1.0,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 0.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.0f, 0.581238329f,	0.6094, 0.0,
-		-.87f, 1.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 1.0,
-		-.77f, 1.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 1.0,
-		-.77f, 0.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 0.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.0f, 0.707106769f,	0.6371, 0.0,
-		-.77f, 1.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 1.0,
-		-.64f, 1.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 1.0,
-		-.64f, 0.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 0.0,
-		-.5f, 0.0f, 0.87f,		-0.581238329f, 0.0f, 0.813733339f,	0.6648, 0.0,
-		-.64f, 1.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 1.0,
-		-.5f, 1.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 1.0,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 0.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.0f, 0.916157305f,	0.6925, 0.0,
-		-.5f, 1.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 1.0,
-		-.34f, 1.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 1.0,
-		-.34f, 0.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 0.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.0f, 0.973417103f,	0.7202, 0.0,
-		-.34f, 1.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 1.0,
-		-.17f, 1.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 1.0,
-		-.17f, 0.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 0.0,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 0.0,
-		-.17f, 1.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 1.0,
-		0.0f, 1.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 1.0,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 0.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.0f, 0.993150651f,	0.7756, 0.0,
-		0.0f, 1.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 1.0,
-		.17f, 1.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 1.0,
-		.17f, 0.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 0.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.0f, 0.973417103f,	0.8033, 0.0,
-		.17f, 1.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 1.0,
-		.34f, 1.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 1.0,
-		.34f, 0.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 0.0,
-		.5f, 0.0f, 0.87f,		0.400818795f, 0.0f, 0.916157305f,	0.831, 0.0,
-		.34f, 1.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 1.0,
-		.5f, 1.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 1.0,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 0.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.0f, 0.813733339f,	0.8587, 0.0,
-		.5f, 1.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 1.0,
-		.64f, 1.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 1.0,
-		.64f, 0.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 0.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.0f, 0.707106769f,	0.8864, 0.0,
-		.64f, 1.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 1.0,
-		.77f, 1.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 1.0,
-		.77f, 0.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 0.0,
-		.87f, 0.0f, 0.5f,		0.813733339f, 0.0f, 0.581238329f,	0.9141, 0.0,
-		.77f, 1.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 1.0,
-		.87f, 1.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 1.0,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 0.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.0f, 0.400818795f,	0.9418, 0.0,
-		.87f, 1.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 1.0,
-		.94f, 1.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 1.0,
-		.94f, 0.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 0.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.0f, 0.229039446f,	0.9695, 0.0,
-		.94f, 1.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 1.0,
-		.98f, 1.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 1.0,
-		.98f, 0.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 0.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 0.0,
-		.98f, 1.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 1.0,
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 0.0
-	};
-
-	glm::vec3 normal;
-
-	normal = CalculateTriangleNormal(glm::vec3(.98f, 1.0f, 0.17f), glm::vec3(.98f, 0.0f, 0.17f), glm::vec3(1.0f, 0.0f, 0.0f));
-
-	// store vertex and index count
-	m_CylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_CylinderMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_CylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_CylinderMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_CylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_CylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	LoadMeshLODs(m_CylinderMesh, SHAPE_CYLINDER, segments, 0, 0.0f, "Cylinder");
 }
 
 ///////////////////////////////////////////////////
@@ -598,26 +240,13 @@ void ShapeMeshes::LoadPlaneMesh()
 		0,3,2
 	};
 
-	// store vertex and index count
-	m_PlaneMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_PlaneMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
-
-	// Generate the VAO for the mesh
-	glGenVertexArrays(1, &m_PlaneMesh.vao);
-	glBindVertexArray(m_PlaneMesh.vao);	// activate the VAO
-
-	// Create VBOs for the mesh
-	glGenBuffers(2, m_PlaneMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PlaneMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_PlaneMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	m_generator.BuildFromArrays(
+		m_meshData,
+		verts,
+		sizeof(verts) / (sizeof(verts[0]) * MeshData::FLOATS_PER_VERTEX),
+		indices,
+		sizeof(indices) / sizeof(indices[0]));
+	UploadMesh(m_PlaneMesh, m_meshData, "Plane");
 }
 
 ///////////////////////////////////////////////////
@@ -629,7 +258,7 @@ void ShapeMeshes::LoadPlaneMesh()
 //
 //	Correct triangle drawing command:
 //
-//	glDrawArrays(GL_TRIANGLE_STRIP, 0, meshes.gPrismMesh.nVertices);
+//	glDrawElements(GL_TRIANGLES, meshes.gPrismMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPrismMesh()
 {
@@ -682,20 +311,12 @@ void ShapeMeshes::LoadPrismMesh()
 
 	};
 
-	m_PrismMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_PrismMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_PrismMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(1, m_PrismMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PrismMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the mesh was authored as a triangle strip
+	m_generator.BuildFromStrip(
+		m_meshData,
+		verts,
+		sizeof(verts) / (sizeof(verts[0]) * MeshData::FLOATS_PER_VERTEX));
+	UploadMesh(m_PrismMesh, m_meshData, "Prism");
 }
 
 ///////////////////////////////////////////////////
@@ -707,7 +328,7 @@ void ShapeMeshes::LoadPrismMesh()
 //
 //  Correct triangle drawing command:
 //
-//	glDrawArrays(GL_TRIANGLE_STRIP, 0, gPyramid3Mesh.nVertices);
+//	glDrawElements(GL_TRIANGLES, gPyramid3Mesh.nIndices, GL_UNSIGNED_INT, (void*)0);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPyramid3Mesh()
 {
@@ -736,20 +357,12 @@ void ShapeMeshes::LoadPyramid3Mesh()
 		-0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	0.0f, 1.0f,     //front bottom left
 	};
 
-	// Calculate total defined vertices
-	m_Pyramid3Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_Pyramid3Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid3Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid3Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid3Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the mesh was authored as a triangle strip
+	m_generator.BuildFromStrip(
+		m_meshData,
+		verts,
+		sizeof(verts) / (sizeof(verts[0]) * MeshData::FLOATS_PER_VERTEX));
+	UploadMesh(m_Pyramid3Mesh, m_meshData, "Pyramid3");
 }
 
 ///////////////////////////////////////////////////
@@ -761,7 +374,7 @@ void ShapeMeshes::LoadPyramid3Mesh()
 //
 //  Correct triangle drawing command:
 //
-//	glDrawArrays(GL_TRIANGLE_STRIP, 0, meshes.gPyramid4Mesh.nVertices);
+//	glDrawElements(GL_TRIANGLES, meshes.gPyramid4Mesh.nIndices, GL_UNSIGNED_INT, (void*)0);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPyramid4Mesh()
 {
@@ -799,1389 +412,93 @@ void ShapeMeshes::LoadPyramid4Mesh()
 		0.0f, 0.5f, 0.0f,		0.0f, 0.0f, 1.0f,	0.5f, 1.0f,		//top point
 	};
 
-	// Calculate total defined vertices
-	m_Pyramid4Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_Pyramid4Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid4Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid4Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid4Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the mesh was authored as a triangle strip
+	m_generator.BuildFromStrip(
+		m_meshData,
+		verts,
+		sizeof(verts) / (sizeof(verts[0]) * MeshData::FLOATS_PER_VERTEX));
+	UploadMesh(m_Pyramid4Mesh, m_meshData, "Pyramid4");
 }
 
 ///////////////////////////////////////////////////
 //	LoadSphereMesh()
 //
-//	Create a sphere mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	Generate a sphere mesh with the passed in number
+//  of slices and stacks and store it in a VAO/VBO.
+//  The normals and texture coordinates are also set.
 //
 //  Correct triangle drawing command:
 //
 //	glDrawElements(GL_TRIANGLES, meshes.gSphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadSphereMesh()
+void ShapeMeshes::LoadSphereMesh(GLuint slices, GLuint stacks)
 {
-	GLfloat verts[] = {
-		// vertex data					// texture coords			// index
-		// top center point
-		0.0f, 1.0f, 0.0f,				0.5f, 1.0f,					//0
-		// ring 1
-		0.0f, 0.9808f, 0.1951f,			0.5f, 0.9375f,				//1
-		0.0747f, 0.9808f, 0.1802f,		0.51219375f, 0.9375f,		//2
-		0.1379f, 0.9808f, 0.1379f,		0.5243875f, 0.9375f,		//3
-		0.1802f, 0.9808f, 0.0747f,		0.53658125f, 0.9375f,		//4
-		0.1951f, 0.9808, 0.0f,			0.548775f, 0.9375f,			//5
-		0.1802f, 0.9808f, -0.0747f,		0.56096875f, 0.9375f,		//6
-		0.1379f, 0.9808f, -0.1379f,		0.5731625f, 0.9375f,		//7
-		0.0747f, 0.9808f, -0.1802f,		0.58535625f, 0.9375f,		//8
-		0.0f, 0.9808f, -0.1951f,		0.59755f, 0.9375f,			//9 - seam
-		0.0f, 0.9808f, -0.1951f,		0.40245f, 0.9375f,			//10 - seam
-		-0.0747f, 0.9808f, -0.1802f,	0.41464375f, 0.9375f,		//11
-		-0.1379f, 0.9808f, -0.1379f,	0.4268375f, 0.9375f,		//12
-		-0.1802f, 0.9808f, -0.0747f,	0.43903125f, 0.9375f,		//13
-		-0.1951f, 0.9808, 0.0f,			0.451225f, 0.9375f,			//14
-		-0.1802f, 0.9808f, 0.0747f,		0.46341875f, 0.9375f,		//15
-		-0.1379f, 0.9808f, 0.1379f,		0.4756125f, 0.9375f,		//16
-		-0.0747f, 0.9808f, 0.1802f,		0.48780625f, 0.9375f,		//17
-		// ring 2
-		0.0f, 0.9239f, 0.3827f,			0.5f, 0.875f,				//18
-		0.1464f, 0.9239f, 0.3536f,		0.52391875f, 0.875f,		//19
-		0.2706f, 0.9239f, 0.2706f,		0.5478375f, 0.875f,			//20
-		0.3536f, 0.9239f, 0.1464f,		0.57175625f, 0.875f,		//21
-		0.3827f, 0.9239f, 0.0f,			0.5956755f, 0.875f,			//22
-		0.3536f, 0.9239f, -0.1464f,		0.61959425f, 0.875f,		//23
-		0.2706f, 0.9239f, -0.2706f,		0.643513f, 0.875f,			//24
-		0.1464f, 0.9239f, -0.3536f,		0.66743175f, 0.875f,		//25
-		0.0f, 0.9239f, -0.3827f,		0.6913505f, 0.875f,			//26 - seam
-		0.0f, 0.9239f, -0.3827f,		0.3086495f, 0.875f,			//27 - seam
-		-0.1464f, 0.9239f, -0.3536f,	0.33256825f, 0.875f,		//28
-		-0.2706f, 0.9239f, -0.2706f,	0.356487f, 0.875f,			//29
-		-0.3536f, 0.9239f, -0.1464f,	0.38040575f, 0.875f,		//30
-		-0.3827f, 0.9239f, 0.0f,		0.4043245f, 0.875f,			//31
-		-0.3536f, 0.9239f, 0.1464f,		0.42824325f, 0.875f,		//32
-		-0.2706f, 0.9239f, 0.2706f,		0.452162f, 0.875f,			//33
-		-0.1464f, 0.9239f, 0.3536f,		0.47608075f, 0.875f,		//34
-		// ring 3
-		0.0f, 0.8315f, 0.5556f,			0.5f, 0.8125f,				//35
-		0.2126f, 0.8315f, 0.5133f,		0.534725f, 0.8125f,			//36
-		0.3928f, 0.8315f, 0.3928f,		0.56945f, 0.8125f,			//37
-		0.5133f, 0.8315f, 0.2126f,		0.604175f, 0.8125f,			//38
-		0.5556f, 0.8315f, 0.0f,			0.6389f, 0.8125f,			//39
-		0.5133f, 0.8315f, -0.2126f,		0.673625f, 0.8125f,			//40
-		0.3928f, 0.8315f, -0.3928f,		0.70835f, 0.8125f,			//41
-		0.2126f, 0.8315f, -0.5133f,		0.743075f, 0.8125f,			//42
-		0.0f, 0.8315f, -0.5556f,		0.7778f, 0.8125f,			//43 - seam
-		0.0f, 0.8315f, -0.5556f,		0.2222f, 0.8125f,			//44 - seam
-		-0.2126f, 0.8315f, -0.5133f,	0.256925f, 0.8125f,			//45
-		-0.3928f, 0.8315f, -0.3928f,	0.29165f, 0.8125f,			//46
-		-0.5133f, 0.8315f, -0.2126f,	0.326375f, 0.8125f,			//47
-		-0.5556f, 0.8315f, 0.0f,		0.3611f, 0.8125f,			//48
-		-0.5133f, 0.8315f, 0.2126f,		0.395825f, 0.8125f,			//49
-		-0.3928f, 0.8315f, 0.3928f,		0.43055f, 0.8125f,			//50
-		-0.2126f, 0.8315f, 0.5133f,		0.465275f, 0.8125f,			//51
-		// ring 4
-		0.0f, 0.7071f, 0.7071f,			0.5f, 0.75f,				//52
-		0.2706f, 0.7071f, 0.6533f,		0.54419375f, 0.75f,			//53
-		0.5f, 0.7071f, 0.5f,			0.5883875f, 0.75f,			//54
-		0.6533f, 0.7071f, 0.2706f,		0.63258125f, 0.75f,			//55
-		0.7071f, 0.7071f, 0.0f,			0.676775f, 0.75f,			//56
-		0.6533f, 0.7071f, -0.2706f,		0.72096875f, 0.75f,			//57
-		0.5f, 0.7071f, -0.5f,			0.7651625f, 0.75f,			//58
-		0.2706f, 0.7071f, -0.6533f,		0.80935625f, 0.75f,			//59
-		0.0f, 0.7071f, -0.7071f,		0.85355f, 0.75f,			//60 - seam
-		0.0f, 0.7071f, -0.7071f,		0.14645f, 0.75f,			//61 - seam
-		-0.2706f, 0.7071f, -0.6533f,	0.19064375f, 0.75f,			//62
-		-0.5f, 0.7071f, -0.5f,			0.2348375f, 0.75f,			//63
-		-0.6533f, 0.7071f, -0.2706f,	0.27903135f, 0.75f,			//64
-		-0.7071f, 0.7071f, 0.0f,		0.323225f, 0.75f,			//65
-		-0.6533f, 0.7071f, 0.2706f,		0.36741875f, 0.75f,			//66
-		-0.5f, 0.7071f, 0.5f,			0.4116125f, 0.75f,			//67
-		-0.2706f, 0.7071f, 0.6533f,		0.45580625f, 0.75f,			//68
-		// ring 5
-		0.0f, 0.5556f, 0.8315f,			0.5f, 0.6875f,				//69
-		0.3182f, 0.5556f, 0.7682f,		0.55196875f, 0.6875f,		//70
-		0.5879f, 0.5556f, 0.5879f,		0.6039375f, 0.6875f,		//71
-		0.7682f, 0.5556f, 0.3182f,		0.65590625f, 0.6875f,		//72
-		0.8315f, 0.5556f, 0.0f,			0.707875f, 0.6875f,			//73
-		0.7682f, 0.5556f, -0.3182f,		0.75984375f, 0.6875f,		//74
-		0.5879f, 0.5556f, -0.5879f,		0.8118125f, 0.6875f,		//75
-		0.3182f, 0.5556f, -0.7682f,		0.86378125f, 0.6875f,		//76
-		0.0f, 0.5556f, -0.8315f,		0.91575f, 0.6875f,			//77 - seam
-		0.0f, 0.5556f, -0.8315f,		0.08425f, 0.6875f,			//78 - seam
-		-0.3182f, 0.5556f, -0.7682f,	0.13621875f, 0.6875f,		//79
-		-0.5879f, 0.5556f, -0.5879f,	0.1881875f, 0.6875f,		//80
-		-0.7682f, 0.5556f, -0.3182f,	0.24015625f, 0.6875f,		//81
-		-0.8315f, 0.5556f, 0.0f,		0.292125f, 0.6875f,			//82
-		-0.7682f, 0.5556f, 0.3182f,		0.34409375f, 0.6875f,		//83
-		-0.5879f, 0.5556f, 0.5879f,		0.3960625f, 0.6875f,		//84
-		-0.3182f, 0.5556f, 0.7682f,		0.44803125f, 0.6875f,		//85
-		//ring 6
-		0.0f, 0.3827f, 0.9239f,			0.5f, 0.625f,				//86
-		0.3536f, 0.3827f, 0.8536f,		0.55774375f, 0.625f,		//87
-		0.6533f, 0.3827f, 0.6533f,		0.6154875f, 0.625f,			//88
-		0.8536f, 0.3827f, 0.3536f,		0.67323125f, 0.625f,		//89
-		0.9239f, 0.3827f, 0.0f,			0.730975f, 0.625f,			//90
-		0.8536f, 0.3827f, -0.3536f,		0.78871875f, 0.625f,		//91
-		0.6533f, 0.3827f, -0.6533f,		0.8464625f, 0.625f,			//92
-		0.3536f, 0.3827f, -0.8536f,		0.90420625f, 0.625f,		//93
-		0.0f, 0.3827f, -0.9239f,		0.96195f, 0.625f,			//94 - seam
-		0.0f, 0.3827f, -0.9239f,		0.03805f, 0.625f,			//95 - seam
-		-0.3536f, 0.3827f, -0.8536f,	0.09579375f, 0.625f,		//96
-		-0.6533f, 0.3827f, -0.6533f,	0.1535375f, 0.625f,			//97
-		-0.8536f, 0.3827f, -0.3536f,	0.21128125f, 0.625f,		//98
-		-0.9239f, 0.3827f, 0.0f,		0.269025f, 0.625f,			//99
-		-0.8536f, 0.3827f, 0.3536f,		0.32676875f, 0.625f,		//100
-		-0.6533f, 0.3827f, 0.6533f,		0.3845125f, 0.625f,			//101
-		-0.3536f, 0.3827f, 0.8536f,		0.44225625f, 0.625f,		//102
-		// ring 7
-		0.0f, 0.1951f, 0.9808f,			0.5f, 0.5625f,				//103
-		0.3753f, 0.1915f, 0.9061f,		0.5613f, 0.5625f,			//104
-		0.6935f, 0.1915f, 0.6935f,		0.6226f, 0.5625f,			//105
-		0.9061f, 0.1915f, 0.3753f,		0.6839f, 0.5625f,			//106
-		0.9808f, 0.1915f, 0.0f,			0.7452f, 0.5625f,			//107
-		0.9061f, 0.1915f, -0.3753f,		0.8065f, 0.5625f,			//108
-		0.6935f, 0.1915f, -0.6935f,		0.8678f, 0.5625f,			//109
-		0.3753f, 0.1915f, -0.9061f,		0.9291f, 0.5625f,			//110
-		0.0f, 0.1915f, -0.9808f,		0.9904f, 0.5625f,			//111 - seam
-		0.0f, 0.1915f, -0.9808f,		0.0096f, 0.5625f,			//112 - seam
-		-0.3753f, 0.1915f, -0.9061f,	0.0709f, 0.5625f,			//113
-		-0.6935f, 0.1915f, -0.6935f,	0.1322f, 0.5625f,			//114
-		-0.9061f, 0.1915f, -0.3753f,	0.1935f, 0.5625f,			//115
-		-0.9808f, 0.1915f, 0.0f,		0.2548f, 0.5625f,			//116
-		-0.9061f, 0.1915f, 0.3753f,		0.3161f, 0.5625f,			//117
-		-0.6935f, 0.1915f, 0.6935f,		0.3774f, 0.5625f,			//118
-		-0.3753f, 0.1915f, 0.9061f,		0.4387f, 0.5625f,			//119
-		// ring 8
-		0.0f, 0.0f, 1.0f,				0.5f, 0.5f,					//120
-		0.3827f, 0.0f, 0.9239f,			0.5625f, 0.5f,				//121
-		0.7071f, 0.0f, 0.7071f,			0.625f, 0.5f,				//122
-		0.9239f, 0.0f, 0.3827f,			0.6875f, 0.5f,				//123
-		1.0f, 0.0f, 0.0f,				0.75f, 0.5f,				//124
-		0.9239f, 0.0f, -0.3827f,		0.8125f, 0.5f,				//125
-		0.7071f, 0.0f, -0.7071f,		0.875f, 0.5f,				//126
-		0.3827f, 0.0f, -0.9239f,		0.9375f, 0.5f,				//127
-		0.0f, 0.0f, -1.0f,				1.0f, 0.5f,					//128 - seam
-		0.0f, 0.0f, -1.0f, 				0.0f, 0.5f,					//129 - seam
-		-0.3827f, 0.0f, -0.9239f,		0.0625f, 0.5f,				//130
-		-0.7071f, 0.0f, -0.7071f,		0.125f, 0.5f,				//131
-		-0.9239f, 0.0f, -0.3827f,		0.1875f, 0.5f,				//132
-		-1.0f, 0.0f, 0.0f,				0.25f, 0.5f,				//133
-		-0.9239f, 0.0f, 0.3827f,		0.3125f, 0.5f,				//134
-		-0.7071, 0.0, 0.7071f,			0.375f, 0.5f,				//135
-		-0.3827f, 0.0f, 0.9239f,		0.4375f, 0.5f,				//136
-		// ring 9
-		0.0f, -0.1915f, 0.9808f,		0.5f, 0.4375f,				//137
-		0.3753f, -0.1915f, 0.9061f,		0.5613f, 0.4375f,			//138
-		0.6935f, -0.1915f, 0.6935f,		0.6226f, 0.4375f,			//139
-		0.9061f, -0.1915f, 0.3753f,		0.6839f, 0.4375f,			//140
-		0.9808f, -0.1915f, 0.0f,		0.7452f, 0.4375f,			//141
-		0.9061f, -0.1915f, -0.3753f,	0.8065f, 0.4375f,			//142
-		0.6935f, -0.1915f, -0.6935f,	0.8678f, 0.4375f,			//143
-		0.3753f, -0.1915f, -0.9061f,	0.9261f, 0.4375f,			//144
-		0.0f, -0.1915f, -0.9808f,		0.9904f, 0.4375f,			//145 - seam
-		0.0f, -0.1915f, -0.9808f,		0.0096f, 0.4375f,			//146 - seam
-		-0.3753f, -0.1915f, -0.9061f,	0.0709f, 0.4375f,			//147
-		-0.6935f, -0.1915f, -0.6935f,	0.1322f, 0.4375f,			//148
-		-0.9061f, -0.1915f, -0.3753f,	0.1935f, 0.4375f,			//149
-		-0.9808f, -0.1915f, 0.0f,		0.2548f, 0.4375f,			//150
-		-0.9061f, -0.1915f, 0.3753f,	0.3161f, 0.4375f,			//151
-		-0.6935f, -0.1915f, 0.6935f,	0.3774f, 0.4375f,			//152
-		-0.3753f, -0.1915f, 0.9061f,	0.4387f, 0.4375f,			//153
-		// ring 10
-		0.0f, -0.3827f, 0.9239f,		0.5f, 0.375f,				//154
-		0.3536f, -0.3827f, 0.8536f,		0.55774375f, 0.375f,		//155
-		0.6533f, -0.3827f, 0.6533f,		0.6154875f, 0.375f,			//156
-		0.8536f, -0.3827f, 0.3536f,		0.67323125f, 0.375f,		//157
-		0.9239f, -0.3827f, 0.0f,		0.730975f, 0.375f,			//158
-		0.8536f, -0.3827f, -0.3536f,	0.78871875f, 0.375f,		//159
-		0.6533f, -0.3827f, -0.6533f,	0.8464625f, 0.375f,			//160
-		0.3536f, -0.3827f, -0.8536f,	0.90420625f, 0.375f,		//161
-		0.0f, -0.3827f, -0.9239f,		0.96195f, 0.375f,			//162 - seam
-		0.0f, -0.3827f, -0.9239f,		0.03805f, 0.375f,			//163 - seam
-		-0.3536f, -0.3827f, -0.8536f,	0.09579375f, 0.375f,		//164
-		-0.6533f, -0.3827f, -0.6533f,	0.1535375f, 0.375f,			//165
-		-0.8536f, -0.3827f, -0.3536f,	0.21128125f, 0.375f,		//166
-		-0.9239f, -0.3827f, 0.0f,		0.269025f, 0.375f,			//167
-		-0.8536f, -0.3827f, 0.3536f,	0.32676875f, 0.375f,		//168
-		-0.6533f, -0.3827f, 0.6533f,	0.3845125f, 0.375f,			//169
-		-0.3536f, -0.3827f, 0.8536f,	0.44225625f, 0.375f,		//170
-		// ring 11
-		0.0f, -0.5556f, 0.8315f,		0.5f, 0.3125f,				//171
-		0.3182f, -0.5556f, 0.7682f,		0.55196875f, 0.3125f,		//172
-		0.5879f, -0.5556f, 0.5879f,		0.6039375f, 0.3125f,		//173
-		0.7682f, -0.5556f, 0.3182f,		0.65590625f, 0.3125f,		//174
-		0.8315f, -0.5556f, 0.0f,		0.707875f, 0.3125f,			//175
-		0.7682f, -0.5556f, -0.3182f,	0.75984375f, 0.3125f,		//176
-		0.5879f, -0.5556f, -0.5879f,	0.8118125f, 0.3125f,		//177
-		0.3182f, -0.5556f, -0.7682f,	0.86378125f, 0.3125f,		//178
-		0.0f, -0.5556f, -0.8315f,		0.91575f, 0.3125f,			//179 - seam
-		0.0f, -0.5556f, -0.8315f,		0.08425f, 0.3125f,			//180 - seam
-		-0.3182f, -0.5556f, -0.7682f,	0.13621875f, 0.3125f,		//181
-		-0.5879f, 0.5556f, -0.5879f,	0.1881875f, 0.3125f,		//182
-		-0.7682f, -0.5556f, -0.3182f,	0.24015625f, 0.3125f,		//183
-		-0.8315f, -0.5556f, 0.0f,		0.292125f, 0.3125f,			//184
-		-0.7682f, -0.5556f, 0.3182f,	0.34409375f, 0.3125f,		//185
-		-0.5879f, -0.5556f, 0.5879f,	0.3960625f, 0.3125f,		//186
-		-0.3182f, -0.5556f, 0.7682f,	0.44803125f, 0.3125f,		//187
-		// ring 12
-		0.0f, -0.7071f, 0.7071f,		0.5f, 0.25f,				//188
-		0.2706f, -0.7071f, 0.6533f,		0.54419375f, 0.25f,			//189
-		0.5f, -0.7071f, 0.5f,			0.5883875f, 0.25f,			//190
-		0.6533f, -0.7071f, 0.2706f,		0.63258125f, 0.25f,			//191
-		0.7071f, -0.7071f, 0.0f,		0.676775f, 0.25f,			//192
-		0.6533f, -0.7071f, -0.2706f,	0.72096875f, 0.25f,			//193
-		0.5f, -0.7071f, -0.5f,			0.7651625f, 0.25f,			//194
-		0.2706f, -0.7071f, -0.6533f,	0.80935625f, 0.25f,			//195
-		0.0f, -0.7071f, -0.7071f,		0.85355f, 0.25f,			//196 - seam
-		0.0f, -0.7071f, -0.7071f,		0.14645f, 0.25f,			//197 - seam
-		-0.2706f, -0.7071f, -0.6533f,	0.19064375f, 0.25f,			//198
-		-0.5f, -0.7071f, -0.5f,			0.2348375f, 0.25f,			//199
-		-0.6533f, -0.7071f, -0.2706f,	0.27903135f, 0.25f,			//200
-		-0.7071f, -0.7071f, 0.0f,		0.323225f, 0.25f,			//201
-		-0.6533f, -0.7071f, 0.2706f,	0.36741875f, 0.25f,			//202
-		-0.5f, -0.7071f, 0.5f,			0.4116125f, 0.25f,			//203
-		-0.2706f, -0.7071f, 0.6533f,	0.45580625f, 0.25f,			//204
-		// ring 13
-		0.0f, -0.8315f, 0.5556f,		0.5f, 0.1875f,				//205
-		0.2126f, -0.8315f, 0.5133f,		0.534725f, 0.1875f,			//206
-		0.3928f, -0.8315f, 0.3928f,		0.56945f, 0.1875f,			//207
-		0.5133f, -0.8315f, 0.2126f,		0.604175f, 0.1875f,			//208
-		0.5556f, -0.8315f, 0.0f,		0.6389f, 0.1875f,			//209
-		0.5133f, -0.8315f, -0.2126f,	0.673625f, 0.1875f,			//210
-		0.3928f, -0.8315f, -0.3928f,	0.70835f, 0.1875f,			//211
-		0.2126f, -0.8315f, -0.5133f,	0.743075f, 0.1875f,			//212
-		0.0f, -0.8315f, -0.5556f,		0.7778f, 0.1875f,			//213 - seam
-		0.0f, -0.8315f, -0.5556f,		0.2222f, 0.1875f,			//214 - seam
-		-0.2126f, -0.8315f, -0.5133f,	0.256925f, 0.1875f,			//215
-		-0.3928f, -0.8315f, -0.3928f,	0.29165f, 0.1875f,			//216
-		-0.5133f, -0.8315f, -0.2126f,	0.326375f, 0.1875f,			//217
-		-0.5556f, -0.8315f, 0.0f,		0.3611f, 0.1875f,			//218
-		-0.5133f, -0.8315f, 0.2126f,	0.395825f, 0.1875f,			//219
-		-0.3928f, -0.8315f, 0.3928f,	0.43055f, 0.1875f,			//220
-		-0.2126f, -0.8315f, 0.5133f,	0.465275f, 0.1875f,			//221
-		// ring 14
-		0.0f, -0.9239f, 0.3827f,		0.5f, 0.125f,				//222
-		0.1464f, -0.9239f, 0.3536f,		0.52391875f, 0.125f,		//223
-		0.2706f, -0.9239f, 0.2706f,		0.5478375f, 0.125f,			//224
-		0.3536f, -0.9239f, 0.1464f,		0.57175625f, 0.125f,		//225
-		0.3827f, -0.9239f, 0.0f,		0.5956755f, 0.125f,			//226
-		0.3536f, -0.9239f, -0.1464f,	0.61959425f, 0.125f,		//227
-		0.2706f, -0.9239f, -0.2706f,	0.643513f, 0.125f,			//228
-		0.1464f, -0.9239f, -0.3536f,	0.66743175f, 0.125f,		//229
-		0.0f, -0.9239f, -0.3827f,		0.6913505f, 0.125f,			//230 - seam
-		0.0f, -0.9239f, -0.3827f,		0.3086495f, 0.125f,			//231 - seam
-		-0.1464f, -0.9239f, -0.3536f,	0.33256825f, 0.125f,		//232
-		-0.2706f, -0.9239f, -0.2706f,	0.356487f, 0.125f,			//233
-		-0.3536f, -0.9239f, -0.1464f,	0.38040575f, 0.125f,		//234
-		-0.3827f, -0.9239f, 0.0f,		0.4043245f, 0.125f,			//235
-		-0.3536f, -0.9239f, 0.1464f,	0.42824325f, 0.125f,		//236
-		-0.2706f, -0.9239f, 0.2706f,	0.452162f, 0.125f,			//237
-		-0.1464f, -0.9239f, 0.3536f,	0.47608075f, 0.125f,		//238
-		// ring 15
-		0.0f, -0.9808f, 0.1951f,		0.5f, 0.0625f,				//239
-		0.0747f, -0.9808f, 0.1802f,		0.51219375f, 0.0625f,		//240
-		0.1379f, -0.9808f, 0.1379f,		0.5243875f, 0.0625f,		//241
-		0.1802f, -0.9808f, 0.0747f,		0.53658125f, 0.0625f,		//242
-		0.1951f, -0.9808, 0.0f,			0.548775f, 0.0625f,			//243
-		0.1802f, -0.9808f, -0.0747f,	0.56096875f, 0.0625f,		//244
-		0.1379f, -0.9808f, -0.1379f,	0.5731625f, 0.0625f,		//245
-		0.0747f, -0.9808f, -0.1802f,	0.58535625f, 0.0625f,		//246
-		0.0f, -0.9808f, -0.1951f,		0.59755f, 0.0625f,			//247 - seam
-		0.0f, -0.9808f, -0.1951f,		0.40245f, 0.0625f,			//248 - seam
-		-0.0747f, -0.9808f, -0.1802f,	0.41464375f, 0.0625f,		//249
-		-0.1379f, -0.9808f, -0.1379f,	0.4268375f, 0.0625f,		//250
-		-0.1802f, -0.9808f, -0.0747f,	0.43903125f, 0.0625f,		//251
-		-0.1951f, -0.9808, 0.0f,		0.451225f, 0.0625f,			//252
-		-0.1802f, -0.9808f, 0.0747f,	0.46341875f, 0.0625f,		//253
-		-0.1379f, -0.9808f, 0.1379f,	0.4756125f, 0.0625f,		//254
-		-0.0747f, -0.9808f, 0.1802f,	0.48780625f, 0.0625f,		//255
-		// bottom center point
-		0.0f, -1.0f, 0.0f,				0.5f, 0.0f					//256
-	};
-
-	// index data
-	GLuint indices[] = {
-		//ring 1 - top
-		0,10,11,
-		0,11,12,
-		0,12,13,
-		0,13,14,
-		0,14,15,
-		0,15,16,
-		0,16,17,
-		0,17,1,
-		0,1,2,
-		0,2,3,
-		0,3,4,
-		0,4,5,
-		0,5,6,
-		0,6,7,
-		0,7,8,
-		0,8,9,
-		0,9,10,
-
-		// ring 1 to ring 2
-		10,27,28,
-		10,11,28,
-		11,28,29,
-		11,12,29,
-		12,29,30,
-		12,13,30,
-		13,30,31,
-		13,14,31,
-		14,31,32,
-		14,15,32,
-		15,32,33,
-		15,16,33,
-		16,33,34,
-		16,17,34,
-		17,34,18,
-		17,1,18,
-		1,18,19,
-		1,2,19,
-		2,19,20,
-		2,3,20,
-		3,20,21,
-		3,4,21,
-		4,21,22,
-		4,5,22,
-		5,22,23,
-		5,6,23,
-		6,23,24,
-		6,7,24,
-		7,24,25,
-		7,8,25,
-		8,25,26,
-		8,9,26,
-		9,26,27,
-		9,10,27,
-
-		// ring 2 to ring 3
-		27,44,45,
-		27,28,45,
-		28,45,46,
-		28,29,46,
-		29,46,47,
-		29,30,47,
-		30,47,48,
-		30,31,48,
-		31,48,49,
-		31,32,49,
-		32,49,50,
-		32,33,50,
-		33,50,51,
-		33,34,51,
-		34,51,35,
-		34,18,35,
-		18,35,36,
-		18,19,36,
-		19,36,37,
-		19,20,37,
-		20,37,38,
-		20,21,38,
-		21,38,39,
-		21,22,39,
-		22,39,40,
-		22,23,40,
-		23,40,41,
-		23,24,41,
-		24,41,42,
-		24,25,42,
-		25,42,43,
-		25,26,43,
-		26,43,44,
-		26,27,44,
-
-		// ring 3 to ring 4
-		44,61,62,
-		44,45,62,
-		45,62,63,
-		45,46,63,
-		46,63,64,
-		46,47,64,
-		47,64,65,
-		47,48,65,
-		48,65,66,
-		48,49,66,
-		49,66,67,
-		49,50,67,
-		50,67,68,
-		50,51,68,
-		51,68,52,
-		51,35,52,
-		35,52,53,
-		35,36,53,
-		36,53,54,
-		36,37,54,
-		37,54,55,
-		37,38,55,
-		38,55,56,
-		38,39,56,
-		39,56,57,
-		39,40,57,
-		40,57,58,
-		40,41,58,
-		41,58,59,
-		41,42,59,
-		42,59,60,
-		42,43,60,
-		43,60,61,
-		43,44,61,
-
-		// ring 4 to ring 5
-		61,78,79,
-		61,62,79,
-		62,79,80,
-		62,63,80,
-		63,80,81,
-		63,64,81,
-		64,81,82,
-		64,65,82,
-		65,82,83,
-		65,66,83,
-		66,83,84,
-		66,67,84,
-		67,84,85,
-		67,68,85,
-		68,85,69,
-		68,52,69,
-		52,69,70,
-		52,53,70,
-		53,70,71,
-		53,54,71,
-		54,71,72,
-		54,55,72,
-		55,72,73,
-		55,56,73,
-		56,73,74,
-		56,57,74,
-		57,74,75,
-		57,58,75,
-		58,75,76,
-		58,59,76,
-		59,76,77,
-		59,60,77,
-		60,77,78,
-		60,61,78,
-
-		// ring 5 to ring 6
-		78,95,96,
-		78,79,96,
-		79,96,97,
-		79,80,97,
-		80,97,98,
-		80,81,98,
-		81,98,99,
-		81,82,99,
-		82,99,100,
-		82,83,100,
-		83,100,101,
-		83,84,101,
-		84,101,102,
-		84,85,102,
-		85,102,86,
-		85,69,86,
-		69,86,87,
-		69,70,87,
-		70,87,88,
-		70,71,88,
-		71,88,89,
-		71,72,89,
-		72,89,90,
-		72,73,90,
-		73,90,91,
-		73,74,91,
-		74,91,92,
-		74,75,92,
-		75,92,93,
-		75,76,93,
-		76,93,94,
-		76,77,94,
-		77,94,95,
-		77,78,95,
-
-		// ring 6 to ring 7
-		95,112,113,
-		95,96,113,
-		96,113,114,
-		96,97,114,
-		97,114,115,
-		97,98,115,
-		98,115,116,
-		98,99,116,
-		99,116,117,
-		99,100,117,
-		100,117,118,
-		100,101,118,
-		101,118,119,
-		101,102,119,
-		102,119,103,
-		102,86,103,
-		86,103,104,
-		86,87,104,
-		87,104,105,
-		87,88,105,
-		88,105,106,
-		88,89,106,
-		89,106,107,
-		89,90,107,
-		90,107,108,
-		90,91,108,
-		91,108,109,
-		91,92,109,
-		92,109,110,
-		92,93,110,
-		93,110,111,
-		93,94,111,
-		94,111,112,
-		94,95,112,
-
-		// ring 7 to ring 8
-		112,129,130,
-		112,113,130,
-		113,130,131,
-		113,114,131,
-		114,131,132,
-		114,115,132,
-		115,132,133,
-		115,116,133,
-		116,133,134,
-		116,117,134,
-		117,134,135,
-		117,118,135,
-		118,135,136,
-		118,119,136,
-		119,136,120,
-		119,103,120,
-		103,120,121,
-		103,104,121,
-		104,121,122,
-		104,105,122,
-		105,122,123,
-		105,106,123,
-		106,123,124,
-		106,107,124,
-		107,124,125,
-		107,108,125,
-		108,125,126,
-		108,109,126,
-		109,126,127,
-		109,110,127,
-		110,127,128,
-		110,111,128,
-		111,128,129,
-		111,112,129,
-
-		// ring 8 to ring 9
-		129,146,147,
-		129,130,147,
-		130,147,148,
-		130,131,148,
-		131,148,149,
-		131,132,149,
-		132,149,150,
-		132,133,150,
-		133,150,151,
-		133,134,151,
-		134,151,152,
-		134,135,152,
-		135,152,153,
-		135,136,153,
-		136,153,137,
-		136,120,137,
-		120,137,138,
-		120,121,138,
-		121,138,139,
-		121,122,139,
-		122,139,140,
-		122,123,140,
-		123,140,141,
-		123,124,141,
-		124,141,142,
-		124,125,142,
-		125,142,143,
-		125,126,143,
-		126,143,144,
-		126,127,144,
-		127,144,145,
-		127,128,145,
-		128,145,146,
-		128,129,146,
-
-		// ring 9 to ring 10
-		146,163,164,
-		146,147,164,
-		147,164,165,
-		147,148,165,
-		148,165,166,
-		148,149,166,
-		149,166,167,
-		149,150,167,
-		150,167,168,
-		150,151,168,
-		151,168,169,
-		151,152,169,
-		152,169,170,
-		152,153,170,
-		153,170,154,
-		153,137,154,
-		137,154,155,
-		137,138,155,
-		138,155,156,
-		138,139,156,
-		139,156,157,
-		139,140,157,
-		140,157,158,
-		140,141,158,
-		141,158,159,
-		141,142,159,
-		142,159,160,
-		142,143,160,
-		143,160,161,
-		143,144,161,
-		144,161,162,
-		144,145,162,
-		145,162,163,
-		145,146,163,
-
-		// ring 10 to ring 11
-		163,180,181,
-		163,164,181,
-		164,181,182,
-		164,165,182,
-		165,182,183,
-		165,166,183,
-		166,183,184,
-		166,167,184,
-		167,184,185,
-		167,168,185,
-		168,185,186,
-		168,169,186,
-		169,186,187,
-		169,170,187,
-		170,187,171,
-		170,154,171,
-		154,171,172,
-		154,155,172,
-		155,172,173,
-		155,156,173,
-		156,173,174,
-		156,157,174,
-		157,174,175,
-		157,158,175,
-		158,175,176,
-		158,159,176,
-		159,176,177,
-		159,160,177,
-		160,177,178,
-		160,161,178,
-		161,178,179,
-		161,162,179,
-		162,179,180,
-		162,163,180,
-
-		// ring 11 to ring 12
-		180,197,198,
-		180,181,198,
-		181,198,199,
-		181,182,199,
-		182,199,200,
-		182,183,200,
-		183,200,201,
-		183,184,201,
-		184,201,202,
-		184,185,202,
-		185,202,203,
-		185,186,203,
-		186,203,204,
-		186,187,204,
-		187,204,188,
-		187,171,188,
-		171,188,189,
-		171,172,189,
-		172,189,190,
-		172,173,190,
-		173,190,191,
-		173,174,191,
-		174,191,192,
-		174,175,192,
-		175,192,193,
-		175,176,193,
-		176,193,194,
-		176,177,194,
-		177,194,195,
-		177,178,195,
-		178,195,196,
-		178,179,196,
-		179,196,197,
-		179,180,197,
-
-		// ring 12 to ring 13
-		197,214,215,
-		197,198,215,
-		198,215,216,
-		198,199,216,
-		199,216,217,
-		199,200,217,
-		200,217,218,
-		200,201,218,
-		201,218,219,
-		201,202,219,
-		202,219,220,
-		202,203,220,
-		203,220,221,
-		203,204,221,
-		204,221,205,
-		204,188,205,
-		188,205,206,
-		188,189,206,
-		189,206,207,
-		189,190,207,
-		190,207,208,
-		190,191,208,
-		191,208,209,
-		191,192,209,
-		192,209,210,
-		192,193,210,
-		193,210,211,
-		193,194,211,
-		194,211,212,
-		194,195,212,
-		195,212,213,
-		195,196,213,
-		196,213,214,
-		196,197,214,
-
-		// ring 13 to ring 14
-		214,231,232,
-		214,215,232,
-		215,232,233,
-		215,216,233,
-		216,233,234,
-		216,217,234,
-		217,234,235,
-		217,218,235,
-		218,235,236,
-		218,219,236,
-		219,236,237,
-		219,220,237,
-		220,237,238,
-		220,221,238,
-		221,238,222,
-		221,205,222,
-		205,222,223,
-		205,206,223,
-		206,223,224,
-		206,207,224,
-		207,224,225,
-		207,208,225,
-		208,225,226,
-		208,209,226,
-		209,226,227,
-		209,210,227,
-		210,227,228,
-		210,211,228,
-		211,228,229,
-		211,212,229,
-		212,229,230,
-		212,213,230,
-		213,230,231,
-		213,214,231,
-
-		// ring 14 to ring 15
-		231,248,249,
-		231,232,249,
-		232,249,250,
-		232,233,250,
-		233,250,251,
-		233,234,251,
-		234,251,252,
-		234,235,252,
-		235,252,253,
-		235,236,253,
-		236,253,254,
-		236,237,254,
-		237,254,255,
-		237,238,255,
-		238,255,239,
-		238,222,239,
-		222,239,240,
-		222,223,240,
-		223,240,241,
-		223,224,241,
-		224,241,242,
-		224,225,242,
-		225,242,243,
-		225,226,243,
-		226,243,244,
-		226,227,244,
-		227,244,245,
-		227,228,245,
-		228,245,246,
-		228,229,246,
-		229,246,247,
-		229,230,247,
-		230,247,248,
-		230,231,248,
-
-		// ring 15 - bottom
-		248,256,249,
-		249,256,250,
-		250,256,251,
-		251,256,252,
-		252,256,253,
-		253,256,254,
-		254,256,255,
-		255,256,239,
-		239,256,240,
-		240,256,241,
-		241,256,242,
-		242,256,243,
-		243,256,244,
-		244,256,245,
-		245,256,246,
-		246,256,247,
-		247,256,248
-	};
-
-	// total float values per each type
-	const GLuint floatsPerVertex = 3;
-	const GLuint floatsPerNormal = 3;
-	const GLuint floatsPerUV = 2;
-
-	// store vertex and index count
-	m_SphereMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (floatsPerVertex));
-	m_SphereMesh.nIndices = sizeof(indices) / (sizeof(indices[0]));
-
-	glm::vec3 normal;
-	glm::vec3 vert;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	float u, v;
-	std::vector<GLfloat> combined_values;
-
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < sizeof(verts) / (sizeof(verts[0])); i += 5)
-	{
-		vert = glm::vec3(verts[i], verts[i + 1], verts[i + 2]);
-		normal = normalize(vert - center);
-		//u = atan2(normal.x, normal.z) / (2 * M_PI) + 0.5;
-		//v = normal.y * 0.5 + 0.5;
-		combined_values.push_back(vert.x);
-		combined_values.push_back(vert.y);
-		combined_values.push_back(vert.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(verts[i + 3]);
-		combined_values.push_back(verts[i + 4]);
-	}
-
-	// Create VAO
-	glGenVertexArrays(1, &m_SphereMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_SphereMesh.vao);
-
-	// Create VBOs
-	glGenBuffers(2, m_SphereMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_SphereMesh.vbos[0]); // Activates the vertex buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_SphereMesh.vbos[1]); // Activates the index buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	LoadMeshLODs(m_SphereMesh, SHAPE_SPHERE, slices, stacks, 0.0f, "Sphere");
 }
 
 ///////////////////////////////////////////////////
 //	LoadTaperedCylinderMesh()
 //
-//	Create a tapered cylinder mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
-//  and texture coordinates are also set.
+//	Generate a tapered cylinder mesh with the passed in
+//  number of segments and store it in a VAO/VBO.  The
+//  normals and texture coordinates are also set.
 //
 //  Correct triangle drawing commands:
 //
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_FAN, 36, 72);		//top
-//	glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+//	glDrawElements(GL_TRIANGLES, bottom.indexCount, GL_UNSIGNED_INT, bottom.firstIndex);	//bottom
+//	glDrawElements(GL_TRIANGLES, top.indexCount, GL_UNSIGNED_INT, top.firstIndex);			//top
+//	glDrawElements(GL_TRIANGLES, sides.indexCount, GL_UNSIGNED_INT, sides.firstIndex);		//sides
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadTaperedCylinderMesh()
+void ShapeMeshes::LoadTaperedCylinderMesh(GLuint segments)
 {
-	GLfloat verts[] = {
-		// cylinder bottom		// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder top			// normals			// texture coords
-		0.5f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f,1.0f,
-		.49f, 1.0f, -0.085f,	0.0f, 1.0f, 0.0f,	0.41f, 0.983f,
-		.47f, 1.0f, -0.17f,		0.0f, 1.0f, 0.0f,	0.33f, 0.96f,
-		.435f, 1.0f, -0.25f,	0.0f, 1.0f, 0.0f,	0.25f, 0.92f,
-		.385f, 1.0f, -0.32f,	0.0f, 1.0f, 0.0f,	0.17f, 0.87f,
-		.32f, 1.0f, -0.385f,	0.0f, 1.0f, 0.0f,	0.13f, 0.83f,
-		.25f, 1.0f, -0.435f,	0.0f, 1.0f, 0.0f,	0.08f, 0.77f,
-		.17f, 1.0f, -0.47f,		0.0f, 1.0f, 0.0f,	0.04f, 0.68f,
-		.085f, 1.0f, -0.49f,	0.0f, 1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.0f,0.5f,
-		-.085f, 1.0f, -0.49f,	0.0f, 1.0f, 0.0f,	0.017f, 0.41f,
-		-.17f, 1.0f, -0.47f,	0.0f, 1.0f, 0.0f,	0.04f, 0.33f,
-		-.25f, 1.0f, -0.435f,	0.0f, 1.0f, 0.0f,	0.08f, 0.25f,
-		-.32f, 1.0f, -0.385f,	0.0f, 1.0f, 0.0f,	0.13f, 0.17f,
-		-.385f, 1.0f, -0.32f,	0.0f, 1.0f, 0.0f,	0.17f, 0.13f,
-		-.435f, 1.0f, -0.25f,	0.0f, 1.0f, 0.0f,	0.25f, 0.08f,
-		-.47f, 1.0f, -0.17f,	0.0f, 1.0f, 0.0f,	0.33f, 0.04f,
-		-.49f, 1.0f, -0.085f,	0.0f, 1.0f, 0.0f,	0.41f, 0.017f,
-		-0.5f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f, 0.0f,
-		-.49f, 1.0f, 0.085f,	0.0f, 1.0f, 0.0f,	0.6f, 0.017f,
-		-.47f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.68f, 0.04f,
-		-.435f, 1.0f, 0.25f,	0.0f, 1.0f, 0.0f,	0.77f, 0.08f,
-		-.385f, 1.0f, 0.32f,	0.0f, 1.0f, 0.0f,	0.83f, 0.13f,
-		-.32f, 1.0f, 0.385f,	0.0f, 1.0f, 0.0f,	0.87f, 0.17f,
-		-.25f, 1.0f, 0.435f,	0.0f, 1.0f, 0.0f,	0.92f, 0.25f,
-		-.17f, 1.0f, 0.47f,		0.0f, 1.0f, 0.0f,	0.96f, 0.33f,
-		-.085f, 1.0f, 0.49f,	0.0f, 1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	1.0f, 0.5f,
-		.085f, 1.0f, 0.49f,		0.0f, 1.0f, 0.0f,	0.983f, 0.6f,
-		.17f, 1.0f, 0.47f,		0.0f, 1.0f, 0.0f,	0.96f, 0.68f,
-		.25f, 1.0f, 0.435f,		0.0f, 1.0f, 0.0f,	0.92f, 0.77f,
-		.32f, 1.0f, 0.385f,		0.0f, 1.0f, 0.0f,	0.87f, 0.83f,
-		.385f, 1.0f, 0.32f,		0.0f, 1.0f, 0.0f,	0.83f, 0.87f,
-		.435f, 1.0f, 0.25f,		0.0f, 1.0f, 0.0f,	0.77f, 0.92f,
-		.47f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.68f, 0.96f,
-		.49f, 1.0f, 0.085f,		0.0f, 1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder body		// normals							// texture coords
-		0.5f, 1.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f,	0.25,1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f,	0.0,0.0,
-		.98f, 0.0f, -0.17f,		0.993150651, 0.5f, -0.116841137f,	0.0277,0.0,
-		0.5f, 1.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f, 	0.25,1.0,
-		.49f, 1.0f, -0.085f,	0.993150651, 0.5f, -0.116841137f, 	0.2635,1.0,
-		.98f, 0.0f, -0.17f,		0.993150651, 0.5f, -0.116841137f,	0.0277,0.0,
-		.94f, 0.0f, -0.34f,		0.993417103f, 0.5f, -0.229039446f,	0.0554,0.0,
-		.49f, 1.0f, -0.085f,	0.993417103f, 0.5f, -0.229039446f,	0.2635,1.0,
-		.47f, 1.0f, -0.17f,		0.993417103f, 0.5f, -0.229039446f,	0.277,1.0,
-		.94f, 0.0f, -0.34f,		0.993417103f, 0.5f, -0.229039446f,	0.0554,0.0,
-		.87f, 0.0f, -0.5f,		0.993417103f, 0.5f, -0.229039446f,	0.0831,0.0,
-		.47f, 1.0f, -0.17f,		0.993417103f, 0.5f, -0.229039446f,	0.277,1.0,
-		.435f, 1.0f, -0.25f,	0.813733339f, 0.5f, -0.581238329f,	0.2905,1.0,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.5f, -0.581238329f,	0.0831,0.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.5f, -0.581238329f,	0.1108,0.0,
-		.435f, 1.0f, -0.25f,	0.813733339f, 0.5f, -0.581238329f,	0.2905,1.0,
-		.385f, 1.0f, -0.32f,	0.813733339f, 0.5f, -0.581238329f,	0.304,1.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.5f, -0.581238329f,	0.1108,0.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.5f, -0.707106769f,	0.1385,0.0,
-		.385f, 1.0f, -0.32f,	0.707106769f, 0.5f, -0.707106769f,	0.304,1.0,
-		.32f, 1.0f, -0.385f,	0.707106769f, 0.5f, -0.707106769f,	0.3175,1.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.5f, -0.707106769f,	0.1385,0.0,
-		.5f, 0.0f, -0.87f,		0.707106769f, 0.5f, -0.707106769f,	0.1662,0.0,
-		.32f, 1.0f, -0.385f,	0.707106769f, 0.5f, -0.707106769f,	0.3175, 1.0,
-		.25f, 1.0f, -0.435f,	0.400818795f, 0.5f, -0.916157305f,	0.331, 1.0,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.5f, -0.916157305f,	0.1662, 0.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.5f, -0.916157305f,	0.1939, 0.0,
-		.25f, 1.0f, -0.435f,	0.400818795f, 0.5f, -0.916157305f,	0.331, 1.0,
-		.17f, 1.0f, -0.47f,		0.400818795f, 0.5f, -0.916157305f,	0.3445, 1.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.5f, -0.916157305f,	0.1939, 0.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.5f, -0.973417103f,	0.2216, 0.0,
-		.17f, 1.0f, -0.47f,		0.229039446f, 0.5f, -0.973417103f,	0.3445, 1.0,
-		.085f, 1.0f, -0.49f,	0.229039446f, 0.5f, -0.973417103f,	0.358, 1.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.5f, -0.973417103f,	0.2216, 0.0,
-		0.0f, 0.0f, -1.0f,		0.229039446f, 0.5f, -0.973417103f,	0.2493, 0.0,
-		.085f, 1.0f, -0.49f,	0.229039446f, 0.5f, -0.973417103f,	0.358, 1.0,
-		0.0f, 1.0f, -0.5f,		-0.116841137f, 0.5f, -0.993150651f,	0.3715, 1.0,
-		0.0f, 0.0f, -1.0f,		-0.116841137f, 0.5f, -0.993150651f,	0.2493, 0.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.5f, -0.993150651f,	0.277, 0.0,
-		0.0f, 1.0f, -0.5f,		-0.116841137f, 0.5f, -0.993150651f,	0.3715, 1.0,
-		-.085f, 1.0f, -0.49f,	-0.116841137f, 0.5f, -0.993150651f,	0.385, 1.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.5f, -0.993150651f,	0.277, 0.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.5f, -0.973417103f,	0.3047, 0.0,
-		-.085f, 1.0f, -0.49f,	-0.229039446f, 0.5f, -0.973417103f,	0.385, 1.0,
-		-.17f, 1.0f, -0.47f,	-0.229039446f, 0.5f, -0.973417103f,	0.3985, 1.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.5f, -0.973417103f,	0.3047, 0.0,
-		-.5f, 0.0f, -0.87f,		-0.229039446f, 0.5f, -0.973417103f,	0.3324, 0.0,
-		-.17f, 1.0f, -0.47f,	-0.229039446f, 0.5f, -0.973417103f,	0.3985, 1.0,
-		-.25f, 1.0f, -0.435f,	-0.581238329f, 0.5f, -0.581238329f,	0.412, 1.0,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.5f, -0.581238329f,	0.3324, 0.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.5f, -0.581238329f,	0.3601, 0.0,
-		-.25f, 1.0f, -0.435f,	-0.581238329f, 0.5f, -0.581238329f,	0.412, 1.0,
-		-.32f, 1.0f, -0.385f,	-0.581238329f, 0.5f, -0.581238329f,	0.4255, 1.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.5f, -0.581238329f,	0.3601, 0.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.5f, -0.707106769f,	0.3878, 0.0,
-		-.32f, 1.0f, -0.385f,	-0.707106769f, 0.5f, -0.707106769f,	0.4255, 1.0,
-		-.385f, 1.0f, -0.32f,	-0.707106769f, 0.5f, -0.707106769f,	0.439, 1.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.5f, -0.707106769f,	0.3878, 0.0,
-		-.87f, 0.0f, -0.5f,		-0.707106769f, 0.5f, -0.707106769f,	0.4155, 0.0,
-		-.385f, 1.0f, -0.32f,	-0.707106769f, 0.5f, -0.707106769f,	0.439, 1.0,
-		-.435f, 1.0f, -0.25f,	-0.916157305f, 0.5f, -0.400818795f,	0.4525, 1.0,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.5f, -0.400818795f,	0.4155, 0.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.5f, -0.400818795f,	0.4432, 0.0,
-		-.435f, 1.0f, -0.25f,	-0.916157305f, 0.5f, -0.400818795f,	0.4525, 1.0,
-		-.47f, 1.0f, -0.17f,	-0.916157305f, 0.5f, -0.400818795f,	0.466, 1.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.5f, -0.400818795f,	0.4432, 0.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.4709, 0.0,
-		-.47f, 1.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.466, 1.0,
-		-.49f, 1.0f, -0.085f,	-0.973417103f, 0.5f, -0.229039446f,	0.4795, 1.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.4709, 0.0,
-		-1.0f, 0.0f, 0.0f,		-0.973417103f, 0.5f, -0.229039446f,	0.4986, 0.0,
-		-.49f, 1.0f, -0.085f,	-0.973417103f, 0.5f, -0.229039446f,	0.4795, 1.0,
-		-0.5f, 1.0f, 0.0f,		-0.993150651f, 0.5f, -0.116841137f,	0.493, 1.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.5f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.5f, 0.116841137f,	0.5263, 0.0,
-		-0.5f, 1.0f, 0.0f,		-0.993150651f, 0.5f, 0.116841137f,	0.493, 1.0,
-		-.49f, 1.0f, 0.085f,	-0.993150651f, 0.5f, 0.116841137f,	0.5065, 1.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.5f, 0.116841137f,	0.5263, 0.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.5f, 0.229039446f,	0.554, 0.0,
-		-.49f, 1.0f, 0.085f,	-0.973417103f, 0.5f, 0.229039446f,	0.5065, 1.0,
-		-.47f, 1.0f, 0.17f,		-0.973417103f, 0.5f, 0.229039446f,	0.52, 1.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.5f, 0.229039446f,	0.554, 0.0,
-		-.87f, 0.0f, 0.5f,		-0.973417103f, 0.5f, 0.229039446f,	0.5817, 0.0,
-		-.47f, 1.0f, 0.17f,		-0.973417103f, 0.5f, 0.229039446f,	0.52, 1.0,
-		-.435f, 1.0f, 0.25f,	-0.813733339f, 0.5f, 0.581238329f,	0.5335, 1.0,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.5f, 0.581238329f,	0.5817, 0.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.5f, 0.581238329f,	0.6094, 0.0,
-		-.435f, 1.0f, 0.25f,	-0.813733339f, 0.5f, 0.581238329f,	0.5335, 1.0,
-		-.385f, 1.0f, 0.32f,	-0.813733339f, 0.5f, 0.581238329f,	0.547, 1.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.5f, 0.581238329f,	0.6094, 0.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.5f, 0.707106769f,	0.6371, 0.0,
-		-.385f, 1.0f, 0.32f,	-0.707106769f, 0.5f, 0.707106769f,	0.547, 1.0,
-		-.32f, 1.0f, 0.385f,	-0.707106769f, 0.5f, 0.707106769f,	0.5605, 1.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.5f, 0.707106769f,	0.6371, 0.0,
-		-.5f, 0.0f, 0.87f,		-0.707106769f, 0.5f, 0.707106769f,	0.6648, 0.0,
-		-.32f, 1.0f, 0.385f,	-0.707106769f, 0.5f, 0.707106769f,	0.5605, 1.0,
-		-.25f, 1.0f, 0.435f,	-0.400818795f, 0.5f, 0.916157305f,	0.574, 1.0,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.5f, 0.916157305f,	0.6648, 0.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.5f, 0.916157305f,	0.6925, 0.0,
-		-.25f, 1.0f, 0.435f,	-0.400818795f, 0.5f, 0.916157305f,	0.574, 1.0,
-		-.17f, 1.0f, 0.47f,		-0.400818795f, 0.5f, 0.916157305f,	0.5875, 1.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.5f, 0.916157305f,	0.6925, 0.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.5f, 0.973417103f,	0.7202, 0.0,
-		-.17f, 1.0f, 0.47f,		-0.229039446f, 0.5f, 0.973417103f,	0.5875, 1.0,
-		-.085f, 1.0f, 0.49f,	-0.229039446f, 0.5f, 0.973417103f,	0.601, 1.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.5f, 0.973417103f,	0.7202, 0.0,
-		0.0f, 0.0f, 1.0f,		-0.229039446f, 0.5f, 0.973417103f,	0.7479, 0.0,
-		-.085f, 1.0f, 0.49f,	-0.229039446f, 0.5f, 0.973417103f,	0.601, 1.0,
-		0.0f, 1.0f, 0.5f,		-0.116841137f, 0.5f, 0.993150651f,	0.6145, 1.0,
-		0.0f, 0.0f, 1.0f,		-0.116841137f, 0.5f, 0.993150651f,	0.7479, 0.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.5f, 0.993150651f,	0.7756, 0.0,
-		0.0f, 1.0f, 0.5f,		0.116841137f, 0.5f, 0.993150651f,	0.6145, 1.0,
-		.085f, 1.0f, 0.49f,		0.116841137f, 0.5f, 0.993150651f,	0.628, 1.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.5f, 0.993150651f,	0.7756, 0.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.5f, 0.973417103f,	0.8033, 0.0,
-		.085f, 1.0f, 0.49f,		0.229039446f, 0.5f, 0.973417103f,	0.628, 1.0,
-		.17f, 1.0f, 0.47f,		0.229039446f, 0.5f, 0.973417103f,	0.6415, 1.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.5f, 0.973417103f,	0.8033, 0.0,
-		.5f, 0.0f, 0.87f,		0.229039446f, 0.5f, 0.973417103f,	0.831, 0.0,
-		.17f, 1.0f, 0.47f,		0.229039446f, 0.5f, 0.973417103f,	0.6415, 1.0,
-		.25f, 1.0f, 0.435f,		0.581238329f, 0.5f, 0.813733339f,	0.655, 1.0,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.5f, 0.813733339f,	0.831, 0.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.5f, 0.813733339f,	0.8587, 0.0,
-		.25f, 1.0f, 0.435f,		0.581238329f, 0.5f, 0.813733339f,	0.655, 1.0,
-		.32f, 1.0f, 0.385f,		0.581238329f, 0.5f, 0.813733339f,	0.6685, 1.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.5f, 0.813733339f,	0.8587, 0.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.5f, 0.707106769f,	0.8864, 0.0,
-		.32f, 1.0f, 0.385f,		0.707106769f, 0.5f, 0.707106769f,	0.6685, 1.0,
-		.385f, 1.0f, 0.32f,		0.707106769f, 0.5f, 0.707106769f,	0.682, 1.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.5f, 0.707106769f,	0.8864, 0.0,
-		.87f, 0.0f, 0.5f,		0.707106769f, 0.5f, 0.707106769f,	0.9141, 0.0,
-		.385f, 1.0f, 0.32f,		0.707106769f, 0.5f, 0.707106769f,	0.682, 1.0,
-		.435f, 1.0f, 0.25f,		0.916157305f, 0.5f, 0.400818795f,	0.6955, 1.0,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.5f, 0.400818795f,	0.9141, 0.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.5f, 0.400818795f,	0.9418, 0.0,
-		.435f, 1.0f, 0.25f,		0.916157305f, 0.5f, 0.400818795f,	0.6955, 1.0,
-		.47f, 1.0f, 0.17f,		0.916157305f, 0.5f, 0.400818795f,	0.709, 1.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.5f, 0.400818795f,	0.9418, 1.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.9695, 0.0,
-		.47f, 1.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.709, 0.0,
-		.49f, 1.0f, 0.085f,		0.973417103f, 0.5f, 0.229039446f,	0.7225, 1.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.9695, 0.0,
-		1.0f, 0.0f, 0.0f,		0.973417103f, 0.5f, 0.229039446f,	1.0, 0.0,
-		.49f, 1.0f, 0.085f,		0.973417103f, 0.5f, 0.229039446f,	0.7225, 1.0,
-		0.5f, 1.0f, 0.0f,		0.993150651f, 0.5f, 0.116841137f,	0.75, 1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.5f, 0.116841137f,	1.0, 0.0
-	};
-
-	// store vertex and index count
-	m_TaperedCylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_TaperedCylinderMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_TaperedCylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_TaperedCylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TaperedCylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	LoadMeshLODs(m_TaperedCylinderMesh, SHAPE_TAPERED_CYLINDER, segments, 0, 0.0f, "TaperedCylinder");
 }
 
 ///////////////////////////////////////////////////
 //	LoadTorusMesh()
 //
-//	Create a torus mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	Generate an indexed torus mesh with the passed in
+//  tube thickness and segment counts and store it in
+//  a VAO/VBO.  Every variant is kept side by side, and
+//  loading the same variant again returns the already
+//  uploaded mesh.  Returns the variant number to pass
+//  to DrawTorusMesh().
 //
 //	Correct triangle drawing command:
 //
-//	glDrawArrays(GL_TRIANGLES, 0, meshes.gTorusMesh.nVertices);
+//	glDrawElements(GL_TRIANGLES, meshes.gTorusMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadTorusMesh(float thickness)
+int ShapeMeshes::LoadTorusMesh(
+	float thickness,
+	GLuint mainSegments,
+	GLuint tubeSegments)
 {
-	int _mainSegments = 30;
-	int _tubeSegments = 30;
-	float _mainRadius = 1.0f;
-	float _tubeRadius = .1f;
-
+	float tubeRadius = 0.1f;
 	if (thickness <= 1.0)
 	{
-		_tubeRadius = thickness;
-	}
-
-	auto mainSegmentAngleStep = glm::radians(360.0f / float(_mainSegments));
-	auto tubeSegmentAngleStep = glm::radians(360.0f / float(_tubeSegments));
-
-	std::vector<glm::vec3> vertex_list;
-	std::vector<std::vector<glm::vec3>> segments_list;
-	std::vector<glm::vec2> texture_coords;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	glm::vec3 normal;
-	glm::vec3 vertex;
-	glm::vec2 text_coord;
-
-	// generate the torus vertices
-	auto currentMainSegmentAngle = 0.0f;
-	for (auto i = 0; i < _mainSegments; i++)
-	{
-		// Calculate sine and cosine of main segment angle
-		auto sinMainSegment = sin(currentMainSegmentAngle);
-		auto cosMainSegment = cos(currentMainSegmentAngle);
-		auto currentTubeSegmentAngle = 0.0f;
-		std::vector<glm::vec3> segment_points;
-		for (auto j = 0; j < _tubeSegments; j++)
-		{
-			// Calculate sine and cosine of tube segment angle
-			auto sinTubeSegment = sin(currentTubeSegmentAngle);
-			auto cosTubeSegment = cos(currentTubeSegmentAngle);
-
-			// Calculate vertex position on the surface of torus
-			auto surfacePosition = glm::vec3(
-				(_mainRadius + _tubeRadius * cosTubeSegment) * cosMainSegment,
-				(_mainRadius + _tubeRadius * cosTubeSegment) * sinMainSegment,
-				_tubeRadius * sinTubeSegment);
-
-			//vertex_list.push_back(surfacePosition);
-			segment_points.push_back(surfacePosition);
-
-			// Update current tube angle
-			currentTubeSegmentAngle += tubeSegmentAngleStep;
-		}
-		segments_list.push_back(segment_points);
-		segment_points.clear();
-
-		// Update main segment angle
-		currentMainSegmentAngle += mainSegmentAngleStep;
-	}
-
-	float horizontalStep = 1.0 / _mainSegments;
-	float verticalStep = 1.0 / _tubeSegments;
-	float u = 0.0;
-	float v = 0.0;
-
-	// connect the various segments together, forming triangles
-	for (int i = 0; i < _mainSegments; i++)
-	{
-		for (int j = 0; j < _tubeSegments; j++)
-		{
-			if (((i + 1) < _mainSegments) && ((j + 1) < _tubeSegments))
-			{
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i][j + 1]);
-				texture_coords.push_back(glm::vec2(u, v + verticalStep));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v + verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i + 1][j]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v - verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-			}
-			else
-			{
-				if (((i + 1) == _mainSegments) && ((j + 1) == _tubeSegments))
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((i + 1) == _mainSegments)
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][j + 1]);
-					texture_coords.push_back(glm::vec2(u, v + verticalStep));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((j + 1) == _tubeSegments)
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i + 1][j]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-
-			}
-			v += verticalStep;
-		}
-		v = 0.0;
-		u += horizontalStep;
+		tubeRadius = thickness;
 	}
 
-	std::vector<GLfloat> combined_values;
-
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < vertex_list.size(); i++)
+	// reuse a previously loaded variant with the same parameters
+	for (size_t i = 0; i < m_TorusMeshes.size(); i++)
 	{
-		vertex = vertex_list[i];
-		normal = normalize(vertex);
-		if (vertex.x < 0)
-		{
-			if (normal.x > 0)
-				normal.x *= -1;
-		}
-		else if (vertex.x > 0)
-		{
-			if (normal.x < 0)
-				normal.x *= -1;
-		}
-		if (vertex.y < 0)
-		{
-			if (normal.y > 0)
-				normal.y *= -1;
-		}
-		else if (vertex.y > 0)
-		{
-			if (normal.y < 0)
-				normal.y *= -1;
-		}
-		if (vertex.z < 0)
-		{
-			if (normal.z > 0)
-				normal.z *= -1;
-		}
-		else if (vertex.z > 0)
+		if ((m_TorusMeshes[i].tubeRadius == tubeRadius) &&
+			(m_TorusMeshes[i].mainSegments == mainSegments) &&
+			(m_TorusMeshes[i].tubeSegments == tubeSegments))
 		{
-			if (normal.z < 0)
-				normal.z *= -1;
+			return((int)i);
 		}
-		text_coord = texture_coords[i];
-		combined_values.push_back(vertex.x);
-		combined_values.push_back(vertex.y);
-		combined_values.push_back(vertex.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(text_coord.x);
-		combined_values.push_back(text_coord.y);
 	}
 
-	// store vertex and index count
-	m_TorusMesh.nVertices = vertex_list.size();
-	m_TorusMesh.nIndices = 0;
+	m_TorusMeshes.push_back(TorusMesh());
+	TorusMesh& torus = m_TorusMeshes.back();
+	torus.tubeRadius = tubeRadius;
+	torus.mainSegments = mainSegments;
+	torus.tubeSegments = tubeSegments;
 
-	// Create VAO
-	glGenVertexArrays(1, &m_TorusMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TorusMesh.vao);
+	LoadMeshLODs(torus.mesh, SHAPE_TORUS, mainSegments, tubeSegments, tubeRadius, "Torus");
 
-	// Create VBOs
-	glGenBuffers(1, m_TorusMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TorusMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	return((int)m_TorusMeshes.size() - 1);
 }
 
 
@@ -2194,11 +511,7 @@ void ShapeMeshes::LoadTorusMesh(float thickness)
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawBoxMesh()
 {
-	glBindVertexArray(m_BoxMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_BoxMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	DrawMesh(m_BoxMesh);
 }
 
 ///////////////////////////////////////////////////
@@ -2210,15 +523,16 @@ void ShapeMeshes::DrawBoxMesh()
 void ShapeMeshes::DrawConeMesh(
 	bool bDrawBottom)
 {
-	glBindVertexArray(m_ConeMesh.vao);
+	const GLMesh& cone = SelectLOD(m_ConeMesh, m_lodDrawID);
 
 	if (bDrawBottom == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
+		DrawMeshParts(cone, MeshGenerator::PART_BOTTOM, MeshGenerator::PART_SIDES);	//bottom and sides
+	}
+	else
+	{
+		DrawMeshParts(cone, MeshGenerator::PART_SIDES, MeshGenerator::PART_SIDES);	//sides
 	}
-	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
-
-	glBindVertexArray(0);
 }
 
 ///////////////////////////////////////////////////
@@ -2232,22 +546,28 @@ void ShapeMeshes::DrawCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_CylinderMesh.vao);
+	const GLMesh& cylinder = SelectLOD(m_CylinderMesh, m_lodDrawID);
 
-	if (bDrawBottom == true)
-	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
-	}
-	if (bDrawTop == true)
+	if ((bDrawBottom == true) && (bDrawTop == true) && (bDrawSides == true))
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 36);	//top
+		// the parts are contiguous, so the whole mesh is one draw
+		DrawMeshParts(cylinder, MeshGenerator::PART_BOTTOM, MeshGenerator::PART_SIDES);
 	}
-	if (bDrawSides == true)
+	else
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+		if (bDrawBottom == true)
+		{
+			DrawMeshParts(cylinder, MeshGenerator::PART_BOTTOM, MeshGenerator::PART_BOTTOM);	//bottom
+		}
+		if (bDrawTop == true)
+		{
+			DrawMeshParts(cylinder, MeshGenerator::PART_TOP, MeshGenerator::PART_TOP);	//top
+		}
+		if (bDrawSides == true)
+		{
+			DrawMeshParts(cylinder, MeshGenerator::PART_SIDES, MeshGenerator::PART_SIDES);	//sides
+		}
 	}
-
-	glBindVertexArray(0);
 }
 
 ///////////////////////////////////////////////////
@@ -2258,11 +578,7 @@ void ShapeMeshes::DrawCylinderMesh(
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPlaneMesh()
 {
-	glBindVertexArray(m_PlaneMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_PlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-	
-	glBindVertexArray(0);
+	DrawMesh(m_PlaneMesh);
 }
 
 ///////////////////////////////////////////////////
@@ -2273,11 +589,7 @@ void ShapeMeshes::DrawPlaneMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPrismMesh()
 {
-	glBindVertexArray(m_PrismMesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_PrismMesh.nVertices);
-
-	glBindVertexArray(0);
+	DrawMesh(m_PrismMesh);
 }
 
 ///////////////////////////////////////////////////
@@ -2288,11 +600,7 @@ void ShapeMeshes::DrawPrismMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid3Mesh()
 {
-	glBindVertexArray(m_Pyramid3Mesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid3Mesh.nVertices);
-
-	glBindVertexArray(0);
+	DrawMesh(m_Pyramid3Mesh);
 }
 
 ///////////////////////////////////////////////////
@@ -2303,11 +611,7 @@ void ShapeMeshes::DrawPyramid3Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid4Mesh()
 {
-	glBindVertexArray(m_Pyramid4Mesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid4Mesh.nVertices);
-
-	glBindVertexArray(0);
+	DrawMesh(m_Pyramid4Mesh);
 }
 
 ///////////////////////////////////////////////////
@@ -2318,11 +622,7 @@ void ShapeMeshes::DrawPyramid4Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	DrawMesh(SelectLOD(m_SphereMesh, m_lodDrawID));
 }
 
 ///////////////////////////////////////////////////
@@ -2333,11 +633,7 @@ void ShapeMeshes::DrawSphereMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices/2, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	DrawMeshParts(SelectLOD(m_SphereMesh, m_lodDrawID), MeshGenerator::PART_TOP_HALF, MeshGenerator::PART_TOP_HALF);
 }
 
 ///////////////////////////////////////////////////
@@ -2351,22 +647,28 @@ void ShapeMeshes::DrawTaperedCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
+	const GLMesh& cylinder = SelectLOD(m_TaperedCylinderMesh, m_lodDrawID);
 
-	if (bDrawBottom == true)
-	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
-	}
-	if (bDrawTop == true)
+	if ((bDrawBottom == true) && (bDrawTop == true) && (bDrawSides == true))
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 72);	//top
+		// the parts are contiguous, so the whole mesh is one draw
+		DrawMeshParts(cylinder, MeshGenerator::PART_BOTTOM, MeshGenerator::PART_SIDES);
 	}
-	if (bDrawSides == true)
+	else
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+		if (bDrawBottom == true)
+		{
+			DrawMeshParts(cylinder, MeshGenerator::PART_BOTTOM, MeshGenerator::PART_BOTTOM);	//bottom
+		}
+		if (bDrawTop == true)
+		{
+			DrawMeshParts(cylinder, MeshGenerator::PART_TOP, MeshGenerator::PART_TOP);	//top
+		}
+		if (bDrawSides == true)
+		{
+			DrawMeshParts(cylinder, MeshGenerator::PART_SIDES, MeshGenerator::PART_SIDES);	//sides
+		}
 	}
-
-	glBindVertexArray(0);
 }
 
 ///////////////////////////////////////////////////
@@ -2375,13 +677,14 @@ void ShapeMeshes::DrawTaperedCylinderMesh(
 //	Transform and draw the plane mesh to the window.
 // 
 ///////////////////////////////////////////////////
-void ShapeMeshes::DrawTorusMesh()
+void ShapeMeshes::DrawTorusMesh(int variant)
 {
-	glBindVertexArray(m_TorusMesh.vao);
-
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices);
+	if ((variant < 0) || (variant >= (int)m_TorusMeshes.size()))
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	DrawMesh(SelectLOD(m_TorusMeshes[variant].mesh, m_lodDrawID));
 }
 
 ///////////////////////////////////////////////////
@@ -2390,50 +693,1458 @@ void ShapeMeshes::DrawTorusMesh()
 //	Transform and draw the plane mesh to the window.
 // 
 ///////////////////////////////////////////////////
-void ShapeMeshes::DrawHalfTorusMesh()
+void ShapeMeshes::DrawHalfTorusMesh(int variant)
 {
-	glBindVertexArray(m_TorusMesh.vao);
-
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices/2);
+	if ((variant < 0) || (variant >= (int)m_TorusMeshes.size()))
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	DrawMeshParts(SelectLOD(m_TorusMeshes[variant].mesh, m_lodDrawID), MeshGenerator::PART_FIRST_HALF, MeshGenerator::PART_FIRST_HALF);
 }
 
-glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2)
+///////////////////////////////////////////////////
+//	DrawImportedMesh()
+//
+//	Transform and draw a mesh loaded from a file to
+//  the window.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawImportedMesh(int mesh)
 {
-	glm::vec3 Normal(0, 0, 0);
-	float v1x = p1.x - p0.x;
-	float v1y = p1.y - p0.y;
-	float v1z = p1.z - p0.z;
-	float v2x = p2.x - p1.x;
-	float v2y = p2.y - p1.y;
-	float v2z = p2.z - p1.z;
-	Normal.x = v1y * v2z - v1z * v2y;
-	Normal.y = v1z * v2x - v1x * v2z;
-	Normal.y = v1x * v2y - v1y * v2x;
-	float len = (float)sqrt(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
-	if (len == 0)
+	if ((mesh < 0) || (mesh >= (int)m_ImportedMeshes.size()))
 	{
-		//throw Exception();
+		return;
 	}
-	else
+
+	DrawMesh(m_ImportedMeshes[mesh]);
+}
+
+///////////////////////////////////////////////////
+//	DrawBoxMeshInstanced()
+//
+//	Draw one copy of the box mesh for every passed in
+//  transform with a single draw call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawBoxMeshInstanced(
+	const glm::mat4* pTransforms,
+	const glm::vec4* pColors,
+	GLuint nInstances)
+{
+	DrawMeshInstanced(m_BoxMesh, pTransforms, pColors, nInstances);
+}
+
+///////////////////////////////////////////////////
+//	DrawConeMeshInstanced()
+//
+//	Draw one copy of the cone mesh for every passed in
+//  transform with a single draw call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawConeMeshInstanced(
+	const glm::mat4* pTransforms,
+	const glm::vec4* pColors,
+	GLuint nInstances)
+{
+	DrawMeshInstanced(SelectInstancedLOD(m_ConeMesh, pTransforms, nInstances, m_lodDrawID), pTransforms, pColors, nInstances);
+}
+
+///////////////////////////////////////////////////
+//	DrawCylinderMeshInstanced()
+//
+//	Draw one copy of the cylinder mesh for every passed
+//  in transform with a single draw call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawCylinderMeshInstanced(
+	const glm::mat4* pTransforms,
+	const glm::vec4* pColors,
+	GLuint nInstances)
+{
+	DrawMeshInstanced(SelectInstancedLOD(m_CylinderMesh, pTransforms, nInstances, m_lodDrawID), pTransforms, pColors, nInstances);
+}
+
+///////////////////////////////////////////////////
+//	DrawPlaneMeshInstanced()
+//
+//	Draw one copy of the plane mesh for every passed in
+//  transform with a single draw call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawPlaneMeshInstanced(
+	const glm::mat4* pTransforms,
+	const glm::vec4* pColors,
+	GLuint nInstances)
+{
+	DrawMeshInstanced(m_PlaneMesh, pTransforms, pColors, nInstances);
+}
+
+///////////////////////////////////////////////////
+//	DrawSphereMeshInstanced()
+//
+//	Draw one copy of the sphere mesh for every passed
+//  in transform with a single draw call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawSphereMeshInstanced(
+	const glm::mat4* pTransforms,
+	const glm::vec4* pColors,
+	GLuint nInstances)
+{
+	DrawMeshInstanced(SelectInstancedLOD(m_SphereMesh, pTransforms, nInstances, m_lodDrawID), pTransforms, pColors, nInstances);
+}
+
+///////////////////////////////////////////////////
+//	DrawTorusMeshInstanced()
+//
+//	Draw one copy of a torus variant for every passed
+//  in transform with a single draw call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawTorusMeshInstanced(
+	const glm::mat4* pTransforms,
+	const glm::vec4* pColors,
+	GLuint nInstances,
+	int variant)
+{
+	if ((variant < 0) || (variant >= (int)m_TorusMeshes.size()))
 	{
-		Normal.x /= len;
-		Normal.y /= len;
-		Normal.z /= len;
+		return;
 	}
-	return Normal;
+
+	DrawMeshInstanced(SelectInstancedLOD(m_TorusMeshes[variant].mesh, pTransforms, nInstances, m_lodDrawID), pTransforms, pColors, nInstances);
 }
 
+///////////////////////////////////////////////////
+//	DrawImportedMeshInstanced()
+//
+//	Draw one copy of a mesh loaded from a file for
+//  every passed in transform with a single draw call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawImportedMeshInstanced(
+	int mesh,
+	const glm::mat4* pTransforms,
+	const glm::vec4* pColors,
+	GLuint nInstances)
+{
+	if ((mesh < 0) || (mesh >= (int)m_ImportedMeshes.size()))
+	{
+		return;
+	}
 
+	DrawMeshInstanced(m_ImportedMeshes[mesh], pTransforms, pColors, nInstances);
+}
 
-void ShapeMeshes::SetShaderMemoryLayout()
+///////////////////////////////////////////////////
+//	SetLODCamera()
+//
+//	Store the view and projection of the frame about
+//  to be drawn, for picking the detail levels.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetLODCamera(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	float viewportHeight)
 {
-	// The following code defines the layout of the mesh data in memory - each mesh needs
-	// to have the same memory layout so that the data is retrieved properly by the shaders
+	m_lodView = view;
+	m_lodProjection = projection;
+	m_viewportHeight = viewportHeight;
+	m_bLODCameraSet = true;
+}
 
-	// Strides between vertex coordinates is 6 (x, y, z, r, g, b, a). A tightly packed stride is 0.
-	GLint stride = sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV);// The number of floats before each
+///////////////////////////////////////////////////
+//	SetModelMatrix()
+//
+//	Store the model transform of the next draw, for
+//  picking its detail level.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetModelMatrix(const glm::mat4& model)
+{
+	m_lodModel = model;
+}
+
+///////////////////////////////////////////////////
+//	SetDrawID()
+//
+//	Store the id the detail level of the following
+//  draws is kept under, so a draw moves from the
+//  level it had in the previous frame whatever order
+//  the draws are made in.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetDrawID(GLuint drawId)
+{
+	m_lodDrawID = drawId;
+}
+
+///////////////////////////////////////////////////
+//	SetLODThresholds()
+//
+//	Set the projected diameters in pixels below which
+//  each coarser detail level is used, from the finest
+//  to the coarsest, and the hysteresis fraction a size
+//  must cross a threshold by before the level changes.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetLODThresholds(
+	const float* thresholds,
+	GLuint nThresholds,
+	float hysteresis)
+{
+	for (GLuint i = 0; (i < nThresholds) && (i < MAX_LODS - 1); i++)
+	{
+		m_lodThresholds[i] = thresholds[i];
+	}
+	m_lodHysteresis = hysteresis;
+}
+
+///////////////////////////////////////////////////
+//	BeginDrawRecording()
+//
+//	Start appending the draws to the passed in list
+//  instead of drawing them.  The detail levels are
+//  still picked as usual.
+///////////////////////////////////////////////////
+void ShapeMeshes::BeginDrawRecording(std::vector<RecordedDraw>* pDraws)
+{
+	m_pRecordedDraws = pDraws;
+	m_recordingState = 0;
+}
+
+///////////////////////////////////////////////////
+//	SetDrawRecordingState()
+//
+//	Set the caller state stored with the following
+//  recorded draws.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetDrawRecordingState(GLuint state)
+{
+	m_recordingState = state;
+}
+
+///////////////////////////////////////////////////
+//	EndDrawRecording()
+//
+//	Go back to drawing the draws right away.
+///////////////////////////////////////////////////
+void ShapeMeshes::EndDrawRecording()
+{
+	m_pRecordedDraws = NULL;
+}
+
+///////////////////////////////////////////////////
+//	SetIndirectDraws()
+//
+//	Copy the commands of the passed in draws, in order,
+//  into the indirect buffer.  The buffer is orphaned
+//  first so the driver does not wait for the previous
+//  frame to finish reading it.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetIndirectDraws(const RecordedDraw* pDraws, GLuint nDraws)
+{
+	m_indirectCommands.resize(nDraws);
+	for (GLuint i = 0; i < nDraws; i++)
+	{
+		m_indirectCommands[i] = pDraws[i].command;
+	}
+
+	if (m_indirectBuffer == 0)
+	{
+		glGenBuffers(1, &m_indirectBuffer);
+	}
+	if (m_boundIndirectBuffer != m_indirectBuffer)
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+		m_boundIndirectBuffer = m_indirectBuffer;
+	}
+
+	GLsizeiptr commandBytes = sizeof(DrawElementsIndirectCommand) * nDraws;
+	while (m_indirectCapacity < commandBytes)
+	{
+		m_indirectCapacity = (std::max)(m_indirectCapacity * 2, (GLsizeiptr)g_IndirectInitialBytes);
+	}
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, m_indirectCapacity, NULL, GL_STREAM_DRAW);
+	if (commandBytes > 0)
+	{
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commandBytes, m_indirectCommands.data());
+	}
+}
+
+///////////////////////////////////////////////////
+//	MultiDrawIndirect()
+//
+//	Draw the uploaded commands from firstDraw on with
+//  one call.  They must all read from the passed in
+//  vertex array and use the passed in index type.
+///////////////////////////////////////////////////
+void ShapeMeshes::MultiDrawIndirect(
+	GLuint vao,
+	GLenum indexType,
+	GLuint firstDraw,
+	GLuint nDraws)
+{
+	if ((nDraws == 0) || (m_indirectBuffer == 0))
+	{
+		return;
+	}
+
+	if (m_boundVAO != vao)
+	{
+		glBindVertexArray(vao);
+		m_boundVAO = vao;
+	}
+	if (m_boundIndirectBuffer != m_indirectBuffer)
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+		m_boundIndirectBuffer = m_indirectBuffer;
+	}
+
+	glMultiDrawElementsIndirect(
+		GL_TRIANGLES,
+		indexType,
+		(void*)(sizeof(DrawElementsIndirectCommand) * firstDraw),
+		nDraws,
+		0);
+}
+
+///////////////////////////////////////////////////
+//	LoadImportedMesh()
+//
+//	Load a mesh from the passed in OBJ or binary glTF
+//  file and store it in a VAO/VBO the same way as the
+//  primitives.  Returns the number of the mesh to pass
+//  to DrawImportedMesh(), or -1 if it could not be
+//  loaded.
+///////////////////////////////////////////////////
+int ShapeMeshes::LoadImportedMesh(const char* filename)
+{
+	m_ImportedMeshes.push_back(GLMesh());
+
+	MeshJob job;
+	job.pMesh = &m_ImportedMeshes.back();
+	job.name = filename;
+	job.filename = filename;
+
+	// a queued import that fails leaves an empty mesh
+	if (m_bDeferLoading == true)
+	{
+		m_meshJobs.push_back(job);
+		return((int)m_ImportedMeshes.size() - 1);
+	}
+
+	RunMeshJob(job);
+	FinishMeshJob(job, job.data);
+	if (job.bLoaded == false)
+	{
+		m_ImportedMeshes.pop_back();
+		return(-1);
+	}
+	return((int)m_ImportedMeshes.size() - 1);
+}
+
+///////////////////////////////////////////////////
+//	OpenMeshCache()
+//
+//	Map the passed in mesh cache file, so that the
+//  primitives loaded until CloseMeshCache() is called
+//  are uploaded from it instead of being generated.
+//  The cache only holds meshes in the vertex format
+//  of this object, from the current version of the
+//  generator and optimizer.
+///////////////////////////////////////////////////
+bool ShapeMeshes::OpenMeshCache(const char* filename)
+{
+	uint32_t formatTag = (g_MeshCacheGeneratorVersion << 8) | m_vertexStride;
+	return(m_meshCache.Open(filename, formatTag));
+}
+
+///////////////////////////////////////////////////
+//	CloseMeshCache()
+//
+//	Write any newly generated meshes to the mesh
+//  cache file and release the mapping.
+///////////////////////////////////////////////////
+bool ShapeMeshes::CloseMeshCache()
+{
+	return(m_meshCache.Close());
+}
+
+///////////////////////////////////////////////////
+//	LoadMeshLODs()
+//
+//	Generate the passed in primitive at full detail,
+//  then halve the segment counts for every coarser
+//  level until they reach the minimum the shape
+//  still looks right with.
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadMeshLODs(
+	MeshLODs& chain,
+	LOD_SHAPES shape,
+	GLuint segments,
+	GLuint segments2,
+	float radius,
+	const char* name)
+{
+	GLuint lodSegments = segments;
+	GLuint lodSegments2 = segments2;
+
+	LoadMeshLOD(chain.lods[0], shape, lodSegments, lodSegments2, radius, name);
+	chain.nLods = 1;
+
+	while (chain.nLods < MAX_LODS)
+	{
+		GLuint nextSegments = (std::max)(lodSegments / 2, g_MinLODSegments);
+		GLuint nextSegments2 = lodSegments2 / 2;
+
+		// the half sphere and half torus need an even
+		// number of stacks and main segments
+		if (shape == SHAPE_SPHERE)
+		{
+			nextSegments2 = (std::max)(nextSegments2 & ~1u, g_MinLODStacks);
+		}
+		else if (shape == SHAPE_TORUS)
+		{
+			nextSegments = (std::max)(nextSegments & ~1u, g_MinLODSegments);
+			nextSegments2 = (std::max)(nextSegments2, g_MinLODSegments);
+		}
+
+		// stop once the level would not get any coarser
+		if ((nextSegments >= lodSegments) && (nextSegments2 >= lodSegments2))
+		{
+			break;
+		}
+		lodSegments = (std::min)(nextSegments, lodSegments);
+		lodSegments2 = (std::min)(nextSegments2, lodSegments2);
+
+		LoadMeshLOD(chain.lods[chain.nLods], shape, lodSegments, lodSegments2, radius, name);
+		chain.nLods++;
+	}
+}
+
+///////////////////////////////////////////////////
+//	LoadMeshLOD()
+//
+//	Load one detail level from the mesh cache, or
+//  generate it and add it to the cache when it is
+//  not found there.  While loading is deferred the
+//  generation is queued as a job.
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadMeshLOD(
+	GLMesh& mesh,
+	LOD_SHAPES shape,
+	GLuint segments,
+	GLuint segments2,
+	float radius,
+	const char* name)
+{
+	uint32_t radiusBits = 0;
+	memcpy(&radiusBits, &radius, sizeof(radiusBits));
+	const uint32_t parameters[] = { (uint32_t)shape, segments, segments2, radiusBits };
+	uint64_t cacheKey = MeshCache::MakeKey(parameters, sizeof(parameters) / sizeof(parameters[0]));
+
+	if (LoadCachedMesh(mesh, cacheKey) == true)
+	{
+		return;
+	}
+
+	MeshJob job;
+	job.pMesh = &mesh;
+	job.name = name;
+	job.cacheKey = cacheKey;
+	job.shape = shape;
+	job.segments = segments;
+	job.segments2 = segments2;
+	job.radius = radius;
+
+	if (m_bDeferLoading == true)
+	{
+		m_meshJobs.push_back(job);
+		return;
+	}
+
+	RunMeshJob(job);
+	FinishMeshJob(job, job.data);
+}
+
+///////////////////////////////////////////////////
+//	GenerateMesh()
+//
+//	Generate the passed in primitive into the passed
+//  in mesh data.
+///////////////////////////////////////////////////
+void ShapeMeshes::GenerateMesh(
+	MeshGenerator& generator,
+	MeshData& data,
+	LOD_SHAPES shape,
+	GLuint segments,
+	GLuint segments2,
+	float radius)
+{
+	switch (shape)
+	{
+	case SHAPE_CONE:
+		generator.GenerateCone(data, segments);
+		break;
+	case SHAPE_CYLINDER:
+		generator.GenerateCylinder(data, segments);
+		break;
+	case SHAPE_SPHERE:
+		generator.GenerateSphere(data, segments, segments2);
+		break;
+	case SHAPE_TAPERED_CYLINDER:
+		generator.GenerateTaperedCylinder(data, segments);
+		break;
+	case SHAPE_TORUS:
+		generator.GenerateTorus(data, segments, segments2, radius);
+		break;
+	}
+}
+
+///////////////////////////////////////////////////
+//	SelectLOD()
+//
+//	Pick the detail level for the next draw from the
+//  projected size of the mesh.  The level only moves
+//  once the size is past a threshold by the hysteresis
+//  fraction, so objects near a threshold do not flicker
+//  between levels.  Draws are matched to those of the
+//  previous frame by the passed in draw id.
+///////////////////////////////////////////////////
+const ShapeMeshes::GLMesh& ShapeMeshes::SelectLOD(const MeshLODs& chain, GLuint drawId)
+{
+	if ((m_bLODCameraSet == false) || (chain.nLods < 2))
+	{
+		return(chain.lods[0]);
+	}
+
+	return(SelectLODForSize(chain, ProjectedSize(chain.lods[0], m_lodModel), drawId));
+}
+
+///////////////////////////////////////////////////
+//	SelectInstancedLOD()
+//
+//	Pick the detail level for the next instanced draw
+//  from the largest projected size of its instances,
+//  so that no instance is drawn coarser than it would
+//  be on its own.
+///////////////////////////////////////////////////
+const ShapeMeshes::GLMesh& ShapeMeshes::SelectInstancedLOD(
+	const MeshLODs& chain,
+	const glm::mat4* pTransforms,
+	GLuint nInstances,
+	GLuint drawId)
+{
+	if ((m_bLODCameraSet == false) || (chain.nLods < 2))
+	{
+		return(chain.lods[0]);
+	}
+
+	float size = 0.0f;
+	for (GLuint i = 0; i < nInstances; i++)
+	{
+		size = (std::max)(size, ProjectedSize(chain.lods[0], pTransforms[i]));
+	}
+
+	return(SelectLODForSize(chain, size, drawId));
+}
+
+///////////////////////////////////////////////////
+//	SelectLODForSize()
+//
+//	Pick the detail level for the next draw from the
+//  passed in projected size, moving from the level
+//  last picked for the same draw id.
+///////////////////////////////////////////////////
+const ShapeMeshes::GLMesh& ShapeMeshes::SelectLODForSize(const MeshLODs& chain, float size, GLuint drawId)
+{
+	if (drawId >= m_lastLODs.size())
+	{
+		m_lastLODs.resize(drawId + 1, 0);
+	}
+
+	GLuint lod = (std::min)(m_lastLODs[drawId], chain.nLods - 1);
+
+	while ((lod > 0) && (size > m_lodThresholds[lod - 1] * (1.0f + m_lodHysteresis)))
+	{
+		lod--;
+	}
+	while ((lod + 1 < chain.nLods) && (size < m_lodThresholds[lod] * (1.0f - m_lodHysteresis)))
+	{
+		lod++;
+	}
+
+	m_lastLODs[drawId] = lod;
+	return(chain.lods[lod]);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshBounds()
+//
+//	Get the box around the bounding boxes of every
+//  detail level of the passed in mesh.  The half
+//  sphere and half torus are drawn from the full
+//  meshes, so their boxes are those of the full
+//  meshes.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetMeshBounds(
+	SHAPE_MESHES shape,
+	glm::vec3& center,
+	glm::vec3& extent,
+	int variant) const
+{
+	const GLMesh* pMeshes = NULL;
+	GLuint nMeshes = 1;
+	const MeshLODs* pChain = NULL;
+
+	switch (shape)
+	{
+	case MESH_BOX:
+		pMeshes = &m_BoxMesh;
+		break;
+	case MESH_CONE:
+		pChain = &m_ConeMesh;
+		break;
+	case MESH_CYLINDER:
+		pChain = &m_CylinderMesh;
+		break;
+	case MESH_PLANE:
+		pMeshes = &m_PlaneMesh;
+		break;
+	case MESH_PRISM:
+		pMeshes = &m_PrismMesh;
+		break;
+	case MESH_PYRAMID3:
+		pMeshes = &m_Pyramid3Mesh;
+		break;
+	case MESH_PYRAMID4:
+		pMeshes = &m_Pyramid4Mesh;
+		break;
+	case MESH_SPHERE:
+		pChain = &m_SphereMesh;
+		break;
+	case MESH_TAPERED_CYLINDER:
+		pChain = &m_TaperedCylinderMesh;
+		break;
+	case MESH_TORUS:
+		if ((variant >= 0) && (variant < (int)m_TorusMeshes.size()))
+		{
+			pChain = &m_TorusMeshes[variant].mesh;
+		}
+		break;
+	case MESH_IMPORTED:
+		if ((variant >= 0) && (variant < (int)m_ImportedMeshes.size()))
+		{
+			pMeshes = &m_ImportedMeshes[variant];
+		}
+		break;
+	}
+	if (pChain != NULL)
+	{
+		pMeshes = pChain->lods;
+		nMeshes = pChain->nLods;
+	}
+	if (pMeshes == NULL)
+	{
+		return(false);
+	}
+
+	// meshes that are not loaded have no parts
+	glm::vec3 minimum(FLT_MAX);
+	glm::vec3 maximum(-FLT_MAX);
+	bool bLoaded = false;
+	for (GLuint i = 0; i < nMeshes; i++)
+	{
+		if (pMeshes[i].nParts == 0)
+		{
+			continue;
+		}
+		minimum = glm::min(minimum, pMeshes[i].boundsCenter - pMeshes[i].boundsExtent);
+		maximum = glm::max(maximum, pMeshes[i].boundsCenter + pMeshes[i].boundsExtent);
+		bLoaded = true;
+	}
+	if (bLoaded == false)
+	{
+		return(false);
+	}
+
+	center = (minimum + maximum) * 0.5f;
+	extent = (maximum - minimum) * 0.5f;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	ProjectedSize()
+//
+//	Calculate the diameter in pixels of the bounding
+//  sphere of the passed in mesh when drawn with the
+//  passed in model transform and the current camera.
+///////////////////////////////////////////////////
+float ShapeMeshes::ProjectedSize(const GLMesh& mesh, const glm::mat4& model)
+{
+	float pixelsPerUnit = GetPixelsPerUnit(
+		m_lodView,
+		m_lodProjection,
+		m_viewportHeight,
+		model,
+		mesh.boundsCenter,
+		mesh.boundsRadius);
+	if (pixelsPerUnit == FLT_MAX)
+	{
+		return(FLT_MAX);
+	}
+
+	return(2.0f * mesh.boundsRadius * pixelsPerUnit);
+}
+
+///////////////////////////////////////////////////
+//	GetPixelsPerUnit()
+//
+//	Calculate the number of pixels one unit of the
+//  space of the passed in model covers on the screen
+//  at the passed in sphere.  The distance from the
+//  camera is used rather than the depth, so turning
+//  the camera does not change the size.
+///////////////////////////////////////////////////
+float ShapeMeshes::GetPixelsPerUnit(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	float viewportHeight,
+	const glm::mat4& model,
+	const glm::vec3& center,
+	float radius)
+{
+	// the largest axis scale keeps the size conservative
+	float scale = (std::max)(
+		glm::length(glm::vec3(model[0])),
+		(std::max)(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+	float pixelsPerUnit = projection[1][1] * 0.5f * viewportHeight * scale;
+
+	// perspective projections shrink the size with distance,
+	// orthographic ones do not
+	if (projection[3][3] == 0.0f)
+	{
+		float distance = glm::length(glm::vec3(view * model * glm::vec4(center, 1.0f)));
+		if (distance <= radius * scale)
+		{
+			return(FLT_MAX);
+		}
+		pixelsPerUnit /= distance;
+	}
+
+	return(pixelsPerUnit);
+}
+
+///////////////////////////////////////////////////
+//	UploadMesh()
+//
+//	Optimize the passed in mesh data for the vertex
+//  cache, then store it on the GPU and keep the
+//  index ranges of its parts for drawing.  In
+//  arena mode the data is sub-allocated from the
+//  shared buffers, otherwise the mesh gets its own
+//  VAO and vertex and index buffers.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadMesh(GLMesh& mesh, MeshData& data, const char* name, uint64_t cacheKey)
+{
+	MeshJob job;
+	job.pMesh = &mesh;
+	job.name = name;
+	job.cacheKey = cacheKey;
+	job.bLoaded = true;
+
+	PrepareMesh(job, data);
+	FinishMeshJob(job, data);
+}
+
+///////////////////////////////////////////////////
+//	BeginLoading()
+//
+//	Queue the generated and imported meshes loaded
+//  from now on, instead of loading them right away.
+///////////////////////////////////////////////////
+void ShapeMeshes::BeginLoading()
+{
+	m_bDeferLoading = true;
+}
+
+///////////////////////////////////////////////////
+//	FinishLoading()
+//
+//	Generate and import the queued meshes on a pool
+//  of worker threads.  The workers hand each finished
+//  mesh back through a completion queue, and this
+//  thread, which owns the GL context, uploads them in
+//  the order they finish.
+///////////////////////////////////////////////////
+void ShapeMeshes::FinishLoading()
+{
+	m_bDeferLoading = false;
+	if (m_meshJobs.empty() == true)
+	{
+		return;
+	}
+
+	CompletionQueue<size_t> completed;
+	{
+		WorkerPool pool;
+		for (size_t i = 0; i < m_meshJobs.size(); i++)
+		{
+			MeshJob* pJob = &m_meshJobs[i];
+			pool.Submit([this, pJob, i, &completed]()
+			{
+				RunMeshJob(*pJob);
+				completed.Push(i);
+			});
+		}
+
+		for (size_t i = 0; i < m_meshJobs.size(); i++)
+		{
+			MeshJob& job = m_meshJobs[completed.Pop()];
+			FinishMeshJob(job, job.data);
+		}
+	}
+
+	m_meshJobs.clear();
+}
+
+///////////////////////////////////////////////////
+//	RunMeshJob()
+//
+//	Generate or import the mesh of the passed in job
+//  and prepare it for upload.  Only the job itself is
+//  written, so jobs can run on several threads.
+///////////////////////////////////////////////////
+void ShapeMeshes::RunMeshJob(MeshJob& job) const
+{
+	if (job.filename.empty() == false)
+	{
+		MeshImporter importer;
+		job.bLoaded = importer.LoadMesh(job.filename.c_str(), job.data);
+	}
+	else
+	{
+		MeshGenerator generator;
+		GenerateMesh(generator, job.data, job.shape, job.segments, job.segments2, job.radius);
+		job.bLoaded = true;
+	}
+
+	if (job.bLoaded == true)
+	{
+		PrepareMesh(job, job.data);
+	}
+}
+
+///////////////////////////////////////////////////
+//	PrepareMesh()
+//
+//	Optimize the passed in mesh data, calculate its
+//  bounding box and sphere and convert it into
+//  the selected vertex format, storing the results
+//  in the job.
+///////////////////////////////////////////////////
+void ShapeMeshes::PrepareMesh(MeshJob& job, MeshData& data) const
+{
+	MeshOptimizer optimizer;
+	optimizer.Optimize(data, &job.before, &job.after);
+
+	// bounding sphere around the center of the bounding box
+	glm::vec3 minimum(FLT_MAX);
+	glm::vec3 maximum(-FLT_MAX);
+	for (GLuint i = 0; i < data.VertexCount(); i++)
+	{
+		const GLfloat* pPosition = &data.vertices[i * MeshData::FLOATS_PER_VERTEX];
+		minimum = glm::min(minimum, glm::vec3(pPosition[0], pPosition[1], pPosition[2]));
+		maximum = glm::max(maximum, glm::vec3(pPosition[0], pPosition[1], pPosition[2]));
+	}
+	job.boundsCenter = (minimum + maximum) * 0.5f;
+	job.boundsExtent = (maximum - minimum) * 0.5f;
+	job.boundsRadius = 0.0f;
+	for (GLuint i = 0; i < data.VertexCount(); i++)
+	{
+		const GLfloat* pPosition = &data.vertices[i * MeshData::FLOATS_PER_VERTEX];
+		float distance = glm::length(glm::vec3(pPosition[0], pPosition[1], pPosition[2]) - job.boundsCenter);
+		job.boundsRadius = (std::max)(job.boundsRadius, distance);
+	}
+
+	PrepareUploadData(data, job.packedVertices, job.packedIndices, job.upload);
+}
+
+///////////////////////////////////////////////////
+//	FinishMeshJob()
+//
+//	Store the prepared mesh of the passed in job on
+//  the GPU, and add it to the mesh cache when it was
+//  given a cache key.
+///////////////////////////////////////////////////
+void ShapeMeshes::FinishMeshJob(MeshJob& job, const MeshData& data)
+{
+	if (job.bLoaded == false)
+	{
+		std::cout << "Could not load mesh:" << job.filename << std::endl;
+		return;
+	}
+
+	std::cout << "INFO: " << job.name << " mesh (" << data.VertexCount() << " vertices) optimized, ACMR "
+		<< job.before.acmr << " -> " << job.after.acmr << ", ATVR " << job.before.atvr << " -> " << job.after.atvr << std::endl;
+
+	GLMesh& mesh = *job.pMesh;
+	mesh.nVertices = data.VertexCount();
+	mesh.nIndices = data.IndexCount();
+	mesh.nParts = data.nParts;
+	for (GLuint i = 0; i < data.nParts; i++)
+	{
+		mesh.parts[i] = data.parts[i];
+	}
+	mesh.boundsCenter = job.boundsCenter;
+	mesh.boundsRadius = job.boundsRadius;
+	mesh.boundsExtent = job.boundsExtent;
+
+	if ((job.cacheKey != 0) && (m_meshCache.IsOpen() == true))
+	{
+		MeshCache::Entry entry;
+		entry.key = job.cacheKey;
+		entry.nVertices = mesh.nVertices;
+		entry.nIndices = mesh.nIndices;
+		entry.indexType = job.upload.indexType;
+		entry.nParts = mesh.nParts;
+		memcpy(entry.parts, mesh.parts, sizeof(entry.parts));
+		entry.boundsCenter[0] = mesh.boundsCenter.x;
+		entry.boundsCenter[1] = mesh.boundsCenter.y;
+		entry.boundsCenter[2] = mesh.boundsCenter.z;
+		entry.boundsRadius = mesh.boundsRadius;
+		entry.boundsExtent[0] = mesh.boundsExtent.x;
+		entry.boundsExtent[1] = mesh.boundsExtent.y;
+		entry.boundsExtent[2] = mesh.boundsExtent.z;
+		entry.reserved = 0;
+		entry.vertexBytes = job.upload.vertexBytes;
+		entry.indexBytes = job.upload.indexBytes;
+		m_meshCache.AddMesh(entry, job.upload.vertices, job.upload.indices);
+	}
+
+	UploadMeshData(mesh, job.upload);
+}
+
+///////////////////////////////////////////////////
+//	LoadCachedMesh()
+//
+//	Upload the mesh with the passed in key straight
+//  from the mapped cache file.  Returns false when
+//  the mesh is not in the cache.
+///////////////////////////////////////////////////
+bool ShapeMeshes::LoadCachedMesh(GLMesh& mesh, uint64_t cacheKey)
+{
+	const MeshCache::Entry* pEntry = m_meshCache.FindMesh(cacheKey);
+	if (pEntry == NULL)
+	{
+		return(false);
+	}
+
+	mesh.nVertices = pEntry->nVertices;
+	mesh.nIndices = pEntry->nIndices;
+	mesh.nParts = pEntry->nParts;
+	memcpy(mesh.parts, pEntry->parts, sizeof(mesh.parts));
+	mesh.boundsCenter = glm::vec3(pEntry->boundsCenter[0], pEntry->boundsCenter[1], pEntry->boundsCenter[2]);
+	mesh.boundsRadius = pEntry->boundsRadius;
+	mesh.boundsExtent = glm::vec3(pEntry->boundsExtent[0], pEntry->boundsExtent[1], pEntry->boundsExtent[2]);
+
+	UploadData upload;
+	upload.vertices = m_meshCache.GetData(pEntry->vertexOffset);
+	upload.vertexBytes = (GLsizeiptr)pEntry->vertexBytes;
+	upload.indices = m_meshCache.GetData(pEntry->indexOffset);
+	upload.indexBytes = (GLsizeiptr)pEntry->indexBytes;
+	upload.indexType = pEntry->indexType;
+	upload.indexSize = (pEntry->indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+
+	UploadMeshData(mesh, upload);
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	UploadMeshData()
+//
+//	Copy the passed in vertex and index data into the
+//  shared arena buffers, or into a new VAO and
+//  buffers of the mesh.  In arena mode, a mesh with
+//  the same data and parts as one uploaded before,
+//  generated again or imported from another file, is
+//  pointed at the data of that mesh instead.  The
+//  arena owns the data of every mesh, so sharing it
+//  leaves no mesh to free it twice.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadMeshData(GLMesh& mesh, const UploadData& upload)
+{
+	mesh.indexType = upload.indexType;
+	mesh.indexSize = upload.indexSize;
+
+	uint64_t key = 0;
+	int shared = -1;
+	if (m_bUseArena == true)
+	{
+		key = ResourceRegistry::MakeKey(mesh.parts, sizeof(MeshPart) * mesh.nParts, upload.indexType);
+		key = ResourceRegistry::MakeKey(upload.indices, (size_t)upload.indexBytes, key);
+		key = ResourceRegistry::MakeKey(upload.vertices, (size_t)upload.vertexBytes, key);
+		shared = m_meshContents.FindResource(key);
+	}
+
+	if (shared >= 0)
+	{
+		const GLMesh& source = m_uploadedMeshes[shared];
+		mesh.vao = source.vao;
+		mesh.vbos[0] = source.vbos[0];
+		mesh.vbos[1] = source.vbos[1];
+		mesh.baseVertex = source.baseVertex;
+		mesh.indexOffset = source.indexOffset;
+
+		m_meshContents.AddDuplicate((size_t)(upload.vertexBytes + upload.indexBytes));
+		std::cout << "INFO: mesh (" << mesh.nVertices << " vertices) shares the data of an identical mesh, "
+			<< m_meshContents.GetDuplicateCount() << " shared meshes saved " << m_meshContents.GetSavedBytes() << " bytes" << std::endl;
+		return;
+	}
+
+	if (m_bUseArena == true)
+	{
+		AllocateArenaMesh(mesh, upload);
+
+		// a copy is kept, since the mesh itself can be loaded
+		// again with other data
+		m_meshContents.AddResource(key, (int)m_uploadedMeshes.size());
+		m_uploadedMeshes.push_back(mesh);
+	}
+	else
+	{
+		mesh.baseVertex = 0;
+		mesh.indexOffset = 0;
+
+		// Create VAO
+		glGenVertexArrays(1, &mesh.vao);
+		glBindVertexArray(mesh.vao);
+		m_boundVAO = mesh.vao;
+
+		// Create 2 buffers: first one for the vertex data; second one for the indices
+		glGenBuffers(2, mesh.vbos);
+		glBindBuffer(GL_ARRAY_BUFFER, mesh.vbos[0]); // Activates the vertex buffer
+		glBufferData(GL_ARRAY_BUFFER, upload.vertexBytes, upload.vertices, GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.vbos[1]); // Activates the index buffer
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, upload.indexBytes, upload.indices, GL_STATIC_DRAW);
+
+		if (m_bMemoryLayoutDone == false)
+		{
+			SetShaderMemoryLayout();
+		}
+	}
+}
+
+///////////////////////////////////////////////////
+//	PrepareUploadData()
+//
+//	Point the upload data at the generated mesh data
+//  as is, or in compact mode pack it into 20 byte
+//  vertices (float position, 2_10_10_10 normal,
+//  half-float UV) and 16-bit indices when the mesh
+//  has few enough vertices.
+///////////////////////////////////////////////////
+void ShapeMeshes::PrepareUploadData(
+	const MeshData& data,
+	std::vector<GLubyte>& packedVertices,
+	std::vector<GLushort>& packedIndices,
+	UploadData& upload) const
+{
+	const GLuint nVertices = data.VertexCount();
+	const GLuint nIndices = data.IndexCount();
+
+	upload.vertices = data.vertices.data();
+	upload.vertexBytes = sizeof(GLfloat) * data.vertices.size();
+	upload.indices = data.indices.data();
+	upload.indexBytes = sizeof(GLuint) * nIndices;
+	upload.indexType = GL_UNSIGNED_INT;
+	upload.indexSize = sizeof(GLuint);
+
+	if (m_bCompactVertices == false)
+	{
+		return;
+	}
+
+	packedVertices.resize(m_vertexStride * nVertices);
+	for (GLuint i = 0; i < nVertices; i++)
+	{
+		const GLfloat* src = &data.vertices[i * MeshData::FLOATS_PER_VERTEX];
+		GLubyte* dst = &packedVertices[i * m_vertexStride];
+
+		glm::uint32 normal = glm::packSnorm3x10_1x2(glm::vec4(src[3], src[4], src[5], 0.0f));
+		glm::uint16 uv[2] = { glm::packHalf1x16(src[6]), glm::packHalf1x16(src[7]) };
+
+		memcpy(dst, src, sizeof(GLfloat) * g_FloatsPerVertex);
+		memcpy(dst + g_CompactNormalOffset, &normal, sizeof(normal));
+		memcpy(dst + g_CompactUVOffset, uv, sizeof(uv));
+	}
+	upload.vertices = packedVertices.data();
+	upload.vertexBytes = packedVertices.size();
+
+	// indices are relative to the mesh, so 16 bits are
+	// enough for any mesh of up to 65536 vertices
+	if (nVertices <= 65536)
+	{
+		packedIndices.resize(nIndices);
+		for (GLuint i = 0; i < nIndices; i++)
+		{
+			packedIndices[i] = (GLushort)data.indices[i];
+		}
+		upload.indices = packedIndices.data();
+		upload.indexBytes = sizeof(GLushort) * nIndices;
+		upload.indexType = GL_UNSIGNED_SHORT;
+		upload.indexSize = sizeof(GLushort);
+	}
+}
+
+///////////////////////////////////////////////////
+//	AllocateArenaMesh()
+//
+//	Append the passed in mesh data to the end of the
+//  shared vertex and index buffers, growing them if
+//  needed, and record where the mesh starts.
+///////////////////////////////////////////////////
+void ShapeMeshes::AllocateArenaMesh(GLMesh& mesh, const UploadData& upload)
+{
+	const GLuint nVertices = (GLuint)(upload.vertexBytes / m_vertexStride);
+	// keep every index range 4 byte aligned so that 16-bit
+	// and 32-bit index ranges can share the buffer
+	const GLuint indexOffset = (m_arena.indexBytes + 3) & ~3u;
+
+	ReserveArena(m_arena.vertexCount + nVertices, indexOffset + (GLuint)upload.indexBytes);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_arena.vbo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)m_vertexStride * m_arena.vertexCount, upload.vertexBytes, upload.vertices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_arena.ibo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset, upload.indexBytes, upload.indices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	// the indices stay relative to the mesh, the base vertex
+	// offsets them into the shared vertex buffer at draw time
+	mesh.vao = m_arena.vao;
+	mesh.vbos[0] = 0;
+	mesh.vbos[1] = 0;
+	mesh.baseVertex = (GLint)m_arena.vertexCount;
+	mesh.indexOffset = indexOffset;
+
+	m_arena.vertexCount += nVertices;
+	m_arena.indexBytes = indexOffset + (GLuint)upload.indexBytes;
+}
+
+///////////////////////////////////////////////////
+//	ReserveArena()
+//
+//	Make sure the shared buffers can hold at least the
+//  passed in number of vertices and index bytes.  The
+//  buffers double in size and the already allocated
+//  meshes are copied over on the GPU.
+///////////////////////////////////////////////////
+void ShapeMeshes::ReserveArena(GLuint nVertices, GLuint indexBytes)
+{
+	bool bBuffersChanged = false;
+
+	if (m_arena.vao == 0)
+	{
+		glGenVertexArrays(1, &m_arena.vao);
+		bBuffersChanged = true;
+	}
+
+	if ((m_arena.vbo == 0) || (nVertices > m_arena.vertexCapacity))
+	{
+		GLuint capacity = (m_arena.vertexCapacity > 0) ? m_arena.vertexCapacity : g_ArenaInitialVertices;
+		while (capacity < nVertices)
+		{
+			capacity *= 2;
+		}
+		m_arena.vbo = ResizeArenaBuffer(m_arena.vbo, (GLsizeiptr)m_vertexStride * m_arena.vertexCount, (GLsizeiptr)m_vertexStride * capacity);
+		m_arena.vertexCapacity = capacity;
+		bBuffersChanged = true;
+	}
+
+	if ((m_arena.ibo == 0) || (indexBytes > m_arena.indexCapacity))
+	{
+		GLuint capacity = (m_arena.indexCapacity > 0) ? m_arena.indexCapacity : g_ArenaInitialIndexBytes;
+		while (capacity < indexBytes)
+		{
+			capacity *= 2;
+		}
+		m_arena.ibo = ResizeArenaBuffer(m_arena.ibo, m_arena.indexBytes, capacity);
+		m_arena.indexCapacity = capacity;
+		bBuffersChanged = true;
+	}
+
+	// point the shared VAO at the current buffers
+	if (bBuffersChanged == true)
+	{
+		glBindVertexArray(m_arena.vao);
+		m_boundVAO = m_arena.vao;
+		glBindBuffer(GL_ARRAY_BUFFER, m_arena.vbo);
+		SetShaderMemoryLayout();
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_arena.ibo);
+	}
+}
+
+///////////////////////////////////////////////////
+//	ResizeArenaBuffer()
+//
+//	Create a buffer of the new size, copy the used part
+//  of the old buffer into it and delete the old one.
+///////////////////////////////////////////////////
+GLuint ShapeMeshes::ResizeArenaBuffer(GLuint buffer, GLsizeiptr usedSize, GLsizeiptr newSize)
+{
+	GLuint newBuffer = 0;
+	glGenBuffers(1, &newBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, newSize, NULL, GL_STATIC_DRAW);
+
+	if (buffer != 0)
+	{
+		if (usedSize > 0)
+		{
+			glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedSize);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &buffer);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	return(newBuffer);
+}
+
+///////////////////////////////////////////////////
+//	DrawMesh()
+//
+//	Draw every part of the passed in mesh.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMesh(const GLMesh& mesh)
+{
+	if (mesh.nParts > 0)
+	{
+		DrawMeshParts(mesh, 0, mesh.nParts - 1);
+	}
+}
+
+///////////////////////////////////////////////////
+//	DrawMeshParts()
+//
+//	Draw the contiguous index range covering the parts
+//  from firstPart to lastPart of an indexed mesh.  The
+//  VAO is only bound when it differs from the last one
+//  used, so in arena mode it is bound once for every
+//  mesh.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMeshParts(const GLMesh& mesh, GLuint firstPart, GLuint lastPart)
+{
+	if ((firstPart > lastPart) || (lastPart >= mesh.nParts))
+	{
+		return;
+	}
+
+	GLuint firstIndex = mesh.parts[firstPart].firstIndex;
+	GLuint indexCount = mesh.parts[lastPart].firstIndex + mesh.parts[lastPart].indexCount - firstIndex;
+	if (indexCount == 0)
+	{
+		return;
+	}
+
+	if (m_pRecordedDraws != NULL)
+	{
+		RecordMeshParts(mesh, firstPart, lastPart, m_lodModel, NULL);
+		return;
+	}
+
+	if (m_boundVAO != mesh.vao)
+	{
+		glBindVertexArray(mesh.vao);
+		m_boundVAO = mesh.vao;
+	}
+
+	glDrawElementsBaseVertex(
+		GL_TRIANGLES,
+		indexCount,
+		mesh.indexType,
+		(void*)(size_t)(mesh.indexOffset + mesh.indexSize * firstIndex),
+		mesh.baseVertex);
+}
+
+///////////////////////////////////////////////////
+//	DrawMeshInstanced()
+//
+//	Draw every part of the passed in mesh once for
+//  each instance.  The transforms, followed by the
+//  colors when there are any, are streamed into the
+//  instance buffer, which is orphaned first so the
+//  driver does not wait for the previous draw to
+//  finish reading it.  The instance attributes step
+//  once per instance and are disabled again after
+//  the draw, so the regular draws do not read them.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMeshInstanced(
+	const GLMesh& mesh,
+	const glm::mat4* pTransforms,
+	const glm::vec4* pColors,
+	GLuint nInstances)
+{
+	if ((nInstances == 0) || (mesh.nParts == 0) || (mesh.nIndices == 0))
+	{
+		return;
+	}
+
+	// while recording every instance becomes its own draw,
+	// which carries the transform and color of the instance
+	if (m_pRecordedDraws != NULL)
+	{
+		for (GLuint i = 0; i < nInstances; i++)
+		{
+			RecordMeshParts(mesh, 0, mesh.nParts - 1, pTransforms[i], (pColors != NULL) ? &pColors[i] : NULL);
+		}
+		return;
+	}
+
+	GLsizeiptr transformBytes = sizeof(glm::mat4) * nInstances;
+	GLsizeiptr colorBytes = (pColors != NULL) ? sizeof(glm::vec4) * nInstances : 0;
+
+	if (m_instanceVBO == 0)
+	{
+		glGenBuffers(1, &m_instanceVBO);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+	while (m_instanceCapacity < transformBytes + colorBytes)
+	{
+		m_instanceCapacity = (std::max)(m_instanceCapacity * 2, (GLsizeiptr)g_InstanceInitialBytes);
+	}
+	glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, transformBytes, pTransforms);
+	if (pColors != NULL)
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, transformBytes, colorBytes, pColors);
+	}
+
+	if (m_boundVAO != mesh.vao)
+	{
+		glBindVertexArray(mesh.vao);
+		m_boundVAO = mesh.vao;
+	}
+
+	// a mat4 attribute takes one location for every column
+	for (GLuint i = 0; i < 4; i++)
+	{
+		glVertexAttribPointer(g_InstanceTransformLocation + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(sizeof(glm::vec4) * i));
+		glVertexAttribDivisor(g_InstanceTransformLocation + i, 1);
+		glEnableVertexAttribArray(g_InstanceTransformLocation + i);
+	}
+	if (pColors != NULL)
+	{
+		glVertexAttribPointer(g_InstanceColorLocation, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)(size_t)transformBytes);
+		glVertexAttribDivisor(g_InstanceColorLocation, 1);
+		glEnableVertexAttribArray(g_InstanceColorLocation);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	GLuint firstIndex = mesh.parts[0].firstIndex;
+	GLuint indexCount = mesh.parts[mesh.nParts - 1].firstIndex + mesh.parts[mesh.nParts - 1].indexCount - firstIndex;
+
+	// the base vertex variant is needed for the meshes
+	// sub-allocated from the arena
+	glDrawElementsInstancedBaseVertex(
+		GL_TRIANGLES,
+		indexCount,
+		mesh.indexType,
+		(void*)(size_t)(mesh.indexOffset + mesh.indexSize * firstIndex),
+		nInstances,
+		mesh.baseVertex);
+
+	for (GLuint i = 0; i < 4; i++)
+	{
+		glDisableVertexAttribArray(g_InstanceTransformLocation + i);
+	}
+	if (pColors != NULL)
+	{
+		glDisableVertexAttribArray(g_InstanceColorLocation);
+	}
+}
+
+///////////////////////////////////////////////////
+//	RecordMeshParts()
+//
+//	Append the index range covering the parts from
+//  firstPart to lastPart of the passed in mesh to the
+//  recorded draws.  The first index of an indirect
+//  command counts indices rather than bytes, so the
+//  byte offset of the mesh in its index buffer is
+//  converted, which works because the arena keeps the
+//  meshes aligned to 4 bytes.
+///////////////////////////////////////////////////
+void ShapeMeshes::RecordMeshParts(
+	const GLMesh& mesh,
+	GLuint firstPart,
+	GLuint lastPart,
+	const glm::mat4& model,
+	const glm::vec4* pColor)
+{
+	GLuint firstIndex = mesh.parts[firstPart].firstIndex;
+	GLuint indexCount = mesh.parts[lastPart].firstIndex + mesh.parts[lastPart].indexCount - firstIndex;
+
+	RecordedDraw draw;
+	draw.vao = mesh.vao;
+	draw.indexType = mesh.indexType;
+	draw.command.count = indexCount;
+	draw.command.instanceCount = 1;
+	draw.command.firstIndex = (mesh.indexOffset / mesh.indexSize) + firstIndex;
+	draw.command.baseVertex = mesh.baseVertex;
+	draw.command.baseInstance = 0;
+	draw.model = model;
+	draw.color = (pColor != NULL) ? *pColor : glm::vec4(1.0f);
+	draw.bColor = (pColor != NULL);
+	draw.state = m_recordingState;
+
+	m_pRecordedDraws->push_back(draw);
+}
+
+glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2)
+{
+	glm::vec3 Normal(0, 0, 0);
+	float v1x = p1.x - p0.x;
+	float v1y = p1.y - p0.y;
+	float v1z = p1.z - p0.z;
+	float v2x = p2.x - p1.x;
+	float v2y = p2.y - p1.y;
+	float v2z = p2.z - p1.z;
+	Normal.x = v1y * v2z - v1z * v2y;
+	Normal.y = v1z * v2x - v1x * v2z;
+	Normal.y = v1x * v2y - v1y * v2x;
+	float len = (float)sqrt(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
+	if (len == 0)
+	{
+		//throw Exception();
+	}
+	else
+	{
+		Normal.x /= len;
+		Normal.y /= len;
+		Normal.z /= len;
+	}
+	return Normal;
+}
+
+
+
+void ShapeMeshes::SetShaderMemoryLayout()
+{
+	// The following code defines the layout of the mesh data in memory - each mesh needs
+	// to have the same memory layout so that the data is retrieved properly by the shaders
+
+	// Strides between vertex coordinates is 6 (x, y, z, r, g, b, a). A tightly packed stride is 0.
+	GLint stride = sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV);// The number of floats before each
+
+	// the compact layout keeps the float position, but stores the normal
+	// as normalized 2_10_10_10 integers and the texture coords as half floats
+	if (m_bCompactVertices == true)
+	{
+		glVertexAttribPointer(0, g_FloatsPerVertex, GL_FLOAT, GL_FALSE, m_vertexStride, 0);
+		glEnableVertexAttribArray(0);
+
+		glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, m_vertexStride, (void*)(size_t)g_CompactNormalOffset);
+		glEnableVertexAttribArray(1);
+
+		glVertexAttribPointer(2, g_FloatsPerUV, GL_HALF_FLOAT, GL_FALSE, m_vertexStride, (void*)(size_t)g_CompactUVOffset);
+		glEnableVertexAttribArray(2);
+		return;
+	}
 
 	// Create Vertex Attribute Pointers
 	glVertexAttribPointer(0, g_FloatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
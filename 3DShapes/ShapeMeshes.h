@@ -1,11 +1,11 @@
-///////////////////////////////////////////////////////////////////////////////
-// shapemeshes.h
-// ============
-// create meshes for various 3D primitives: 
-//     box, cone, cylinder, plane, prism, pyramid, sphere, tapered cylinder, torus
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 7th, 2022
+///////////////////////////////////////////////////////////////////////////////
+// shapemeshes.h
+// ============
+// create meshes for various 3D primitives: 
+//     box, cone, cylinder, plane, prism, pyramid, sphere, tapered cylinder, torus
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 7th, 2022
 ///////////////////////////////////////////////////////////////////////////////
 
 #pragma once
@@ -14,6 +14,17 @@
 
 #include <glm/glm.hpp>
 
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "MeshCache.h"
+#include "MeshData.h"
+#include "MeshGenerator.h"
+#include "MeshImporter.h"
+#include "MeshOptimizer.h"
+#include "ResourceRegistry.h"
+
 /***********************************************************
  *  ShapeMeshes
  *
@@ -23,8 +34,51 @@
 class ShapeMeshes
 {
 public:
-	// constructor
-	ShapeMeshes();
+	// constructor - when bUseArena is true every mesh is
+	// sub-allocated from one shared set of GL buffers, when
+	// bCompactVertices is true the vertices are stored with
+	// packed normals, half-float UVs and 16-bit indices
+	ShapeMeshes(bool bUseArena = false, bool bCompactVertices = false);
+
+	// the layout glMultiDrawElementsIndirect() reads its
+	// commands in
+	struct DrawElementsIndirectCommand
+	{
+		GLuint count;			// Number of indices to draw
+		GLuint instanceCount;	// Number of instances to draw
+		GLuint firstIndex;		// First index in the index buffer
+		GLint baseVertex;		// Added to every index
+		GLuint baseInstance;	// First instance for the instanced attributes
+	};
+
+	// a draw captured while recording, together with what
+	// is needed to submit it with the other recorded draws
+	struct RecordedDraw
+	{
+		GLuint vao;			// Vertex array the command reads from
+		GLenum indexType;	// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		DrawElementsIndirectCommand command;
+		glm::mat4 model;	// Model transform of the draw
+		glm::vec4 color;	// Instance color, when bColor is true
+		bool bColor;
+		GLuint state;		// Caller state set when the draw was recorded
+	};
+
+	// the shape meshes, for looking up their bounds
+	enum SHAPE_MESHES
+	{
+		MESH_BOX,
+		MESH_CONE,
+		MESH_CYLINDER,
+		MESH_PLANE,
+		MESH_PRISM,
+		MESH_PYRAMID3,
+		MESH_PYRAMID4,
+		MESH_SPHERE,
+		MESH_TAPERED_CYLINDER,
+		MESH_TORUS,
+		MESH_IMPORTED
+	};
 
 private:
 
@@ -35,35 +89,247 @@ private:
 		GLuint vbos[2];     // Handles for the vertex buffer objects
 		GLuint nVertices;	// Number of vertices for the mesh
 		GLuint nIndices;    // Number of indices for the mesh
+		GLint baseVertex;	// First vertex of the mesh in its vertex buffer
+		GLuint indexOffset;	// Byte offset of the mesh in its index buffer
+		GLenum indexType;	// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		GLuint indexSize;	// Size in bytes of one index
+		MeshPart parts[MeshData::MAX_PARTS];	// Index ranges of the mesh parts
+		GLuint nParts;		// Number of used index ranges
+		glm::vec3 boundsCenter;	// Center of the bounding sphere and box
+		float boundsRadius;	// Radius of the bounding sphere
+		glm::vec3 boundsExtent;	// Half size of the bounding box
+
+		GLMesh()
+		{
+			vao = 0;
+			vbos[0] = vbos[1] = 0;
+			nVertices = 0;
+			nIndices = 0;
+			baseVertex = 0;
+			indexOffset = 0;
+			indexType = GL_UNSIGNED_INT;
+			indexSize = sizeof(GLuint);
+			nParts = 0;
+			boundsRadius = 0.0f;
+			boundsExtent = glm::vec3(0.0f);
+		}
+	};
+
+	// the primitives that are generated with detail levels
+	enum LOD_SHAPES
+	{
+		SHAPE_CONE,
+		SHAPE_CYLINDER,
+		SHAPE_SPHERE,
+		SHAPE_TAPERED_CYLINDER,
+		SHAPE_TORUS
+	};
+
+	// maximum number of detail levels kept per primitive
+	static const GLuint MAX_LODS = 4;
+
+	// the detail levels of a tessellated primitive, from
+	// the full tessellation down to the coarsest
+	struct MeshLODs
+	{
+		GLMesh lods[MAX_LODS];
+		GLuint nLods;
+
+		MeshLODs()
+		{
+			nLods = 0;
+		}
 	};
 
 	// the available 3D shapes
 	GLMesh m_BoxMesh;
-	GLMesh m_ConeMesh;
-	GLMesh m_CylinderMesh;
+	MeshLODs m_ConeMesh;
+	MeshLODs m_CylinderMesh;
 	GLMesh m_PlaneMesh;
 	GLMesh m_PrismMesh;
 	GLMesh m_Pyramid3Mesh;
 	GLMesh m_Pyramid4Mesh;
-	GLMesh m_SphereMesh;
-	GLMesh m_TaperedCylinderMesh;
-	GLMesh m_TorusMesh;
+	MeshLODs m_SphereMesh;
+	MeshLODs m_TaperedCylinderMesh;
+
+	// stores a torus mesh together with the
+	// parameters it was generated from
+	struct TorusMesh
+	{
+		float tubeRadius;
+		GLuint mainSegments;
+		GLuint tubeSegments;
+		MeshLODs mesh;
+	};
+
+	// every loaded torus variant, in a deque so that the
+	// meshes stay in place while loading jobs write them
+	std::deque<TorusMesh> m_TorusMeshes;
+	// every mesh loaded from a file
+	std::deque<GLMesh> m_ImportedMeshes;
 
 	bool m_bMemoryLayoutDone;
 
+	// the shared buffers every mesh is sub-allocated
+	// from in arena mode
+	struct GeometryArena
+	{
+		GLuint vao;				// Handle for the shared vertex array object
+		GLuint vbo;				// Handle for the shared vertex buffer
+		GLuint ibo;				// Handle for the shared index buffer
+		GLuint vertexCount;		// Number of vertices allocated so far
+		GLuint vertexCapacity;	// Number of vertices the buffer can hold
+		GLuint indexBytes;		// Number of index bytes allocated so far
+		GLuint indexCapacity;	// Number of index bytes the buffer can hold
+
+		GeometryArena()
+		{
+			vao = vbo = ibo = 0;
+			vertexCount = vertexCapacity = 0;
+			indexBytes = indexCapacity = 0;
+		}
+	};
+
+	// mesh data in the selected vertex format, ready
+	// to be copied into GL buffers
+	struct UploadData
+	{
+		const void* vertices;	// Interleaved vertex data
+		GLsizeiptr vertexBytes;	// Size of the vertex data
+		const void* indices;	// Triangle list indices
+		GLsizeiptr indexBytes;	// Size of the index data
+		GLenum indexType;		// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		GLuint indexSize;		// Size in bytes of one index
+	};
+
+	// a mesh on its way from the generator or importer to the
+	// GPU - the CPU work can run on any thread, the upload runs
+	// on the thread owning the GL context
+	struct MeshJob
+	{
+		GLMesh* pMesh;			// Mesh receiving the uploaded data
+		std::string name;		// Name of the mesh in the log
+		uint64_t cacheKey;		// Key to add the mesh to the cache with, or 0
+		std::string filename;	// File to import, or empty to generate a shape
+		LOD_SHAPES shape;		// Parameters of the generated shape
+		GLuint segments;
+		GLuint segments2;
+		float radius;
+
+		// results of the CPU work
+		bool bLoaded;
+		MeshData data;
+		std::vector<GLubyte> packedVertices;
+		std::vector<GLushort> packedIndices;
+		UploadData upload;
+		glm::vec3 boundsCenter;
+		float boundsRadius;
+		glm::vec3 boundsExtent;
+		MeshOptimizer::CacheStats before;
+		MeshOptimizer::CacheStats after;
+
+		MeshJob()
+		{
+			pMesh = NULL;
+			cacheKey = 0;
+			shape = SHAPE_CONE;
+			segments = segments2 = 0;
+			radius = 0.0f;
+			bLoaded = false;
+			boundsRadius = 0.0f;
+			boundsExtent = glm::vec3(0.0f);
+		}
+	};
+
+	bool m_bUseArena;
+	GeometryArena m_arena;
+	// the currently bound VAO and indirect buffer, used to
+	// skip redundant binds
+	GLuint m_boundVAO;
+	GLuint m_boundIndirectBuffer;
+
+	bool m_bCompactVertices;
+	// size in bytes of one vertex in the selected format
+	GLuint m_vertexStride;
+
+	// when true the generated and imported meshes are queued
+	// until FinishLoading() instead of loaded right away
+	bool m_bDeferLoading;
+	std::deque<MeshJob> m_meshJobs;
+
+	// camera and model transform used to pick the detail level
+	bool m_bLODCameraSet;
+	glm::mat4 m_lodView;
+	glm::mat4 m_lodProjection;
+	glm::mat4 m_lodModel;
+	float m_viewportHeight;
+	// projected size in pixels below which each coarser level is
+	// used, and the fraction the size must cross it by to switch
+	float m_lodThresholds[MAX_LODS - 1];
+	float m_lodHysteresis;
+	// the level last picked for each draw id, so that the
+	// hysteresis can be applied, and the id of the next draw
+	std::vector<GLuint> m_lastLODs;
+	GLuint m_lodDrawID;
+
+	// per-instance transforms and colors of the instanced
+	// draws, refilled for every draw
+	GLuint m_instanceVBO;
+	GLsizeiptr m_instanceCapacity;
+
+	// the list the draws are appended to instead of being
+	// drawn while recording, and the caller state they get
+	std::vector<RecordedDraw>* m_pRecordedDraws;
+	GLuint m_recordingState;
+	// indirect commands of the recorded draws, refilled
+	// every frame
+	GLuint m_indirectBuffer;
+	GLsizeiptr m_indirectCapacity;
+	std::vector<DrawElementsIndirectCommand> m_indirectCommands;
+
+	// procedural generator and the reusable buffer
+	// it writes the generated geometry into
+	MeshGenerator m_generator;
+	MeshData m_meshData;
+	// generated meshes saved from previous runs
+	MeshCache m_meshCache;
+	// the meshes uploaded to the arena by the hash of their
+	// data, with where their data is, so a mesh with the same
+	// data as an uploaded one draws from the same buffers
+	ResourceRegistry m_meshContents;
+	std::vector<GLMesh> m_uploadedMeshes;
+
 public:
 	// methods for loading the shape mesh data 
 	// into memory
 	void LoadBoxMesh();
-	void LoadConeMesh();
-	void LoadCylinderMesh();
+	void LoadConeMesh(GLuint segments = 36);
+	void LoadCylinderMesh(GLuint segments = 36);
 	void LoadPlaneMesh();
 	void LoadPrismMesh();
 	void LoadPyramid3Mesh();
 	void LoadPyramid4Mesh();
-	void LoadSphereMesh();
-	void LoadTaperedCylinderMesh();
-	void LoadTorusMesh(float thickness = 0.2);
+	void LoadSphereMesh(GLuint slices = 16, GLuint stacks = 16);
+	void LoadTaperedCylinderMesh(GLuint segments = 36);
+	int LoadTorusMesh(
+		float thickness = 0.2,
+		GLuint mainSegments = 30,
+		GLuint tubeSegments = 30);
+
+	// load a mesh from an OBJ or binary glTF file, returns
+	// the number to pass to DrawImportedMesh() or -1
+	int LoadImportedMesh(const char* filename);
+
+	// methods for generating the shapes and importing the mesh
+	// files requested between them on a pool of worker threads,
+	// uploading every mesh as soon as it is ready
+	void BeginLoading();
+	void FinishLoading();
+
+	// methods for loading the generated primitives from
+	// a cache file written by a previous run
+	bool OpenMeshCache(const char* filename);
+	bool CloseMeshCache();
 
 	// methods for drawing the shape mesh in the
 	// display window
@@ -84,9 +350,106 @@ public:
 		bool bDrawTop = true,
 		bool bDrawBottom = true,
 		bool bDrawSides = true);
-	void DrawTorusMesh();
-	void DrawHalfTorusMesh();
+	void DrawTorusMesh(int variant = 0);
+	void DrawHalfTorusMesh(int variant = 0);
+	void DrawImportedMesh(int mesh);
+
+	// methods for drawing many copies of a shape mesh with
+	// one draw call, each with its own model transform and,
+	// when pColors is not NULL, its own color
+	void DrawBoxMeshInstanced(
+		const glm::mat4* pTransforms,
+		const glm::vec4* pColors,
+		GLuint nInstances);
+	void DrawConeMeshInstanced(
+		const glm::mat4* pTransforms,
+		const glm::vec4* pColors,
+		GLuint nInstances);
+	void DrawCylinderMeshInstanced(
+		const glm::mat4* pTransforms,
+		const glm::vec4* pColors,
+		GLuint nInstances);
+	void DrawPlaneMeshInstanced(
+		const glm::mat4* pTransforms,
+		const glm::vec4* pColors,
+		GLuint nInstances);
+	void DrawSphereMeshInstanced(
+		const glm::mat4* pTransforms,
+		const glm::vec4* pColors,
+		GLuint nInstances);
+	void DrawTorusMeshInstanced(
+		const glm::mat4* pTransforms,
+		const glm::vec4* pColors,
+		GLuint nInstances,
+		int variant = 0);
+	void DrawImportedMeshInstanced(
+		int mesh,
+		const glm::mat4* pTransforms,
+		const glm::vec4* pColors,
+		GLuint nInstances);
+
+	// methods for selecting the detail level of the
+	// cone, cylinder, sphere, tapered cylinder and torus
+	// draws from their projected size on the screen
+
+	// set the camera of the frame about to be drawn
+	void SetLODCamera(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		float viewportHeight);
+	// set the model transform of the next draw
+	void SetModelMatrix(const glm::mat4& model);
+	// set the id the level of the following draws is kept under
+	// from frame to frame, such as the index of the object drawn
+	void SetDrawID(GLuint drawId);
+	// set the projected diameters in pixels at which the coarser
+	// levels start, and the fraction each one must be crossed by
+	void SetLODThresholds(
+		const float* thresholds,
+		GLuint nThresholds,
+		float hysteresis);
+
+	// methods for recording the draws into a list instead of
+	// drawing them, and for submitting the recorded draws with
+	// multi-draw indirect calls
+
+	// start appending every draw to the passed in list, with
+	// instanced draws added as one draw for every instance
+	void BeginDrawRecording(std::vector<RecordedDraw>* pDraws);
+	// set the caller state given to the following draws
+	void SetDrawRecordingState(GLuint state);
+	void EndDrawRecording();
+	// upload the commands of the passed in draws, in order
+	void SetIndirectDraws(const RecordedDraw* pDraws, GLuint nDraws);
+	// draw a run of the uploaded commands that share their
+	// vertex array and index type with one call
+	void MultiDrawIndirect(
+		GLuint vao,
+		GLenum indexType,
+		GLuint firstDraw,
+		GLuint nDraws);
+
+	// get the bounding box of a loaded mesh, around every one
+	// of its detail levels, in the space of the mesh - the
+	// variant picks the torus or imported mesh, and false is
+	// returned when the mesh is not loaded
+	bool GetMeshBounds(
+		SHAPE_MESHES shape,
+		glm::vec3& center,
+		glm::vec3& extent,
+		int variant = 0) const;
 
+	// get the number of pixels one unit of the space of a model
+	// covers on the screen at the passed in sphere of the model,
+	// with the largest axis scale of the model - FLT_MAX is
+	// returned when the sphere reaches the camera
+	static float GetPixelsPerUnit(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		float viewportHeight,
+		const glm::mat4& model,
+		const glm::vec3& center,
+		float radius);
 
 private:
 
@@ -98,4 +461,87 @@ private:
 	// called to set the memory layout 
 	// template for shader data
 	void SetShaderMemoryLayout();
+
+	// called to optimize generated mesh data and
+	// create the GL buffers for it
+	void UploadMesh(
+		GLMesh& mesh,
+		MeshData& data,
+		const char* name,
+		uint64_t cacheKey = 0);
+	// called to create the GL buffers for mesh
+	// data from the cache or the generator
+	bool LoadCachedMesh(GLMesh& mesh, uint64_t cacheKey);
+	void UploadMeshData(GLMesh& mesh, const UploadData& upload);
+
+	// called to convert generated mesh data into
+	// the selected vertex format
+	void PrepareUploadData(
+		const MeshData& data,
+		std::vector<GLubyte>& packedVertices,
+		std::vector<GLushort>& packedIndices,
+		UploadData& upload) const;
+
+	// called to do the CPU work of a mesh job, from any
+	// thread, and to upload its result
+	void RunMeshJob(MeshJob& job) const;
+	void PrepareMesh(MeshJob& job, MeshData& data) const;
+	void FinishMeshJob(MeshJob& job, const MeshData& data);
+
+	// called to sub-allocate mesh data from
+	// the shared arena buffers
+	void AllocateArenaMesh(GLMesh& mesh, const UploadData& upload);
+	void ReserveArena(GLuint nVertices, GLuint indexBytes);
+	GLuint ResizeArenaBuffer(GLuint buffer, GLsizeiptr usedSize, GLsizeiptr newSize);
+
+	// called to generate the coarser detail levels of
+	// a primitive from its full tessellation
+	void LoadMeshLODs(
+		MeshLODs& chain,
+		LOD_SHAPES shape,
+		GLuint segments,
+		GLuint segments2,
+		float radius,
+		const char* name);
+	void LoadMeshLOD(
+		GLMesh& mesh,
+		LOD_SHAPES shape,
+		GLuint segments,
+		GLuint segments2,
+		float radius,
+		const char* name);
+	static void GenerateMesh(
+		MeshGenerator& generator,
+		MeshData& data,
+		LOD_SHAPES shape,
+		GLuint segments,
+		GLuint segments2,
+		float radius);
+
+	// called to pick the detail level for the next draw
+	const GLMesh& SelectLOD(const MeshLODs& chain, GLuint drawId);
+	const GLMesh& SelectInstancedLOD(
+		const MeshLODs& chain,
+		const glm::mat4* pTransforms,
+		GLuint nInstances,
+		GLuint drawId);
+	const GLMesh& SelectLODForSize(const MeshLODs& chain, float size, GLuint drawId);
+	float ProjectedSize(const GLMesh& mesh, const glm::mat4& model);
+
+	// called to draw a whole mesh or a range of its parts
+	void DrawMesh(const GLMesh& mesh);
+	void DrawMeshParts(const GLMesh& mesh, GLuint firstPart, GLuint lastPart);
+	// called to append a range of mesh parts to the recorded draws
+	void RecordMeshParts(
+		const GLMesh& mesh,
+		GLuint firstPart,
+		GLuint lastPart,
+		const glm::mat4& model,
+		const glm::vec4* pColor);
+	// called to draw every part of a mesh once per instance
+	void DrawMeshInstanced(
+		const GLMesh& mesh,
+		const glm::mat4* pTransforms,
+		const glm::vec4* pColors,
+		GLuint nInstances);
 };
\ No newline at end of file
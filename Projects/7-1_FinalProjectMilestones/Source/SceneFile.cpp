@@ -0,0 +1,519 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// load the objects of a 3D scene from a text description file, kept in
+// a compiled binary form next to it for faster loading
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+#include "MappedFile.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	const char g_SceneFileMagic[4] = { 'S', 'C', 'N', 'B' };
+	// increase when the layout of the compiled file changes
+	const uint32_t g_SceneFileVersion = 2;
+	// marks a tag that is not set in the compiled file
+	const uint32_t g_NoString = 0xFFFFFFFF;
+	// time between two checks of the text file for changes
+	const std::chrono::milliseconds g_ChangeCheckInterval(500);
+
+	// the names of the shapes in the text file, in the
+	// order of SCENE_SHAPES
+	const char* g_ShapeNames[SceneFile::SHAPE_COUNT] =
+	{
+		"box",
+		"cone",
+		"cylinder",
+		"plane",
+		"prism",
+		"pyramid3",
+		"pyramid4",
+		"sphere",
+		"halfsphere",
+		"taperedcylinder",
+		"torus",
+		"halftorus"
+	};
+
+	// append a tag to the string block of the compiled file
+	uint32_t AddString(std::vector<char>& strings, const std::string& value)
+	{
+		if (value.empty() == true)
+		{
+			return(g_NoString);
+		}
+
+		uint32_t offset = (uint32_t)strings.size();
+		strings.insert(strings.end(), value.begin(), value.end());
+		strings.push_back('\0');
+		return(offset);
+	}
+
+	// find a group by name among the passed in groups
+	int FindGroupIndex(const std::vector<SceneFile::SceneGroup>& groups, const std::string& name)
+	{
+		for (size_t i = 0; i < groups.size(); i++)
+		{
+			if (groups[i].name.compare(name) == 0)
+			{
+				return((int)i);
+			}
+		}
+		return(-1);
+	}
+
+	// read the optional "in <group>" at the end of a line,
+	// returns false when the group is not defined yet
+	bool ParseGroupReference(
+		std::istringstream& tokens,
+		const std::vector<SceneFile::SceneGroup>& groups,
+		int& group)
+	{
+		group = -1;
+
+		std::string keyword;
+		if (!(tokens >> keyword))
+		{
+			return(true);
+		}
+
+		std::string name;
+		if ((keyword.compare("in") != 0) || !(tokens >> name))
+		{
+			return(false);
+		}
+
+		group = FindGroupIndex(groups, name);
+		return(group >= 0);
+	}
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+	m_sourceTime = 0;
+	m_sourceSize = 0;
+	m_lastCheck = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for loading the scene objects.  The
+ *  compiled file is used when it was made from the current
+ *  text file, or when there is no text file at all,
+ *  otherwise the text is parsed and compiled again.  The
+ *  stamps of a text file that fails to load are kept as
+ *  well, so it is only tried again once it changes.
+ ***********************************************************/
+bool SceneFile::Load(const char* filename)
+{
+	m_filename = filename;
+	m_lastCheck = std::chrono::steady_clock::now();
+
+	uint64_t sourceTime = 0;
+	uint64_t sourceSize = 0;
+	bool bSource = GetFileStamp(filename, sourceTime, sourceSize);
+
+	std::vector<SceneGroup> groups;
+	std::vector<SceneObject> objects;
+	if (LoadCompiled(bSource, sourceTime, sourceSize, groups, objects) == true)
+	{
+		std::cout << "Loaded compiled scene:" << m_filename << ".bin, objects:" << objects.size() << std::endl;
+	}
+	else if ((bSource == true) && (ParseText(groups, objects) == true))
+	{
+		std::cout << "Loaded scene:" << m_filename << ", objects:" << objects.size() << std::endl;
+		if (WriteCompiled(sourceTime, sourceSize, groups, objects) == false)
+		{
+			std::cout << "Could not write compiled scene:" << m_filename << ".bin" << std::endl;
+		}
+	}
+	else
+	{
+		std::cout << "Could not load scene:" << m_filename << std::endl;
+		m_sourceTime = sourceTime;
+		m_sourceSize = sourceSize;
+		return(false);
+	}
+
+	m_groups.swap(groups);
+	m_objects.swap(objects);
+	m_sourceTime = sourceTime;
+	m_sourceSize = sourceSize;
+	return(true);
+}
+
+/***********************************************************
+ *  HasChanged()
+ *
+ *  This method is used for checking whether the text file
+ *  has a different size or modification time than when it
+ *  was loaded.  The file is only checked every half second
+ *  so that calling this every frame stays cheap.  The
+ *  modification time is in whole seconds, so an edit that
+ *  keeps the size and is saved within the same second as
+ *  the loaded version is missed until the next save.
+ ***********************************************************/
+bool SceneFile::HasChanged()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if ((m_filename.empty() == true) || (now - m_lastCheck < g_ChangeCheckInterval))
+	{
+		return(false);
+	}
+	m_lastCheck = now;
+
+	uint64_t sourceTime = 0;
+	uint64_t sourceSize = 0;
+	if (GetFileStamp(m_filename.c_str(), sourceTime, sourceSize) == false)
+	{
+		return(false);
+	}
+
+	return((sourceTime != m_sourceTime) || (sourceSize != m_sourceSize));
+}
+
+/***********************************************************
+ *  FindGroup()
+ *
+ *  This method is used for finding a group of the loaded
+ *  scene by name.
+ ***********************************************************/
+int SceneFile::FindGroup(const std::string& name) const
+{
+	return(FindGroupIndex(m_groups, name));
+}
+
+/***********************************************************
+ *  ParseText()
+ *
+ *  This method is used for parsing the objects of the text
+ *  file.  Lines that can not be parsed are reported and
+ *  skipped, so a typo does not lose the rest of the scene.
+ ***********************************************************/
+bool SceneFile::ParseText(
+	std::vector<SceneGroup>& groups,
+	std::vector<SceneObject>& objects) const
+{
+	std::ifstream stream(m_filename.c_str(), std::ios::in);
+	if (stream.is_open() == false)
+	{
+		return(false);
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(stream, line))
+	{
+		lineNumber++;
+
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+		{
+			line.erase(comment);
+		}
+
+		std::istringstream tokens(line);
+		std::string shapeName;
+		if (!(tokens >> shapeName))
+		{
+			continue;
+		}
+
+		if (shapeName.compare("group") == 0)
+		{
+			SceneGroup group;
+			bool bValid = (tokens >> group.name) &&
+				(tokens >> group.scale.x >> group.scale.y >> group.scale.z) &&
+				(tokens >> group.rotation.x >> group.rotation.y >> group.rotation.z) &&
+				(tokens >> group.position.x >> group.position.y >> group.position.z) &&
+				(FindGroupIndex(groups, group.name) < 0) &&
+				(ParseGroupReference(tokens, groups, group.parent) == true);
+
+			if (bValid == false)
+			{
+				std::cout << "Skipped invalid group in scene:" << m_filename << ", line:" << lineNumber << std::endl;
+				continue;
+			}
+			groups.push_back(group);
+			continue;
+		}
+
+		SceneObject object;
+		object.shape = SHAPE_COUNT;
+		for (int i = 0; i < SHAPE_COUNT; i++)
+		{
+			if (shapeName.compare(g_ShapeNames[i]) == 0)
+			{
+				object.shape = (SCENE_SHAPES)i;
+			}
+		}
+
+		std::string surface;
+		std::string material;
+		bool bValid = (object.shape != SHAPE_COUNT) &&
+			(tokens >> object.scale.x >> object.scale.y >> object.scale.z) &&
+			(tokens >> object.rotation.x >> object.rotation.y >> object.rotation.z) &&
+			(tokens >> object.position.x >> object.position.y >> object.position.z) &&
+			(tokens >> surface);
+
+		object.color = glm::vec4(1.0f);
+		if ((bValid == true) && (surface.compare("texture") == 0))
+		{
+			bValid = (tokens >> object.texture) ? true : false;
+		}
+		else if ((bValid == true) && (surface.compare("color") == 0))
+		{
+			bValid = (tokens >> object.color.r >> object.color.g >> object.color.b >> object.color.a) ? true : false;
+		}
+		else
+		{
+			bValid = false;
+		}
+
+		bValid = bValid &&
+			(tokens >> material) &&
+			(tokens >> object.UVscale.x >> object.UVscale.y) &&
+			(ParseGroupReference(tokens, groups, object.group) == true);
+
+		if (bValid == false)
+		{
+			std::cout << "Skipped invalid line in scene:" << m_filename << ", line:" << lineNumber << std::endl;
+			continue;
+		}
+
+		if (material.compare("-") != 0)
+		{
+			object.material = material;
+		}
+		objects.push_back(object);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  LoadCompiled()
+ *
+ *  This method is used for reading the groups and objects
+ *  from the compiled file.  When bCheckSource is true the
+ *  file is only used if it was compiled from a text file
+ *  with the passed in size and modification time.
+ ***********************************************************/
+bool SceneFile::LoadCompiled(
+	bool bCheckSource,
+	uint64_t sourceTime,
+	uint64_t sourceSize,
+	std::vector<SceneGroup>& groups,
+	std::vector<SceneObject>& objects) const
+{
+	std::string compiledFilename = m_filename + ".bin";
+	MappedFile file;
+	if (file.Open(compiledFilename.c_str()) == false)
+	{
+		return(false);
+	}
+
+	const unsigned char* pData = file.GetData();
+	const uint64_t fileSize = file.GetSize();
+	const Header* pHeader = (const Header*)pData;
+
+	bool bValid = (fileSize >= sizeof(Header)) &&
+		(memcmp(pHeader->magic, g_SceneFileMagic, sizeof(g_SceneFileMagic)) == 0) &&
+		(pHeader->version == g_SceneFileVersion) &&
+		(fileSize == sizeof(Header) +
+			(uint64_t)pHeader->nGroups * sizeof(GroupRecord) +
+			(uint64_t)pHeader->nObjects * sizeof(ObjectRecord) +
+			pHeader->stringBytes);
+	if ((bValid == true) && (bCheckSource == true))
+	{
+		bValid = (pHeader->sourceTime == sourceTime) && (pHeader->sourceSize == sourceSize);
+	}
+	if (bValid == false)
+	{
+		return(false);
+	}
+
+	const GroupRecord* pGroupRecords = (const GroupRecord*)(pData + sizeof(Header));
+	const ObjectRecord* pRecords = (const ObjectRecord*)(pGroupRecords + pHeader->nGroups);
+	const char* pStrings = (const char*)(pRecords + pHeader->nObjects);
+
+	// the tags must end inside the string block
+	if ((pHeader->stringBytes > 0) && (pStrings[pHeader->stringBytes - 1] != '\0'))
+	{
+		return(false);
+	}
+
+	// the parent of every group must come before it
+	groups.resize(pHeader->nGroups);
+	for (uint32_t i = 0; i < pHeader->nGroups; i++)
+	{
+		const GroupRecord& record = pGroupRecords[i];
+		SceneGroup& group = groups[i];
+
+		if ((record.name >= pHeader->stringBytes) ||
+			(record.parent < -1) || (record.parent >= (int32_t)i))
+		{
+			groups.clear();
+			return(false);
+		}
+
+		group.name = std::string(pStrings + record.name);
+		group.scale = glm::vec3(record.scale[0], record.scale[1], record.scale[2]);
+		group.rotation = glm::vec3(record.rotation[0], record.rotation[1], record.rotation[2]);
+		group.position = glm::vec3(record.position[0], record.position[1], record.position[2]);
+		group.parent = record.parent;
+	}
+
+	objects.resize(pHeader->nObjects);
+	for (uint32_t i = 0; i < pHeader->nObjects; i++)
+	{
+		const ObjectRecord& record = pRecords[i];
+		SceneObject& object = objects[i];
+
+		if ((record.shape >= SHAPE_COUNT) ||
+			((record.texture != g_NoString) && (record.texture >= pHeader->stringBytes)) ||
+			((record.material != g_NoString) && (record.material >= pHeader->stringBytes)) ||
+			(record.group < -1) || (record.group >= (int32_t)pHeader->nGroups))
+		{
+			groups.clear();
+			objects.clear();
+			return(false);
+		}
+
+		object.shape = (SCENE_SHAPES)record.shape;
+		object.scale = glm::vec3(record.scale[0], record.scale[1], record.scale[2]);
+		object.rotation = glm::vec3(record.rotation[0], record.rotation[1], record.rotation[2]);
+		object.position = glm::vec3(record.position[0], record.position[1], record.position[2]);
+		object.color = glm::vec4(record.color[0], record.color[1], record.color[2], record.color[3]);
+		object.UVscale = glm::vec2(record.UVscale[0], record.UVscale[1]);
+		object.texture = (record.texture != g_NoString) ? std::string(pStrings + record.texture) : std::string();
+		object.material = (record.material != g_NoString) ? std::string(pStrings + record.material) : std::string();
+		object.group = record.group;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteCompiled()
+ *
+ *  This method is used for writing the groups and objects
+ *  to the compiled file, stamped with the size and
+ *  modification time of the text file they were parsed
+ *  from.
+ ***********************************************************/
+bool SceneFile::WriteCompiled(
+	uint64_t sourceTime,
+	uint64_t sourceSize,
+	const std::vector<SceneGroup>& groups,
+	const std::vector<SceneObject>& objects) const
+{
+	std::vector<GroupRecord> groupRecords(groups.size());
+	std::vector<ObjectRecord> records(objects.size());
+	std::vector<char> strings;
+
+	for (size_t i = 0; i < groups.size(); i++)
+	{
+		const SceneGroup& group = groups[i];
+		GroupRecord& record = groupRecords[i];
+
+		record.name = AddString(strings, group.name);
+		for (int k = 0; k < 3; k++)
+		{
+			record.scale[k] = group.scale[k];
+			record.rotation[k] = group.rotation[k];
+			record.position[k] = group.position[k];
+		}
+		record.parent = group.parent;
+	}
+
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		const SceneObject& object = objects[i];
+		ObjectRecord& record = records[i];
+
+		record.shape = (uint32_t)object.shape;
+		for (int k = 0; k < 3; k++)
+		{
+			record.scale[k] = object.scale[k];
+			record.rotation[k] = object.rotation[k];
+			record.position[k] = object.position[k];
+		}
+		for (int k = 0; k < 4; k++)
+		{
+			record.color[k] = object.color[k];
+		}
+		record.UVscale[0] = object.UVscale.x;
+		record.UVscale[1] = object.UVscale.y;
+		record.texture = AddString(strings, object.texture);
+		record.material = AddString(strings, object.material);
+		record.group = object.group;
+	}
+
+	Header header;
+	memcpy(header.magic, g_SceneFileMagic, sizeof(g_SceneFileMagic));
+	header.version = g_SceneFileVersion;
+	header.sourceTime = sourceTime;
+	header.sourceSize = sourceSize;
+	header.nGroups = (uint32_t)groupRecords.size();
+	header.nObjects = (uint32_t)records.size();
+	header.stringBytes = (uint32_t)strings.size();
+	header.reserved = 0;
+
+	std::string compiledFilename = m_filename + ".bin";
+	std::ofstream stream(compiledFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	stream.write((const char*)&header, sizeof(header));
+	if (groupRecords.empty() == false)
+	{
+		stream.write((const char*)&groupRecords[0], groupRecords.size() * sizeof(GroupRecord));
+	}
+	if (records.empty() == false)
+	{
+		stream.write((const char*)&records[0], records.size() * sizeof(ObjectRecord));
+	}
+	if (strings.empty() == false)
+	{
+		stream.write(&strings[0], strings.size());
+	}
+
+	return(stream.good());
+}
+
+/***********************************************************
+ *  GetFileStamp()
+ *
+ *  This method is used for getting the size and the
+ *  modification time of the passed in file, returns false
+ *  when the file does not exist.
+ ***********************************************************/
+bool SceneFile::GetFileStamp(
+	const char* filename,
+	uint64_t& time,
+	uint64_t& size)
+{
+	struct stat status;
+	if (stat(filename, &status) != 0)
+	{
+		return(false);
+	}
+
+	time = (uint64_t)status.st_mtime;
+	size = (uint64_t)status.st_size;
+	return(true);
+}
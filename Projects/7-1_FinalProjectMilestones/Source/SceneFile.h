@@ -0,0 +1,175 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// load the objects of a 3D scene from a text description file, kept in
+// a compiled binary form next to it for faster loading
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class contains the code for loading a scene file.
+ *  Every line of the text file describes one object:
+ *
+ *    shape  sx sy sz  rx ry rz  px py pz  surface  material  u v
+ *
+ *  where the surface is either "texture <tag>" or
+ *  "color <r> <g> <b> <a>", the material is a material tag
+ *  or "-" for none, and "#" starts a comment.  Objects can
+ *  be put together into groups that are moved as one:
+ *
+ *    group  name  sx sy sz  rx ry rz  px py pz
+ *
+ *  and a group or an object ending with "in <group>" is
+ *  placed relative to that group, which has to be listed
+ *  before it.  After the
+ *  text is parsed it is written to a compiled file with
+ *  ".bin" appended to the name, which is loaded instead as
+ *  long as the size and modification time of the text file
+ *  it was compiled from do not change.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	// constructor
+	SceneFile();
+
+	// the shapes a scene object can be drawn with
+	enum SCENE_SHAPES
+	{
+		SHAPE_BOX,
+		SHAPE_CONE,
+		SHAPE_CYLINDER,
+		SHAPE_PLANE,
+		SHAPE_PRISM,
+		SHAPE_PYRAMID3,
+		SHAPE_PYRAMID4,
+		SHAPE_SPHERE,
+		SHAPE_HALF_SPHERE,
+		SHAPE_TAPERED_CYLINDER,
+		SHAPE_TORUS,
+		SHAPE_HALF_TORUS,
+		SHAPE_COUNT
+	};
+
+	// one object of the scene
+	struct SceneObject
+	{
+		SCENE_SHAPES shape;
+		glm::vec3 scale;
+		glm::vec3 rotation;		// degrees around the X, Y and Z axes
+		glm::vec3 position;
+		std::string texture;	// empty when drawn with the color
+		glm::vec4 color;
+		std::string material;	// empty for none
+		glm::vec2 UVscale;
+		int group;				// index of the parent group, -1 for none
+	};
+
+	// a transform shared by the groups and objects in it
+	struct SceneGroup
+	{
+		std::string name;
+		glm::vec3 scale;
+		glm::vec3 rotation;		// degrees around the X, Y and Z axes
+		glm::vec3 position;
+		int parent;				// index of the parent group, -1 for none
+	};
+
+	// load the passed in text scene file, or its compiled
+	// form when that is up to date - the objects of the
+	// previous load are kept when this fails
+	bool Load(const char* filename);
+	// check, at most twice a second, whether the text file
+	// was saved since it was loaded
+	bool HasChanged();
+
+	const std::vector<SceneObject>& GetObjects() const { return(m_objects); }
+	const std::vector<SceneGroup>& GetGroups() const { return(m_groups); }
+	// find a group by name, returns -1 when not found
+	int FindGroup(const std::string& name) const;
+
+private:
+	// the header at the start of the compiled file
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t sourceTime;	// modification time of the text file
+		uint64_t sourceSize;	// size of the text file
+		uint32_t nGroups;
+		uint32_t nObjects;
+		uint32_t stringBytes;	// size of the tag strings after the objects
+		uint32_t reserved;
+	};
+
+	// one group as stored in the compiled file, before the
+	// objects
+	struct GroupRecord
+	{
+		uint32_t name;
+		float scale[3];
+		float rotation[3];
+		float position[3];
+		int32_t parent;
+	};
+
+	// one object as stored in the compiled file, with the
+	// tags as offsets into the strings after the objects
+	struct ObjectRecord
+	{
+		uint32_t shape;
+		float scale[3];
+		float rotation[3];
+		float position[3];
+		float color[4];
+		float UVscale[2];
+		uint32_t texture;
+		uint32_t material;
+		int32_t group;
+	};
+
+	std::string m_filename;
+	std::vector<SceneGroup> m_groups;
+	std::vector<SceneObject> m_objects;
+
+	// size and modification time of the loaded text file
+	uint64_t m_sourceTime;
+	uint64_t m_sourceSize;
+	std::chrono::steady_clock::time_point m_lastCheck;
+
+	// parse the text file into the passed in groups and
+	// objects
+	bool ParseText(
+		std::vector<SceneGroup>& groups,
+		std::vector<SceneObject>& objects) const;
+	// read and write the compiled form of the groups and
+	// objects
+	bool LoadCompiled(
+		bool bCheckSource,
+		uint64_t sourceTime,
+		uint64_t sourceSize,
+		std::vector<SceneGroup>& groups,
+		std::vector<SceneObject>& objects) const;
+	bool WriteCompiled(
+		uint64_t sourceTime,
+		uint64_t sourceSize,
+		const std::vector<SceneGroup>& groups,
+		const std::vector<SceneObject>& objects) const;
+
+	// get the size and modification time of a file
+	static bool GetFileStamp(
+		const char* filename,
+		uint64_t& time,
+		uint64_t& size);
+};
@@ -16,6 +16,13 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
 // declaration of global variables
 namespace
 {
@@ -24,6 +31,113 @@ namespace
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UseInstancingName = "bUseInstancing";
+	const char* g_UseInstanceColorName = "bUseInstanceColor";
+	const char* g_MeshCacheFilename = "meshcache.bin";
+	const char* g_TextureCacheFilename = "texturecache.bin";
+	const char* g_SceneFilename = "Scenes/bookshelf.scene";
+	const char* g_UseIndirectDrawsName = "bUseIndirectDraws";
+	const char* g_FirstDrawIndexName = "firstDrawIndex";
+	const char* g_UVScaleName = "UVscale";
+	const char* g_MaterialIndexName = "materialIndex";
+	const char* g_TextureLayerName = "textureLayer";
+	const char* g_AtlasRectName = "atlasRect";
+	const char* g_AtlasMaxLodName = "atlasMaxLod";
+	// shader storage binding of the per-draw data
+	const GLuint g_DrawDataBinding = 0;
+	// starting size of the per-draw data buffer, it grows as needed
+	const GLsizeiptr g_DrawDataInitialBytes = 65536;
+	// uniform buffer binding and size of the material table,
+	// matching MAX_MATERIALS in the fragment shader
+	const GLuint g_MaterialBinding = 1;
+	const size_t g_MaxMaterials = 64;
+	// the render queue pass and shader program of the scene
+	// draws, there is only one of each so far
+	const uint32_t g_ScenePass = 0;
+	const uint32_t g_SceneProgram = 0;
+	// number of pixel buffers the texture uploads cycle
+	// through, which is also the most uploads per frame
+	const size_t g_PixelBufferCount = 4;
+	// the color of a texture that is not loaded yet
+	const unsigned char g_PlaceholderColor[4] = { 128, 128, 128, 255 };
+	// the most memory the resident texture levels take before
+	// the least recently needed large levels are dropped
+	const size_t g_TextureBudgetBytes = 256 * 1024 * 1024;
+	// a texture starts with its levels that are at most this
+	// many texels wide and high
+	const int g_TextureTailSize = 64;
+	// layers of every texture array, the arrays are created
+	// and deleted as the resident levels change
+	const int g_TextureArrayLayers = 4;
+	// the radius of the sphere around the unit cube the basic
+	// shapes fit in
+	const float g_ShapeRadius = 0.87f;
+	// the half size of the box around a shape whose mesh is
+	// not loaded, which every basic shape fits in
+	const float g_ShapeExtent = 1.0f;
+	// size of the atlas pages, and the levels the border around
+	// every image on a page keeps it apart from the others in,
+	// the border is as wide as a texel of the last of them
+	const int g_AtlasPageSize = 4096;
+	const int g_AtlasBorderLevels = 4;
+	// the level limit of textures that are not on a page
+	const float g_FullTextureMaxLod = 1000.0f;
+
+	// the OpenGL format the texture arrays of an encoded
+	// format are stored in
+	GLenum GetTextureInternalFormat(int format)
+	{
+		switch (format)
+		{
+		case TextureEncoder::FORMAT_BC1:
+			return(GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+		case TextureEncoder::FORMAT_BC3:
+			return(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+		default:
+			return(GL_RGBA8);
+		}
+	}
+
+	// the offset of a level in an encoded mip chain
+	size_t GetChainOffset(int format, int width, int height, int level)
+	{
+		size_t offset = 0;
+		for (int i = 0; i < level; i++)
+		{
+			offset += TextureEncoder::GetLevelBytes((TextureEncoder::FORMAT)format, width, height, i);
+		}
+		return(offset);
+	}
+
+	// the size of the levels of a mip chain from the passed
+	// in level down to 1x1
+	size_t GetResidentBytes(int format, int width, int height, int level)
+	{
+		return(TextureEncoder::GetChainBytes((TextureEncoder::FORMAT)format, width, height) -
+			GetChainOffset(format, width, height, level));
+	}
+
+	// the first level of a mip chain that fits in the tail size
+	int GetTailLevel(int width, int height, int nLevels)
+	{
+		int level = 0;
+		while ((level + 1 < nLevels) && ((std::max)(width >> level, height >> level) > g_TextureTailSize))
+		{
+			level++;
+		}
+		return(level);
+	}
+
+	// whether the meshes have an instanced draw for the shape
+	bool IsInstancedShape(SceneFile::SCENE_SHAPES shape)
+	{
+		return((shape == SceneFile::SHAPE_BOX) ||
+			(shape == SceneFile::SHAPE_CONE) ||
+			(shape == SceneFile::SHAPE_CYLINDER) ||
+			(shape == SceneFile::SHAPE_PLANE) ||
+			(shape == SceneFile::SHAPE_SPHERE) ||
+			(shape == SceneFile::SHAPE_TORUS));
+	}
 }
 
 /***********************************************************
@@ -34,7 +148,51 @@ namespace
 SceneManager::SceneManager(ShaderManager *pShaderManager)
 {
 	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
+	// share one set of buffers between all of the basic meshes
+	// and store them in the compact vertex format
+	m_basicMeshes = new ShapeMeshes(true, true);
+
+	// the indirect path needs the per-draw data in a shader
+	// storage buffer indexed by the draw ID in the shader
+	m_bUseIndirectDraws = (GLEW_VERSION_4_3 && GLEW_ARB_shader_draw_parameters) ? true : false;
+	m_bRecordingDraws = false;
+	m_drawDataBuffer = 0;
+	m_drawDataCapacity = 0;
+	m_materialBuffer = 0;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewportHeight = 0.0f;
+	m_pTextureWorkers = NULL;
+	m_nTextureLoads = 0;
+	m_placeholderArray = -1;
+	m_nextPixelBuffer = 0;
+	m_residentTextureBytes = 0;
+	m_textureBudget = g_TextureBudgetBytes;
+	m_textureFrame = 0;
+	m_firstObjectTransform = 0;
+	m_bSceneBVHBuilt = false;
+
+	PIXEL_BUFFER pixelBuffer;
+	pixelBuffer.buffer = 0;
+	pixelBuffer.capacity = 0;
+	pixelBuffer.fence = NULL;
+	m_pixelBuffers.assign(g_PixelBufferCount, pixelBuffer);
+
+	DRAW_STATE state;
+	state.texture = -1;
+	state.UVscale = glm::vec2(1.0f, 1.0f);
+	state.color = glm::vec4(1.0f);
+	state.material = -1;
+	m_drawStates.push_back(state);
+
+	for (int i = 0; i < SceneFile::SHAPE_COUNT; i++)
+	{
+		m_bShapeLoaded[i] = false;
+	}
+
+	// the shaders are loaded before the scene manager is
+	// created, so the uniforms can be looked up right away
+	ResolveShaderUniforms();
 }
 
 /***********************************************************
@@ -44,6 +202,12 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
  ***********************************************************/
 SceneManager::~SceneManager()
 {
+	// the workers write to this object until they stop
+	ReleaseTextureLoads();
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		delete[] m_textures[i].pChain;
+	}
 	m_pShaderManager = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
@@ -52,316 +216,2428 @@ SceneManager::~SceneManager()
 /***********************************************************
  *  CreateGLTexture()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  This method is used for registering a texture under the
+ *  passed in tag and starting to load it from its image
+ *  file.  Only the size is read from the file here, the
+ *  mip chain is loaded on the texture worker threads and
+ *  its smallest levels are uploaded by
+ *  UploadDecodedTextures() once it is done, so the texture
+ *  shows the placeholder until then.  A texture passed an
+ *  atlas name is loaded with the other images of the atlas
+ *  on a shared page once BindGLTextures() packs them.
  ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+bool SceneManager::CreateGLTexture(const char* filename, std::string tag, std::string atlas)
 {
 	int width = 0;
 	int height = 0;
 	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+	// a tag that is already registered keeps its first image
+	if (m_textureHandles.find(tag) != m_textureHandles.end())
+	{
+		std::cout << "Texture tag already loaded:" << tag << std::endl;
+		return false;
+	}
+
+	// the header is enough to place the image in a texture
+	// array before it is decoded
+	MappedFile file;
+	if ((file.Open(filename) == false) ||
+		(stbi_info_from_memory(file.GetData(), (int)file.GetSize(), &width, &height, &colorChannels) == 0))
+	{
+		std::cout << "Could not load image:" << filename << std::endl;
 
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+		// Error loading the image
+		return false;
+	}
+	file.Close();
 
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+	// register the texture and associate it with the special
+	// tag string, its array and layer are assigned when its
+	// levels are uploaded
+	const int handle = RegisterTexture(tag, width, height, (colorChannels == 2) || (colorChannels == 4));
+	m_textureHandles[tag] = handle;
 
+	if (atlas.empty() == false)
+	{
+		size_t index = 0;
+		while ((index < m_textureAtlases.size()) && (m_textureAtlases[index].name != atlas))
+		{
+			index++;
+		}
+		if (index == m_textureAtlases.size())
+		{
+			TEXTURE_ATLAS textureAtlas;
+			textureAtlas.name = atlas;
+			m_textureAtlases.push_back(textureAtlas);
+		}
+		m_textureAtlases[index].textures.push_back(handle);
+		m_textureAtlases[index].filenames.push_back(filename);
 		return true;
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	LoadGLTexture(handle, filename);
+	return true;
+}
+
+/***********************************************************
+ *  RegisterTexture()
+ *
+ *  This method is used for adding a texture of the passed
+ *  in size to the loaded textures list, without any levels
+ *  yet.  Images with transparency are stored as BC3 and
+ *  the others as BC1, or both as RGBA when the driver can
+ *  not sample compressed textures.
+ ***********************************************************/
+int SceneManager::RegisterTexture(std::string tag, int width, int height, bool bAlpha)
+{
+	TEXTURE_INFO texture;
+	texture.tag = tag;
+	texture.ID = 0;
+	texture.array = -1;
+	texture.layer = 0;
+	texture.width = width;
+	texture.height = height;
+	texture.nLevels = TextureEncoder::GetLevelCount(width, height);
+	texture.residentLevel = texture.nLevels;
+	texture.wantedLevel = GetTailLevel(width, height, texture.nLevels);
+	texture.lastNeeded = 0;
+	texture.pChain = NULL;
+	texture.atlasPage = -1;
+	texture.atlasRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	texture.sharedTexture = -1;
+	texture.bLoaded = false;
+	texture.bAlpha = bAlpha;
+	texture.format = TextureEncoder::FORMAT_RGBA8;
+	if (GLEW_EXT_texture_compression_s3tc)
+	{
+		texture.format = (texture.bAlpha == true) ? TextureEncoder::FORMAT_BC3 : TextureEncoder::FORMAT_BC1;
+	}
+
+	m_textures.push_back(texture);
+	return((int)m_textures.size() - 1);
+}
+
+/***********************************************************
+ *  LoadGLTexture()
+ *
+ *  This method is used for starting to load the mip chain
+ *  of a registered texture from its image file on a worker
+ *  thread.
+ ***********************************************************/
+void SceneManager::LoadGLTexture(int texture, std::string filename)
+{
+	StartTextureLoad();
 
-	// Error loading the image
-	return false;
+	const int format = m_textures[texture].format;
+	m_pTextureWorkers->Submit([this, texture, filename, format]()
+	{
+		TEXTURE_IMAGE image;
+		image.texture = texture;
+		image.filename = filename;
+		LoadTextureImage(image, (TextureEncoder::FORMAT)format);
+		m_decodedImages.Push(image);
+	});
 }
 
 /***********************************************************
- *  BindGLTextures()
+ *  StartTextureLoad()
  *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  This method is used for counting a texture about to be
+ *  loaded on the worker threads, which are started and
+ *  the texture cache opened for the first one.
  ***********************************************************/
-void SceneManager::BindGLTextures()
+void SceneManager::StartTextureLoad()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	if (NULL == m_pTextureWorkers)
 	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		// indicate to always flip images vertically when loaded,
+		// set before any worker decodes an image
+		stbi_set_flip_vertically_on_load(true);
+		m_pTextureWorkers = new WorkerPool();
 	}
+	if (m_textureCache.IsOpen() == false)
+	{
+		m_textureCache.Open(g_TextureCacheFilename);
+	}
+
+	m_nTextureLoads++;
 }
 
 /***********************************************************
- *  DestroyGLTextures()
+ *  BuildTextureAtlases()
  *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
+ *  This method is used for packing the images registered
+ *  for every atlas onto pages and starting to load the
+ *  pages.  Every page is a texture of its own, streamed
+ *  like any other, and the images on it are drawn from
+ *  their rectangle of the page.  Images too large for a
+ *  page are loaded on their own instead.
  ***********************************************************/
-void SceneManager::DestroyGLTextures()
+void SceneManager::BuildTextureAtlases()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	for (size_t i = 0; i < m_textureAtlases.size(); i++)
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		const TEXTURE_ATLAS& atlas = m_textureAtlases[i];
+
+		TextureAtlas packer(g_AtlasPageSize, 1 << g_AtlasBorderLevels);
+		for (size_t j = 0; j < atlas.textures.size(); j++)
+		{
+			packer.AddImage(m_textures[atlas.textures[j]].width, m_textures[atlas.textures[j]].height);
+		}
+		packer.Pack();
+
+		for (int page = 0; page < packer.GetPageCount(); page++)
+		{
+			const int width = packer.GetPageWidth(page);
+			const int height = packer.GetPageHeight(page);
+
+			// the images of other pages are left without a file,
+			// and the page has alpha when any of its images does
+			std::vector<std::string> filenames(atlas.textures.size());
+			bool bAlpha = false;
+			for (size_t j = 0; j < atlas.textures.size(); j++)
+			{
+				if (packer.GetRect((int)j).page == page)
+				{
+					filenames[j] = atlas.filenames[j];
+					bAlpha = bAlpha || m_textures[atlas.textures[j]].bAlpha;
+				}
+			}
+
+			const std::string tag = atlas.name + "#" + std::to_string(page);
+			const int handle = RegisterTexture(tag, width, height, bAlpha);
+			for (size_t j = 0; j < atlas.textures.size(); j++)
+			{
+				const TextureAtlas::Rect& rect = packer.GetRect((int)j);
+				if (rect.page == page)
+				{
+					TEXTURE_INFO& texture = m_textures[atlas.textures[j]];
+					texture.atlasPage = handle;
+					texture.atlasRect = glm::vec4(
+						(float)rect.x / width,
+						(float)rect.y / height,
+						(float)rect.width / width,
+						(float)rect.height / height);
+				}
+			}
+
+			// load the page on a worker thread
+			StartTextureLoad();
+			const int format = m_textures[handle].format;
+			m_pTextureWorkers->Submit([this, packer, page, filenames, tag, handle, format]()
+			{
+				TEXTURE_IMAGE image;
+				image.texture = handle;
+				image.filename = tag;
+				LoadAtlasPage(image, packer, page, filenames, (TextureEncoder::FORMAT)format);
+				m_decodedImages.Push(image);
+			});
+		}
+
+		for (size_t j = 0; j < atlas.textures.size(); j++)
+		{
+			if (packer.GetRect((int)j).page >= 0)
+			{
+				continue;
+			}
+
+			std::cout << "Texture too large for atlas " << atlas.name << ":" << atlas.filenames[j] << std::endl;
+			LoadGLTexture(atlas.textures[j], atlas.filenames[j]);
+		}
 	}
+
+	m_textureAtlases.clear();
 }
 
 /***********************************************************
- *  FindTextureID()
+ *  LoadTextureImage()
  *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for loading the mip chain of an
+ *  image file, from the texture cache when the file and
+ *  format are cached, or else by decoding the image
+ *  straight from the mapped file, with the channels
+ *  expanded to RGBA, and encoding every level, which is
+ *  then added to the cache.  It runs on the texture worker
+ *  threads, so it only uses the image and the cache, which
+ *  can be used from several threads.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+void SceneManager::LoadTextureImage(TEXTURE_IMAGE& image, TextureEncoder::FORMAT format)
 {
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
+	image.pData = NULL;
+	image.bytes = 0;
+	image.width = 0;
+	image.height = 0;
+	image.nLevels = 0;
+	image.colorChannels = 0;
+	image.bCached = false;
+	image.contentKey = 0;
+
+	MappedFile imageFile;
+	if (imageFile.Open(image.filename.c_str()) == false)
+	{
+		return;
+	}
 
-	while ((index < m_loadedTextures) && (bFound == false))
+	const uint64_t key = TextureCache::MakeKey(imageFile.GetData(), imageFile.GetSize(), (uint32_t)format);
+	if (FindCachedTexture(key, image) == true)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		return;
+	}
+
+	unsigned char* pixels = stbi_load_from_memory(
+		imageFile.GetData(),
+		(int)imageFile.GetSize(),
+		&image.width,
+		&image.height,
+		&image.colorChannels,
+		4);
+	if (NULL == pixels)
+	{
+		return;
+	}
+
+	EncodeTextureImage(key, pixels, format, image);
+	stbi_image_free(pixels);
+}
+
+/***********************************************************
+ *  LoadAtlasPage()
+ *
+ *  This method is used for loading the mip chain of an
+ *  atlas page, from the texture cache when the page with
+ *  the same images in the same places is cached, or else
+ *  by decoding every image of the page, copying it to its
+ *  place and encoding every level of the page.  It runs on
+ *  the texture worker threads like LoadTextureImage().
+ ***********************************************************/
+void SceneManager::LoadAtlasPage(
+	TEXTURE_IMAGE& image,
+	const TextureAtlas& atlas,
+	int page,
+	const std::vector<std::string>& filenames,
+	TextureEncoder::FORMAT format)
+{
+	image.pData = NULL;
+	image.bytes = 0;
+	image.width = atlas.GetPageWidth(page);
+	image.height = atlas.GetPageHeight(page);
+	image.nLevels = 0;
+	image.colorChannels = 0;
+	image.bCached = false;
+	image.contentKey = 0;
+
+	// the key covers the contents and the place of every
+	// image and the size of the page
+	std::vector<uint64_t> keys;
+	keys.push_back(((uint64_t)image.width << 32) | (uint64_t)image.height);
+	for (size_t i = 0; i < filenames.size(); i++)
+	{
+		if (filenames[i].empty() == true)
 		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
+			continue;
 		}
-		else
-			index++;
+
+		MappedFile imageFile;
+		if (imageFile.Open(filenames[i].c_str()) == false)
+		{
+			return;
+		}
+
+		const TextureAtlas::Rect& rect = atlas.GetRect((int)i);
+		keys.push_back(TextureCache::MakeKey(imageFile.GetData(), imageFile.GetSize(), (uint32_t)format));
+		keys.push_back(((uint64_t)rect.x << 32) | (uint64_t)rect.y);
+		keys.push_back(((uint64_t)rect.width << 32) | (uint64_t)rect.height);
+	}
+
+	const uint64_t key = TextureCache::MakeKey(&keys[0], keys.size() * sizeof(uint64_t), (uint32_t)format);
+	if (FindCachedTexture(key, image) == true)
+	{
+		return;
+	}
+
+	std::vector<unsigned char> pixels((size_t)image.width * image.height * 4, 0);
+	for (size_t i = 0; i < filenames.size(); i++)
+	{
+		if (filenames[i].empty() == true)
+		{
+			continue;
+		}
+
+		MappedFile imageFile;
+		int width = 0;
+		int height = 0;
+		int colorChannels = 0;
+		unsigned char* pImagePixels = NULL;
+		if (imageFile.Open(filenames[i].c_str()) == true)
+		{
+			pImagePixels = stbi_load_from_memory(
+				imageFile.GetData(),
+				(int)imageFile.GetSize(),
+				&width,
+				&height,
+				&colorChannels,
+				4);
+		}
+		if (NULL == pImagePixels)
+		{
+			return;
+		}
+
+		// an image that changed size since it was packed fails
+		// the page, it is packed again on the next run
+		const TextureAtlas::Rect& rect = atlas.GetRect((int)i);
+		const bool bPacked = (width == rect.width) && (height == rect.height);
+		if (bPacked == true)
+		{
+			atlas.CopyImage((int)i, pImagePixels, &pixels[0]);
+		}
+		stbi_image_free(pImagePixels);
+		if (bPacked == false)
+		{
+			return;
+		}
+
+		image.colorChannels = (std::max)(image.colorChannels, colorChannels);
+	}
+
+	EncodeTextureImage(key, &pixels[0], format, image);
+}
+
+/***********************************************************
+ *  FindCachedTexture()
+ *
+ *  This method is used for copying the mip chain with the
+ *  passed in key out of the texture cache, when it is
+ *  cached, and hashing its contents.
+ ***********************************************************/
+bool SceneManager::FindCachedTexture(uint64_t key, TEXTURE_IMAGE& image)
+{
+	TextureCache::Entry entry;
+	if (m_textureCache.FindTexture(key, entry) == false)
+	{
+		return(false);
+	}
+
+	image.width = (int)entry.width;
+	image.height = (int)entry.height;
+	image.nLevels = (int)entry.nLevels;
+	image.colorChannels = (int)entry.colorChannels;
+	image.bytes = (size_t)entry.dataBytes;
+	image.pData = new unsigned char[image.bytes];
+	memcpy(image.pData, m_textureCache.GetData(entry.dataOffset), image.bytes);
+	image.bCached = true;
+
+	const uint32_t description[] = { entry.width, entry.height, entry.format };
+	image.contentKey = ResourceRegistry::MakeKey(
+		image.pData,
+		image.bytes,
+		ResourceRegistry::MakeKey(description, sizeof(description)));
+	return(true);
+}
+
+/***********************************************************
+ *  EncodeTextureImage()
+ *
+ *  This method is used for encoding every level of the
+ *  RGBA pixels of an image of the size in the image,
+ *  adding the mip chain to the texture cache under the
+ *  passed in key and hashing its contents.  The levels are
+ *  hashed rather than the file, so identical images saved
+ *  in different files are found as well.
+ ***********************************************************/
+void SceneManager::EncodeTextureImage(
+	uint64_t key,
+	const unsigned char* pPixels,
+	TextureEncoder::FORMAT format,
+	TEXTURE_IMAGE& image)
+{
+	TextureEncoder encoder;
+	image.nLevels = TextureEncoder::GetLevelCount(image.width, image.height);
+	image.bytes = TextureEncoder::GetChainBytes(format, image.width, image.height);
+	image.pData = new unsigned char[image.bytes];
+	encoder.EncodeChain(format, pPixels, image.width, image.height, image.pData);
+
+	TextureCache::Entry entry;
+	entry.key = key;
+	entry.width = (uint32_t)image.width;
+	entry.height = (uint32_t)image.height;
+	entry.format = (uint32_t)format;
+	entry.nLevels = (uint32_t)image.nLevels;
+	entry.colorChannels = (uint32_t)image.colorChannels;
+	entry.reserved = 0;
+	entry.dataOffset = 0;
+	entry.dataBytes = image.bytes;
+	m_textureCache.AddTexture(entry, image.pData);
+
+	const uint32_t description[] = { entry.width, entry.height, entry.format };
+	image.contentKey = ResourceRegistry::MakeKey(
+		image.pData,
+		image.bytes,
+		ResourceRegistry::MakeKey(description, sizeof(description)));
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for packing the atlases registered
+ *  so far, creating the placeholder layer and binding the
+ *  texture arrays to texture units.  Each array is bound to
+ *  its own unit while there are enough units, so drawing
+ *  only selects a layer.  The textures get their layers
+ *  when their levels are uploaded, in arrays of the size of
+ *  their first resident level.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	BuildTextureAtlases();
+
+	// the placeholder is a single layer the textures are
+	// drawn with until their image is uploaded
+	if (m_placeholderArray < 0)
+	{
+		TEXTURE_ARRAY placeholder;
+		placeholder.width = 1;
+		placeholder.height = 1;
+		placeholder.format = TextureEncoder::FORMAT_RGBA8;
+		placeholder.nLevels = 1;
+		placeholder.nLayers = 1;
+		glGenTextures(1, &placeholder.ID);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, placeholder.ID);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, g_PlaceholderColor);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		m_placeholderArray = (int)m_textureArrays.size();
+		m_textureArrays.push_back(placeholder);
 	}
 
-	return(textureID);
+	// the units are bound again from scratch, since the
+	// binding of the current unit was changed above
+	GLint maxUnits = 16;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxUnits);
+	m_boundTextureArrays.assign((size_t)(std::max)(maxUnits, 1), -1);
+	for (size_t array = 0; (array < m_textureArrays.size()) && (array < m_boundTextureArrays.size()); array++)
+	{
+		BindTextureArray((int)array);
+	}
 }
 
 /***********************************************************
- *  FindTextureSlot()
+ *  UploadDecodedTextures()
  *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for uploading the smallest levels of
+ *  the mip chains the worker threads finished loading, the
+ *  ones that fit in the tail size, and keeping the chains
+ *  for streaming in the larger levels.  A mip chain the
+ *  same as that of a texture already uploaded is dropped,
+ *  and the texture is drawn from the levels of the other
+ *  one.  The uploads stop for the frame when no pixel
+ *  buffer is free.  The texture cache is written once the
+ *  last texture is loaded.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+void SceneManager::UploadDecodedTextures()
 {
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
+	TEXTURE_IMAGE image;
+	while (m_decodedImages.TryPop(image) == true)
+	{
+		m_pendingImages.push_back(image);
+	}
+	// the levels are uploaded once BindGLTextures() has set
+	// up the texture units
+	if ((m_pendingImages.empty() == true) || (m_boundTextureArrays.empty() == true))
+	{
+		return;
+	}
 
-	while ((index < m_loadedTextures) && (bFound == false))
+	size_t nUploaded = 0;
+	while (nUploaded < m_pendingImages.size())
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		TEXTURE_IMAGE& pending = m_pendingImages[nUploaded];
+
+		if ((pending.texture >= (int)m_textures.size()) || (pending.pData == NULL))
 		{
-			textureSlot = index;
-			bFound = true;
+			std::cout << "Could not load image:" << pending.filename << std::endl;
 		}
 		else
-			index++;
+		{
+			TEXTURE_INFO& texture = m_textures[pending.texture];
+			if ((pending.width != texture.width) || (pending.height != texture.height) ||
+				(pending.nLevels != texture.nLevels))
+			{
+				std::cout << "Image changed size while loading:" << pending.filename << std::endl;
+			}
+			else if (m_textureContents.FindResource(pending.contentKey) >= 0)
+			{
+				texture.sharedTexture = m_textureContents.FindResource(pending.contentKey);
+				m_textureContents.AddDuplicate(pending.bytes);
+				std::cout << "Texture " << texture.tag << " shares the image of " << m_textures[texture.sharedTexture].tag << ", "
+					<< m_textureContents.GetDuplicateCount() << " shared textures saved " << m_textureContents.GetSavedBytes() << " bytes" << std::endl;
+			}
+			else
+			{
+				// the texture takes over the mip chain
+				texture.pChain = pending.pData;
+				if (SetTextureLevel(pending.texture, GetTailLevel(texture.width, texture.height, texture.nLevels)) == false)
+				{
+					texture.pChain = NULL;
+					break;
+				}
+				pending.pData = NULL;
+				m_textureContents.AddResource(pending.contentKey, pending.texture);
+
+				std::cout << "Successfully loaded image:" << pending.filename << ", width:" << pending.width << ", height:" << pending.height << ", channels:" << pending.colorChannels << ((pending.bCached == true) ? " (cached)" : "") << std::endl;
+			}
+		}
+
+		// free the image data from local memory
+		delete[] pending.pData;
+		nUploaded++;
+		m_nTextureLoads--;
 	}
+	m_pendingImages.erase(m_pendingImages.begin(), m_pendingImages.begin() + nUploaded);
 
-	return(textureSlot);
+	// no worker uses the cache any more
+	if ((m_nTextureLoads == 0) && (m_textureCache.IsOpen() == true))
+	{
+		m_textureCache.Close();
+	}
 }
 
 /***********************************************************
- *  FindMaterial()
+ *  UpdateTextureStreaming()
  *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
+ *  This method is used for picking the first mip level
+ *  every texture needs from the size its draws cover on
+ *  the screen, and moving the loaded textures to those
+ *  levels.  The resident levels stay within the texture
+ *  budget: when a texture needs more than fits, the
+ *  textures holding larger levels than they need drop
+ *  them, the ones whose levels were needed least recently
+ *  first, and when that is not enough the texture gets the
+ *  largest levels that fit.  The textures missing the most
+ *  levels are streamed in first, and the moves stop for
+ *  the frame when no pixel buffer is free.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+void SceneManager::UpdateTextureStreaming()
 {
-	if (m_objectMaterials.size() == 0)
+	m_textureFrame++;
+
+	// textures that are not drawn only need their tail
+	for (size_t i = 0; i < m_textures.size(); i++)
 	{
-		return(false);
+		TEXTURE_INFO& texture = m_textures[i];
+		texture.wantedLevel = GetTailLevel(texture.width, texture.height, texture.nLevels);
+	}
+	for (size_t i = 0; i < m_sceneDraws.size(); i++)
+	{
+		const SCENE_DRAW& draw = m_sceneDraws[i];
+		if (draw.texture < 0)
+		{
+			continue;
+		}
+
+		// an image on an atlas page streams the levels of the
+		// page, which are as large as its own, and a texture
+		// sharing the levels of another one streams those
+		const TEXTURE_INFO& image = m_textures[draw.texture];
+		TEXTURE_INFO& texture = m_textures[GetTextureSource(draw.texture)];
+		for (GLuint j = 0; j < draw.nTransforms; j++)
+		{
+			texture.wantedLevel = (std::min)(
+				texture.wantedLevel,
+				GetWantedTextureLevel(image, draw.UVscale, m_sceneTransforms.GetMatrix(draw.firstTransform + j)));
+		}
 	}
 
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
+	// the textures needing larger levels than they hold, and
+	// the ones holding larger levels than they need
+	std::vector<int> needed;
+	std::vector<int> unneeded;
+	for (int i = 0; i < (int)m_textures.size(); i++)
 	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		TEXTURE_INFO& texture = m_textures[i];
+		if (NULL == texture.pChain)
+		{
+			continue;
+		}
+
+		if (texture.wantedLevel <= texture.residentLevel)
 		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
+			texture.lastNeeded = m_textureFrame;
+			if (texture.wantedLevel < texture.residentLevel)
+			{
+				needed.push_back(i);
+			}
 		}
 		else
 		{
-			index++;
+			unneeded.push_back(i);
+		}
+	}
+	std::sort(needed.begin(), needed.end(), [this](int a, int b)
+	{
+		return((m_textures[a].residentLevel - m_textures[a].wantedLevel) >
+			(m_textures[b].residentLevel - m_textures[b].wantedLevel));
+	});
+	std::sort(unneeded.begin(), unneeded.end(), [this](int a, int b)
+	{
+		return(m_textures[a].lastNeeded < m_textures[b].lastNeeded);
+	});
+
+	// a lowered budget drops levels before any are added
+	size_t nDropped = 0;
+	while ((m_residentTextureBytes > m_textureBudget) && (nDropped < unneeded.size()))
+	{
+		if (SetTextureLevel(unneeded[nDropped], m_textures[unneeded[nDropped]].wantedLevel) == false)
+		{
+			return;
 		}
+		nDropped++;
 	}
 
-	return(true);
+	for (size_t i = 0; i < needed.size(); i++)
+	{
+		const TEXTURE_INFO& texture = m_textures[needed[i]];
+		const size_t residentBytes = GetResidentBytes(texture.format, texture.width, texture.height, texture.residentLevel);
+
+		while ((m_residentTextureBytes - residentBytes +
+			GetResidentBytes(texture.format, texture.width, texture.height, texture.wantedLevel) > m_textureBudget) &&
+			(nDropped < unneeded.size()))
+		{
+			if (SetTextureLevel(unneeded[nDropped], m_textures[unneeded[nDropped]].wantedLevel) == false)
+			{
+				return;
+			}
+			nDropped++;
+		}
+
+		int level = texture.wantedLevel;
+		while ((level < texture.residentLevel) &&
+			(m_residentTextureBytes - residentBytes + GetResidentBytes(texture.format, texture.width, texture.height, level) > m_textureBudget))
+		{
+			level++;
+		}
+		if (SetTextureLevel(needed[i], level) == false)
+		{
+			return;
+		}
+	}
 }
 
 /***********************************************************
- *  SetTransformations()
+ *  GetWantedTextureLevel()
  *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
+ *  This method is used for getting the first mip level a
+ *  texture needs for one draw, the one with about a texel
+ *  per pixel across the size the shape covers on the
+ *  screen, measured the same way as for the detail levels
+ *  of the meshes.  Every level is needed before the camera
+ *  is set.
  ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
+int SceneManager::GetWantedTextureLevel(
+	const TEXTURE_INFO& texture,
+	const glm::vec2& UVscale,
+	const glm::mat4& model)
 {
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
+	if (m_viewportHeight <= 0.0f)
+	{
+		return(0);
+	}
 
-	if (NULL != m_pShaderManager)
+	// the basic shapes are one unit across, so the pixels of
+	// a unit are the pixels the shape covers
+	float pixels = ShapeMeshes::GetPixelsPerUnit(
+		m_viewMatrix,
+		m_projectionMatrix,
+		m_viewportHeight,
+		model,
+		glm::vec3(0.0f),
+		g_ShapeRadius);
+	if (pixels == FLT_MAX)
+	{
+		return(0);
+	}
+
+	// the texture repeats UVscale times across the shape
+	float texels = (std::max)(texture.width * fabsf(UVscale.x), texture.height * fabsf(UVscale.y));
+
+	int level = 0;
+	while ((level + 1 < texture.nLevels) && (texels * 0.5f >= pixels))
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+		texels *= 0.5f;
+		level++;
 	}
+
+	return(level);
 }
 
 /***********************************************************
- *  SetShaderColor()
+ *  SetTextureLevel()
  *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
+ *  This method is used for moving a texture to a layer
+ *  holding its levels from the passed in level down to
+ *  1x1, in an array of the size of that level, which
+ *  streams in larger levels or drops them.  The levels are
+ *  uploaded from the mip chain the texture keeps, and
+ *  false is returned without changing the texture while no
+ *  pixel buffer is free.
  ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
+bool SceneManager::SetTextureLevel(int handle, int level)
 {
-	// variables for this method
-	glm::vec4 currentColor;
+	TEXTURE_INFO& texture = m_textures[handle];
+	if ((NULL == texture.pChain) || (level == texture.residentLevel))
+	{
+		return(true);
+	}
+	if (AcquirePixelBuffer() == false)
+	{
+		return(false);
+	}
 
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
+	int layer = 0;
+	int array = AllocateTextureLayer(
+		(std::max)(texture.width >> level, 1),
+		(std::max)(texture.height >> level, 1),
+		texture.format,
+		layer);
+	if (UploadTextureLevels(texture, level, array, layer) == false)
+	{
+		ReleaseTextureLayer(array, layer);
+		return(false);
+	}
 
-	if (NULL != m_pShaderManager)
+	// the old layer is only released once the levels are
+	// copied, so the texture is never without one
+	if (texture.array >= 0)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		ReleaseTextureLayer(texture.array, texture.layer);
+		m_residentTextureBytes -= GetResidentBytes(texture.format, texture.width, texture.height, texture.residentLevel);
 	}
+	m_residentTextureBytes += GetResidentBytes(texture.format, texture.width, texture.height, level);
+
+	texture.array = array;
+	texture.layer = layer;
+	texture.ID = m_textureArrays[array].ID;
+	texture.residentLevel = level;
+	texture.bLoaded = true;
+	return(true);
 }
 
 /***********************************************************
- *  SetShaderTexture()
+ *  AcquirePixelBuffer()
  *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
+ *  This method is used for checking that the next pixel
+ *  buffer of the ring can be written, which is once the
+ *  fence of the last upload read from it has passed.  It
+ *  never waits for the fence.
  ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
+bool SceneManager::AcquirePixelBuffer()
 {
-	if (NULL != m_pShaderManager)
+	PIXEL_BUFFER& pixelBuffer = m_pixelBuffers[m_nextPixelBuffer];
+	if (pixelBuffer.fence != NULL)
+	{
+		GLenum status = glClientWaitSync(pixelBuffer.fence, 0, 0);
+		if ((status != GL_ALREADY_SIGNALED) && (status != GL_CONDITION_SATISFIED))
+		{
+			return(false);
+		}
+		glDeleteSync(pixelBuffer.fence);
+		pixelBuffer.fence = NULL;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  UploadTextureLevels()
+ *
+ *  This method is used for copying the levels of a mip
+ *  chain from the passed in level on into the next pixel
+ *  buffer of the ring, which AcquirePixelBuffer() found
+ *  free, and from there into every level of a texture
+ *  array layer.  A fence marks when the buffer can be
+ *  written again.
+ ***********************************************************/
+bool SceneManager::UploadTextureLevels(
+	const TEXTURE_INFO& texture,
+	int level,
+	int array,
+	int layer)
+{
+	PIXEL_BUFFER& pixelBuffer = m_pixelBuffers[m_nextPixelBuffer];
+	const TextureEncoder::FORMAT format = (TextureEncoder::FORMAT)texture.format;
+	const size_t firstOffset = GetChainOffset(format, texture.width, texture.height, level);
+	const GLsizeiptr bytes = (GLsizeiptr)GetResidentBytes(format, texture.width, texture.height, level);
+	bool bUploaded = false;
+
+	if (pixelBuffer.buffer == 0)
+	{
+		glGenBuffers(1, &pixelBuffer.buffer);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer.buffer);
+	if (pixelBuffer.capacity < bytes)
+	{
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+		pixelBuffer.capacity = bytes;
+	}
+
+	void* pMapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (NULL != pMapped)
+	{
+		memcpy(pMapped, texture.pChain + firstOffset, bytes);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+		// the array is bound on its own unit, so the bindings
+		// of the other units are left as they are
+		glActiveTexture(GL_TEXTURE0 + BindTextureArray(array));
+
+		// level 0 of the array is the passed in level
+		size_t offset = 0;
+		for (int i = 0; level + i < texture.nLevels; i++)
+		{
+			const GLsizei levelWidth = (std::max)(texture.width >> (level + i), 1);
+			const GLsizei levelHeight = (std::max)(texture.height >> (level + i), 1);
+			const size_t levelBytes = TextureEncoder::GetLevelBytes(format, texture.width, texture.height, level + i);
+
+			if (format == TextureEncoder::FORMAT_RGBA8)
+			{
+				glTexSubImage3D(
+					GL_TEXTURE_2D_ARRAY,
+					i,
+					0, 0, layer,
+					levelWidth, levelHeight, 1,
+					GL_RGBA,
+					GL_UNSIGNED_BYTE,
+					(const void*)offset);
+			}
+			else
+			{
+				glCompressedTexSubImage3D(
+					GL_TEXTURE_2D_ARRAY,
+					i,
+					0, 0, layer,
+					levelWidth, levelHeight, 1,
+					GetTextureInternalFormat(format),
+					(GLsizei)levelBytes,
+					(const void*)offset);
+			}
+			offset += levelBytes;
+		}
+		pixelBuffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		bUploaded = true;
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	m_nextPixelBuffer = (m_nextPixelBuffer + 1) % m_pixelBuffers.size();
+	return(bUploaded);
+}
+
+/***********************************************************
+ *  BindTextureArray()
+ *
+ *  This method is used for getting the texture unit of a
+ *  texture array, which is bound to the unit if it is not
+ *  bound already.  Only scenes with more arrays than units
+ *  ever need to bind an array again.
+ ***********************************************************/
+int SceneManager::BindTextureArray(int array)
+{
+	if ((array < 0) || (array >= (int)m_textureArrays.size()) || (m_boundTextureArrays.empty() == true) ||
+		(m_textureArrays[array].ID == 0))
+	{
+		return(0);
+	}
+
+	int unit = array % (int)m_boundTextureArrays.size();
+	if (m_boundTextureArrays[unit] != array)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureArrays[array].ID);
+		m_boundTextureArrays[unit] = array;
+	}
+
+	return(unit);
+}
+
+/***********************************************************
+ *  AllocateTextureLayer()
+ *
+ *  This method is used for getting a free layer of a
+ *  texture array of the passed in size and format.  When
+ *  every array of the size is full another one is created,
+ *  with room for the full mip chain of the size, in the
+ *  slot of a deleted array when there is one.
+ ***********************************************************/
+int SceneManager::AllocateTextureLayer(
+	int width,
+	int height,
+	int format,
+	int& layer)
+{
+	for (size_t array = 0; array < m_textureArrays.size(); array++)
+	{
+		TEXTURE_ARRAY& textureArray = m_textureArrays[array];
+		if ((textureArray.ID != 0) &&
+			(textureArray.width == width) &&
+			(textureArray.height == height) &&
+			(textureArray.format == format) &&
+			(textureArray.freeLayers.empty() == false))
+		{
+			layer = textureArray.freeLayers.back();
+			textureArray.freeLayers.pop_back();
+			return((int)array);
+		}
+	}
+
+	size_t array = 0;
+	while ((array < m_textureArrays.size()) && (m_textureArrays[array].ID != 0))
+	{
+		array++;
+	}
+	if (array == m_textureArrays.size())
+	{
+		m_textureArrays.push_back(TEXTURE_ARRAY());
+	}
+
+	TEXTURE_ARRAY& textureArray = m_textureArrays[array];
+	textureArray.width = width;
+	textureArray.height = height;
+	textureArray.format = format;
+	textureArray.nLevels = TextureEncoder::GetLevelCount(width, height);
+	textureArray.nLayers = g_TextureArrayLayers;
+	textureArray.freeLayers.clear();
+	for (int i = textureArray.nLayers - 1; i > 0; i--)
+	{
+		textureArray.freeLayers.push_back(i);
+	}
+	layer = 0;
+
+	glGenTextures(1, &textureArray.ID);
+	glActiveTexture(GL_TEXTURE0 + BindTextureArray((int)array));
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters, the mip levels are
+	// uploaded with the images
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glTexStorage3D(
+		GL_TEXTURE_2D_ARRAY,
+		textureArray.nLevels,
+		GetTextureInternalFormat(textureArray.format),
+		textureArray.width,
+		textureArray.height,
+		textureArray.nLayers);
+
+	return((int)array);
+}
+
+/***********************************************************
+ *  ReleaseTextureLayer()
+ *
+ *  This method is used for giving a layer back to its
+ *  texture array, which is deleted to free its memory once
+ *  none of its layers are used.
+ ***********************************************************/
+void SceneManager::ReleaseTextureLayer(int array, int layer)
+{
+	TEXTURE_ARRAY& textureArray = m_textureArrays[array];
+	textureArray.freeLayers.push_back(layer);
+	if ((int)textureArray.freeLayers.size() < textureArray.nLayers)
+	{
+		return;
+	}
+
+	// deleting the array also unbinds it from its unit
+	glDeleteTextures(1, &textureArray.ID);
+	textureArray.ID = 0;
+	textureArray.freeLayers.clear();
+	for (size_t unit = 0; unit < m_boundTextureArrays.size(); unit++)
+	{
+		if (m_boundTextureArrays[unit] == array)
+		{
+			m_boundTextureArrays[unit] = -1;
+		}
+	}
+}
+
+/***********************************************************
+ *  ReleaseTextureLoads()
+ *
+ *  This method is used for waiting for the images still
+ *  being loaded, stopping the texture worker threads,
+ *  freeing the loaded images not uploaded yet and writing
+ *  the texture cache.
+ ***********************************************************/
+void SceneManager::ReleaseTextureLoads()
+{
+	delete m_pTextureWorkers;
+	m_pTextureWorkers = NULL;
+
+	TEXTURE_IMAGE image;
+	while (m_decodedImages.TryPop(image) == true)
+	{
+		m_pendingImages.push_back(image);
+	}
+	for (size_t i = 0; i < m_pendingImages.size(); i++)
+	{
+		delete[] m_pendingImages[i].pData;
+	}
+	m_pendingImages.clear();
+	m_nTextureLoads = 0;
+
+	if (m_textureCache.IsOpen() == true)
+	{
+		m_textureCache.Close();
+	}
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory of all the
+ *  texture arrays and pixel buffers, and the mip chains
+ *  kept for streaming, after the images still being loaded
+ *  are released.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	ReleaseTextureLoads();
+
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		delete[] m_textures[i].pChain;
+	}
+	for (size_t i = 0; i < m_textureArrays.size(); i++)
+	{
+		if (m_textureArrays[i].ID != 0)
+		{
+			glDeleteTextures(1, &m_textureArrays[i].ID);
+		}
+	}
+	for (size_t i = 0; i < m_pixelBuffers.size(); i++)
+	{
+		if (m_pixelBuffers[i].fence != NULL)
+		{
+			glDeleteSync(m_pixelBuffers[i].fence);
+		}
+		glDeleteBuffers(1, &m_pixelBuffers[i].buffer);
+		m_pixelBuffers[i].buffer = 0;
+		m_pixelBuffers[i].capacity = 0;
+		m_pixelBuffers[i].fence = NULL;
+	}
+
+	m_textures.clear();
+	m_textureHandles.clear();
+	m_textureContents.Clear();
+	m_textureArrays.clear();
+	m_boundTextureArrays.clear();
+	m_placeholderArray = -1;
+	m_residentTextureBytes = 0;
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting the ID of the texture
+ *  array holding the previously loaded texture bitmap
+ *  associated with the passed in tag, or the texture it is
+ *  drawn from.
+ ***********************************************************/
+int SceneManager::FindTextureID(std::string tag)
+{
+	int texture = FindTexture(tag);
+	if (texture < 0)
+	{
+		return(-1);
+	}
+
+	return((int)m_textures[GetTextureSource(texture)].ID);
+}
+
+/***********************************************************
+ *  FindTexture()
+ *
+ *  This method is used for getting the handle of the
+ *  previously loaded texture bitmap associated with the
+ *  passed in tag, or -1 when there is none.  The handle is
+ *  the index in the loaded textures list.
+ ***********************************************************/
+int SceneManager::FindTexture(std::string tag)
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_textureHandles.find(tag);
+	if (found == m_textureHandles.end())
+	{
+		return(-1);
+	}
+
+	return(found->second);
+}
+
+/***********************************************************
+ *  GetTextureSource()
+ *
+ *  This method is used for getting the handle of the
+ *  texture holding the levels a valid texture handle is
+ *  drawn from, which is the atlas page of an image on a
+ *  page, or the texture an identical texture shares.
+ ***********************************************************/
+int SceneManager::GetTextureSource(int texture)
+{
+	if (m_textures[texture].atlasPage >= 0)
+	{
+		texture = m_textures[texture].atlasPage;
+	}
+	if (m_textures[texture].sharedTexture >= 0)
+	{
+		texture = m_textures[texture].sharedTexture;
+	}
+
+	return(texture);
+}
+
+/***********************************************************
+ *  GetTextureArray()
+ *
+ *  This method is used for getting the index of the texture
+ *  array a texture is drawn from, which is the placeholder
+ *  until its image is uploaded, or -1 when the handle is -1
+ *  or the textures are not bound yet.  Images on an atlas
+ *  page are drawn from the array of the page, and shared
+ *  textures from that of the texture they share.
+ ***********************************************************/
+int SceneManager::GetTextureArray(int texture)
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()))
+	{
+		return(-1);
+	}
+	texture = GetTextureSource(texture);
+
+	if (m_textures[texture].bLoaded == false)
+	{
+		return(m_placeholderArray);
+	}
+
+	return(m_textures[texture].array);
+}
+
+/***********************************************************
+ *  GetTextureLayer()
+ *
+ *  This method is used for getting the layer a texture is
+ *  drawn from in the array GetTextureArray() returns.
+ ***********************************************************/
+int SceneManager::GetTextureLayer(int texture)
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()))
+	{
+		return(0);
+	}
+	texture = GetTextureSource(texture);
+	if (m_textures[texture].bLoaded == false)
+	{
+		return(0);
+	}
+
+	return(m_textures[texture].layer);
+}
+
+/***********************************************************
+ *  GetTextureRect()
+ *
+ *  This method is used for getting the offset and size of
+ *  the rectangle of its layer a texture is drawn from,
+ *  which is the whole layer unless it is on an atlas page.
+ ***********************************************************/
+glm::vec4 SceneManager::GetTextureRect(int texture)
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()))
+	{
+		return(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+	}
+
+	return(m_textures[texture].atlasRect);
+}
+
+/***********************************************************
+ *  GetTextureMaxLod()
+ *
+ *  This method is used for getting the last level of its
+ *  texture array a texture may be drawn from.  Images on an
+ *  atlas page stop at the last level their border keeps
+ *  apart from the other images, counted from the first
+ *  resident level of the page.
+ ***********************************************************/
+float SceneManager::GetTextureMaxLod(int texture)
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()) || (m_textures[texture].atlasPage < 0))
+	{
+		return(g_FullTextureMaxLod);
+	}
+
+	const TEXTURE_INFO& page = m_textures[GetTextureSource(texture)];
+	return((float)(std::max)(g_AtlasBorderLevels - page.residentLevel, 0));
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index in the defined
+ *  materials list of the material associated with the passed
+ *  in tag, or -1 when there is none.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(std::string tag)
+{
+	for (int index = 0; index < (int)m_objectMaterials.size(); index++)
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			return(index);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  UploadMaterials()
+ *
+ *  This method is used for copying the defined materials
+ *  into the material table uniform buffer, where the shader
+ *  reads them by their index in the materials list.  The
+ *  table has a fixed size, materials past it are drawn
+ *  without a material.
+ ***********************************************************/
+void SceneManager::UploadMaterials()
+{
+	if (m_objectMaterials.size() > g_MaxMaterials)
+	{
+		std::cout << "Only the first " << g_MaxMaterials << " of " << m_objectMaterials.size() << " materials are used" << std::endl;
+	}
+
+	MATERIAL_DATA unused;
+	unused.ambientColor = glm::vec4(0.0f);
+	unused.diffuseColor = glm::vec4(0.0f);
+	unused.specularColor = glm::vec4(0.0f);
+	std::vector<MATERIAL_DATA> materials(g_MaxMaterials, unused);
+
+	for (size_t i = 0; (i < m_objectMaterials.size()) && (i < g_MaxMaterials); i++)
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[i];
+		materials[i].ambientColor = glm::vec4(material.ambientColor, material.ambientStrength);
+		materials[i].diffuseColor = glm::vec4(material.diffuseColor, 0.0f);
+		materials[i].specularColor = glm::vec4(material.specularColor, material.shininess);
+	}
+
+	if (m_materialBuffer == 0)
+	{
+		glGenBuffers(1, &m_materialBuffer);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, m_materialBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(MATERIAL_DATA) * materials.size(), materials.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, g_MaterialBinding, m_materialBuffer);
+}
+
+/***********************************************************
+ *  ResolveShaderUniforms()
+ *
+ *  This method is used for looking up the handles of the
+ *  uniforms that are set for every draw.
+ ***********************************************************/
+void SceneManager::ResolveShaderUniforms()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	m_uniforms.model = m_pShaderManager->getUniform<glm::mat4>(g_ModelName);
+	m_uniforms.objectColor = m_pShaderManager->getUniform<glm::vec4>(g_ColorValueName);
+	m_uniforms.objectTexture = m_pShaderManager->getUniform<int>(g_TextureValueName);
+	m_uniforms.bUseTexture = m_pShaderManager->getUniform<bool>(g_UseTextureName);
+	m_uniforms.UVscale = m_pShaderManager->getUniform<glm::vec2>(g_UVScaleName);
+	m_uniforms.bUseInstancing = m_pShaderManager->getUniform<bool>(g_UseInstancingName);
+	m_uniforms.bUseInstanceColor = m_pShaderManager->getUniform<bool>(g_UseInstanceColorName);
+	m_uniforms.bUseIndirectDraws = m_pShaderManager->getUniform<bool>(g_UseIndirectDrawsName);
+	m_uniforms.firstDrawIndex = m_pShaderManager->getUniform<int>(g_FirstDrawIndexName);
+	m_uniforms.materialIndex = m_pShaderManager->getUniform<int>(g_MaterialIndexName);
+	m_uniforms.textureLayer = m_pShaderManager->getUniform<int>(g_TextureLayerName);
+	m_uniforms.atlasRect = m_pShaderManager->getUniform<glm::vec4>(g_AtlasRectName);
+	m_uniforms.atlasMaxLod = m_pShaderManager->getUniform<float>(g_AtlasMaxLodName);
+}
+
+/***********************************************************
+ *  BeginSceneBatch()
+ *
+ *  This method is used for starting to record the draws of
+ *  the frame, together with the shader state each one is
+ *  drawn with, when the multi-draw indirect path is used.
+ *  The state left by the previous frame carries over.
+ ***********************************************************/
+void SceneManager::BeginSceneBatch()
+{
+	if (m_bUseIndirectDraws == false)
+	{
+		return;
+	}
+
+	DRAW_STATE state = m_drawStates.back();
+	m_drawStates.clear();
+	m_drawStates.push_back(state);
+	m_recordedDraws.clear();
+
+	m_basicMeshes->BeginDrawRecording(&m_recordedDraws);
+	m_bRecordingDraws = true;
+}
+
+/***********************************************************
+ *  PushDrawState()
+ *
+ *  This method is used for adding a changed shader state
+ *  that the following recorded draws are drawn with.
+ ***********************************************************/
+void SceneManager::PushDrawState(const DRAW_STATE& state)
+{
+	m_drawStates.push_back(state);
+	m_basicMeshes->SetDrawRecordingState((GLuint)(m_drawStates.size() - 1));
+}
+
+/***********************************************************
+ *  IsTransparentDraw()
+ *
+ *  This method is used for checking whether a draw has to
+ *  be blended, which is when its texture has an alpha
+ *  channel or its color is not fully opaque.
+ ***********************************************************/
+bool SceneManager::IsTransparentDraw(int texture, const glm::vec4& color)
+{
+	if (GetTextureArray(texture) >= 0)
+	{
+		return(m_textures[texture].bAlpha);
+	}
+
+	return(color.a < 1.0f);
+}
+
+/***********************************************************
+ *  GetViewDepth()
+ *
+ *  This method is used for getting the distance in front of
+ *  the camera of the origin of the passed in model
+ *  transform, used for sorting the draws by depth.
+ ***********************************************************/
+float SceneManager::GetViewDepth(const glm::mat4& model)
+{
+	return(-(m_viewMatrix * model[3]).z);
+}
+
+/***********************************************************
+ *  GetSortID()
+ *
+ *  This method is used for getting the id a texture array
+ *  or mesh is put in the sort keys with, which is its
+ *  position in the passed in list of the values met while
+ *  filling the render queue.  The fields of the keys only
+ *  have a few bits, and the ids stay small however large
+ *  the vertex array names grow, so different values do not
+ *  share an id.
+ ***********************************************************/
+uint32_t SceneManager::GetSortID(std::vector<uint32_t>& values, uint32_t value)
+{
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		if (values[i] == value)
+		{
+			return((uint32_t)i);
+		}
+	}
+
+	values.push_back(value);
+	return((uint32_t)(values.size() - 1));
+}
+
+/***********************************************************
+ *  SubmitSceneBatch()
+ *
+ *  This method is used for drawing the draws recorded this
+ *  frame.  They are put in the render queue and sorted into
+ *  runs sharing the vertex array, index type and texture
+ *  array, with the transparent draws last, their per-draw
+ *  data is uploaded to a shader storage buffer in the same
+ *  order, and every run is drawn with one multi-draw
+ *  indirect call.
+ ***********************************************************/
+void SceneManager::SubmitSceneBatch()
+{
+	if (m_bRecordingDraws == false)
+	{
+		return;
+	}
+
+	m_basicMeshes->EndDrawRecording();
+	m_bRecordingDraws = false;
+
+	GLuint nDraws = (GLuint)m_recordedDraws.size();
+	if (nDraws == 0)
+	{
+		return;
+	}
+
+	// the mesh of a draw is its vertex array and index type,
+	// which decide the runs together with the texture array -
+	// the layer in the array is part of the per-draw data
+	m_drawQueue.Clear();
+	m_sortTextureArrays.clear();
+	m_sortMeshes.clear();
+	for (GLuint i = 0; i < nDraws; i++)
+	{
+		const ShapeMeshes::RecordedDraw& draw = m_recordedDraws[i];
+		const DRAW_STATE& state = m_drawStates[draw.state];
+		const glm::vec4& color = (draw.bColor == true) ? draw.color : state.color;
+
+		m_drawQueue.Push(
+			RenderQueue::MakeKey(
+				g_ScenePass,
+				IsTransparentDraw(state.texture, color),
+				g_SceneProgram,
+				GetSortID(m_sortTextureArrays, (uint32_t)(GetTextureArray(state.texture) + 1)),
+				(uint32_t)(state.material + 1),
+				GetSortID(m_sortMeshes, (draw.vao << 1) | ((draw.indexType == GL_UNSIGNED_INT) ? 1 : 0)),
+				GetViewDepth(draw.model)),
+			i);
+	}
+	m_drawQueue.Sort();
+
+	m_sortedDraws.resize(nDraws);
+	m_drawData.resize(nDraws);
+	for (GLuint i = 0; i < nDraws; i++)
+	{
+		const ShapeMeshes::RecordedDraw& draw = m_recordedDraws[m_drawQueue.GetItem(i)];
+		const DRAW_STATE& state = m_drawStates[draw.state];
+		DRAW_DATA& data = m_drawData[i];
+
+		m_sortedDraws[i] = draw;
+		data.model = draw.model;
+		data.color = (draw.bColor == true) ? draw.color : state.color;
+		data.UVscale = state.UVscale;
+		data.material = state.material;
+		data.textureLayer = GetTextureLayer(state.texture);
+		data.atlasRect = GetTextureRect(state.texture);
+		data.atlasMaxLod = GetTextureMaxLod(state.texture);
+		data.padding[0] = 0.0f;
+		data.padding[1] = 0.0f;
+		data.padding[2] = 0.0f;
+	}
+
+	// the whole buffer is only written when the number of draws
+	// changes, otherwise only the runs of draws whose data differs
+	// from the last upload are, so an unchanged scene uploads nothing.
+	// Nothing else uses shader storage, so the buffer stays bound to
+	// the generic and indexed binding points from its creation
+	if (m_drawDataBuffer == 0)
+	{
+		glGenBuffers(1, &m_drawDataBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_DrawDataBinding, m_drawDataBuffer);
+	}
+	GLsizeiptr dataBytes = sizeof(DRAW_DATA) * nDraws;
+	if (m_uploadedDrawData.size() != nDraws)
+	{
+		while (m_drawDataCapacity < dataBytes)
+		{
+			m_drawDataCapacity = (std::max)(m_drawDataCapacity * 2, g_DrawDataInitialBytes);
+		}
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_drawDataCapacity, NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, dataBytes, m_drawData.data());
+		m_uploadedDrawData = m_drawData;
+	}
+	else
+	{
+		GLuint changed = 0;
+		while (changed < nDraws)
+		{
+			if (memcmp(&m_drawData[changed], &m_uploadedDrawData[changed], sizeof(DRAW_DATA)) == 0)
+			{
+				changed++;
+				continue;
+			}
+
+			GLuint end = changed + 1;
+			while ((end < nDraws) && (memcmp(&m_drawData[end], &m_uploadedDrawData[end], sizeof(DRAW_DATA)) != 0))
+			{
+				end++;
+			}
+			glBufferSubData(
+				GL_SHADER_STORAGE_BUFFER,
+				sizeof(DRAW_DATA) * changed,
+				sizeof(DRAW_DATA) * (end - changed),
+				&m_drawData[changed]);
+			std::copy(m_drawData.begin() + changed, m_drawData.begin() + end, m_uploadedDrawData.begin() + changed);
+			changed = end;
+		}
+	}
+
+	m_basicMeshes->SetIndirectDraws(m_sortedDraws.data(), nDraws);
+
+	m_pShaderManager->setBoolValue(m_uniforms.bUseInstancing, false);
+	m_pShaderManager->setBoolValue(m_uniforms.bUseInstanceColor, false);
+	m_pShaderManager->setBoolValue(m_uniforms.bUseIndirectDraws, true);
+
+	GLuint first = 0;
+	while (first < nDraws)
+	{
+		const ShapeMeshes::RecordedDraw& firstDraw = m_sortedDraws[first];
+		int textureArray = GetTextureArray(m_drawStates[firstDraw.state].texture);
+
+		GLuint last = first + 1;
+		while ((last < nDraws) &&
+			(m_sortedDraws[last].vao == firstDraw.vao) &&
+			(m_sortedDraws[last].indexType == firstDraw.indexType) &&
+			(GetTextureArray(m_drawStates[m_sortedDraws[last].state].texture) == textureArray))
+		{
+			last++;
+		}
+
+		if (textureArray >= 0)
+		{
+			m_pShaderManager->setBoolValue(m_uniforms.bUseTexture, true);
+			m_pShaderManager->setSampler2DValue(m_uniforms.objectTexture, BindTextureArray(textureArray));
+		}
+		else
+		{
+			m_pShaderManager->setBoolValue(m_uniforms.bUseTexture, false);
+		}
+		m_pShaderManager->setIntValue(m_uniforms.firstDrawIndex, (int)first);
+
+		m_basicMeshes->MultiDrawIndirect(
+			firstDraw.vao,
+			firstDraw.indexType,
+			first,
+			last - first);
+
+		first = last;
+	}
+
+	m_pShaderManager->setBoolValue(m_uniforms.bUseIndirectDraws, false);
+}
+
+/***********************************************************
+ *  CalculateTransformation()
+ *
+ *  This method is used for calculating the model transform
+ *  from the passed in transformation values.
+ ***********************************************************/
+glm::mat4 SceneManager::CalculateTransformation(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// the closed form is the same as multiplying the translation,
+	// the X, Y and Z rotations and the scale
+	return(TransformCache::Compose(
+		scaleXYZ,
+		glm::vec3(XrotationDegrees, YrotationDegrees, ZrotationDegrees),
+		positionXYZ));
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	SetModelTransform(CalculateTransformation(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ));
+}
+
+/***********************************************************
+ *  SetModelTransform()
+ *
+ *  This method is used for setting the transform buffer
+ *  to an already calculated model transform.
+ ***********************************************************/
+void SceneManager::SetModelTransform(const glm::mat4& modelView)
+{
+	// recorded draws carry their transform in the per-draw data
+	if ((NULL != m_pShaderManager) && (m_bRecordingDraws == false))
+	{
+		m_pShaderManager->setMat4Value(m_uniforms.model, modelView);
+	}
+
+	// the meshes use the transform to pick their detail level
+	m_basicMeshes->SetModelMatrix(modelView);
+}
+
+/***********************************************************
+ *  SetViewCamera()
+ *
+ *  This method is used for passing the camera of the frame
+ *  about to be rendered to the meshes, which use it to pick
+ *  the detail level of every draw, to the render queues
+ *  for sorting the draws by depth, and to the texture
+ *  streaming for picking the mip levels the draws need
+ ***********************************************************/
+void SceneManager::SetViewCamera(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	float viewportHeight)
+{
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+	m_viewportHeight = viewportHeight;
+	m_basicMeshes->SetLODCamera(view, projection, viewportHeight);
+}
+
+/***********************************************************
+ *  SetTextureBudget()
+ *
+ *  This method is used for setting the most memory the
+ *  resident texture levels may take.  When it is lowered,
+ *  the levels that no longer fit are dropped over the next
+ *  frames.
+ ***********************************************************/
+void SceneManager::SetTextureBudget(size_t bytes)
+{
+	m_textureBudget = bytes;
+}
+
+/***********************************************************
+ *  SetShaderInstancing()
+ *
+ *  This method is used for switching the shader between the
+ *  model transform and color uniforms and the per-instance
+ *  transforms and colors of the instanced draws.
+ ***********************************************************/
+void SceneManager::SetShaderInstancing(
+	bool bUseInstancing,
+	bool bUseInstanceColor)
+{
+	// recorded instanced draws are split into one draw per instance
+	if ((NULL != m_pShaderManager) && (m_bRecordingDraws == false))
+	{
+		m_pShaderManager->setBoolValue(m_uniforms.bUseInstancing, bUseInstancing);
+		m_pShaderManager->setBoolValue(m_uniforms.bUseInstanceColor, bUseInstanceColor);
+	}
+}
+
+/***********************************************************
+ *  DrawBoxMeshInstanced()
+ *
+ *  This method is used for drawing one copy of the box mesh
+ *  for every passed in transform with a single draw call.
+ ***********************************************************/
+void SceneManager::DrawBoxMeshInstanced(
+	const std::vector<glm::mat4>& transforms,
+	const std::vector<glm::vec4>& colors)
+{
+	bool bColors = (colors.size() == transforms.size());
+
+	SetShaderInstancing(true, bColors);
+	m_basicMeshes->DrawBoxMeshInstanced(
+		transforms.data(),
+		bColors ? colors.data() : NULL,
+		(GLuint)transforms.size());
+	SetShaderInstancing(false, false);
+}
+
+/***********************************************************
+ *  DrawCylinderMeshInstanced()
+ *
+ *  This method is used for drawing one copy of the cylinder
+ *  mesh for every passed in transform with a single draw call.
+ ***********************************************************/
+void SceneManager::DrawCylinderMeshInstanced(
+	const std::vector<glm::mat4>& transforms,
+	const std::vector<glm::vec4>& colors)
+{
+	bool bColors = (colors.size() == transforms.size());
+
+	SetShaderInstancing(true, bColors);
+	m_basicMeshes->DrawCylinderMeshInstanced(
+		transforms.data(),
+		bColors ? colors.data() : NULL,
+		(GLuint)transforms.size());
+	SetShaderInstancing(false, false);
+}
+
+/***********************************************************
+ *  DrawPlaneMeshInstanced()
+ *
+ *  This method is used for drawing one copy of the plane mesh
+ *  for every passed in transform with a single draw call.
+ ***********************************************************/
+void SceneManager::DrawPlaneMeshInstanced(
+	const std::vector<glm::mat4>& transforms,
+	const std::vector<glm::vec4>& colors)
+{
+	bool bColors = (colors.size() == transforms.size());
+
+	SetShaderInstancing(true, bColors);
+	m_basicMeshes->DrawPlaneMeshInstanced(
+		transforms.data(),
+		bColors ? colors.data() : NULL,
+		(GLuint)transforms.size());
+	SetShaderInstancing(false, false);
+}
+
+/***********************************************************
+ *  DrawSphereMeshInstanced()
+ *
+ *  This method is used for drawing one copy of the sphere
+ *  mesh for every passed in transform with a single draw call.
+ ***********************************************************/
+void SceneManager::DrawSphereMeshInstanced(
+	const std::vector<glm::mat4>& transforms,
+	const std::vector<glm::vec4>& colors)
+{
+	bool bColors = (colors.size() == transforms.size());
+
+	SetShaderInstancing(true, bColors);
+	m_basicMeshes->DrawSphereMeshInstanced(
+		transforms.data(),
+		bColors ? colors.data() : NULL,
+		(GLuint)transforms.size());
+	SetShaderInstancing(false, false);
+}
+
+/***********************************************************
+ *  DrawTorusMeshInstanced()
+ *
+ *  This method is used for drawing one copy of the torus mesh
+ *  for every passed in transform with a single draw call.
+ ***********************************************************/
+void SceneManager::DrawTorusMeshInstanced(
+	const std::vector<glm::mat4>& transforms,
+	const std::vector<glm::vec4>& colors)
+{
+	bool bColors = (colors.size() == transforms.size());
+
+	SetShaderInstancing(true, bColors);
+	m_basicMeshes->DrawTorusMeshInstanced(
+		transforms.data(),
+		bColors ? colors.data() : NULL,
+		(GLuint)transforms.size());
+	SetShaderInstancing(false, false);
+}
+
+/***********************************************************
+ *  SetSceneObjectTransform()
+ *
+ *  This method is used for moving an object of the scene
+ *  file, its matrix is recalculated before the next frame
+ ***********************************************************/
+void SceneManager::SetSceneObjectTransform(
+	size_t object,
+	glm::vec3 scaleXYZ,
+	glm::vec3 rotationDegreesXYZ,
+	glm::vec3 positionXYZ)
+{
+	// the transforms of the groups come before the objects
+	size_t index = m_sceneFile.GetGroups().size() + object;
+	m_sceneTransforms.Set(index, scaleXYZ, rotationDegreesXYZ, positionXYZ);
+}
+
+/***********************************************************
+ *  SetSceneGroupTransform()
+ *
+ *  This method is used for moving a group of the scene file
+ *  together with everything in it, only the matrices of
+ *  the group's own subtree are recalculated
+ ***********************************************************/
+void SceneManager::SetSceneGroupTransform(
+	std::string groupName,
+	glm::vec3 scaleXYZ,
+	glm::vec3 rotationDegreesXYZ,
+	glm::vec3 positionXYZ)
+{
+	int group = m_sceneFile.FindGroup(groupName);
+	if (group >= 0)
+	{
+		m_sceneTransforms.Set((size_t)group, scaleXYZ, rotationDegreesXYZ, positionXYZ);
+	}
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	if (m_bRecordingDraws == true)
+	{
+		DRAW_STATE state = m_drawStates.back();
+		state.texture = -1;
+		state.color = currentColor;
+		PushDrawState(state);
+		return;
+	}
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setBoolValue(m_uniforms.bUseTexture, false);
+		m_pShaderManager->setVec4Value(m_uniforms.objectColor, currentColor);
+	}
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in tag into the shader.
+ *  Draws that are made often should resolve the tag once
+ *  and pass the handle instead.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	std::string textureTag)
+{
+	SetShaderTexture(FindTexture(textureTag));
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture with the
+ *  passed in handle into the shader, which selects the
+ *  unit of its texture array, its layer in the array and
+ *  its rectangle of the layer.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	int texture)
+{
+	if (m_bRecordingDraws == true)
+	{
+		DRAW_STATE state = m_drawStates.back();
+		state.texture = texture;
+		PushDrawState(state);
+		return;
+	}
+
+	if (NULL != m_pShaderManager)
+	{
+		// a texture that is not loaded is drawn with the color
+		int textureArray = GetTextureArray(texture);
+		m_pShaderManager->setBoolValue(m_uniforms.bUseTexture, textureArray >= 0);
+		if (textureArray >= 0)
+		{
+			m_pShaderManager->setSampler2DValue(m_uniforms.objectTexture, BindTextureArray(textureArray));
+			m_pShaderManager->setIntValue(m_uniforms.textureLayer, GetTextureLayer(texture));
+			m_pShaderManager->setVec4Value(m_uniforms.atlasRect, GetTextureRect(texture));
+			m_pShaderManager->setFloatValue(m_uniforms.atlasMaxLod, GetTextureMaxLod(texture));
+		}
+	}
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	if (m_bRecordingDraws == true)
+	{
+		DRAW_STATE state = m_drawStates.back();
+		state.UVscale = glm::vec2(u, v);
+		PushDrawState(state);
+		return;
+	}
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setVec2Value(m_uniforms.UVscale, glm::vec2(u, v));
+	}
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material associated
+ *  with the passed in tag into the shader, an unknown tag
+ *  draws without a material.  Draws that are made often
+ *  should resolve the tag once and pass the index instead.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	std::string materialTag)
+{
+	SetShaderMaterial(FindMaterialIndex(materialTag));
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the index of a material
+ *  in the material table into the shader, the shader reads
+ *  the material values from the table.  An index of -1
+ *  draws without a material, callers that keep the current
+ *  material do not call this.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	int material)
+{
+	if (material < 0)
+	{
+		material = -1;
+	}
+
+	if (m_bRecordingDraws == true)
+	{
+		DRAW_STATE state = m_drawStates.back();
+		state.material = material;
+		PushDrawState(state);
+		return;
+	}
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setIntValue(m_uniforms.materialIndex, material);
+	}
+}
+
+/***********************************************************
+ *  LoadSceneMeshes()
+ *
+ *  This method is used for loading the mesh of every shape
+ *  used in the scene file that is not loaded yet.  The half
+ *  sphere and half torus are drawn from the full meshes.
+ ***********************************************************/
+void SceneManager::LoadSceneMeshes()
+{
+	const std::vector<SceneFile::SceneObject>& objects = m_sceneFile.GetObjects();
+
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		SceneFile::SCENE_SHAPES shape = objects[i].shape;
+		if (shape == SceneFile::SHAPE_HALF_SPHERE)
+		{
+			shape = SceneFile::SHAPE_SPHERE;
+		}
+		else if (shape == SceneFile::SHAPE_HALF_TORUS)
+		{
+			shape = SceneFile::SHAPE_TORUS;
+		}
+
+		if (m_bShapeLoaded[shape] == true)
+		{
+			continue;
+		}
+		m_bShapeLoaded[shape] = true;
+
+		switch (shape)
+		{
+		case SceneFile::SHAPE_BOX:
+			m_basicMeshes->LoadBoxMesh();
+			break;
+		case SceneFile::SHAPE_CONE:
+			m_basicMeshes->LoadConeMesh();
+			break;
+		case SceneFile::SHAPE_CYLINDER:
+			m_basicMeshes->LoadCylinderMesh();
+			break;
+		case SceneFile::SHAPE_PLANE:
+			m_basicMeshes->LoadPlaneMesh();
+			break;
+		case SceneFile::SHAPE_PRISM:
+			m_basicMeshes->LoadPrismMesh();
+			break;
+		case SceneFile::SHAPE_PYRAMID3:
+			m_basicMeshes->LoadPyramid3Mesh();
+			break;
+		case SceneFile::SHAPE_PYRAMID4:
+			m_basicMeshes->LoadPyramid4Mesh();
+			break;
+		case SceneFile::SHAPE_SPHERE:
+			m_basicMeshes->LoadSphereMesh();
+			break;
+		case SceneFile::SHAPE_TAPERED_CYLINDER:
+			m_basicMeshes->LoadTaperedCylinderMesh();
+			break;
+		case SceneFile::SHAPE_TORUS:
+			m_basicMeshes->LoadTorusMesh();
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildSceneDraws()
+ *
+ *  This method is used for building the draw list from the
+ *  scene file objects.  The model transforms are kept in the
+ *  transform cache, the groups first and then the objects,
+ *  which only recalculates the matrices of moved groups and
+ *  objects, and runs of objects that only differ in their
+ *  transforms become one instanced draw when the shape has
+ *  an instanced draw.  The box around the shape of every
+ *  object is kept for culling the draws, and the hierarchy
+ *  of the boxes is built again on the next frame.
+ ***********************************************************/
+void SceneManager::BuildSceneDraws()
+{
+	const std::vector<SceneFile::SceneGroup>& groups = m_sceneFile.GetGroups();
+	const std::vector<SceneFile::SceneObject>& objects = m_sceneFile.GetObjects();
+
+	m_sceneDraws.clear();
+	m_sceneTransforms.Clear();
+	m_objectBounds.resize(objects.size());
+	m_firstObjectTransform = groups.size();
+	m_bSceneBVHBuilt = false;
+
+	// a group always comes after its parent in the scene
+	// file, so the parents stay ahead of their children
+	for (size_t i = 0; i < groups.size(); i++)
+	{
+		const SceneFile::SceneGroup& group = groups[i];
+		m_sceneTransforms.Add(
+			group.scale,
+			group.rotation,
+			group.position,
+			(group.parent >= 0) ? (size_t)group.parent : TransformCache::NoParent);
+	}
+
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		const SceneFile::SceneObject& object = objects[i];
+
+		m_sceneTransforms.Add(
+			object.scale,
+			object.rotation,
+			object.position,
+			(object.group >= 0) ? (size_t)object.group : TransformCache::NoParent);
+		GetShapeBounds(object.shape, m_objectBounds[i]);
+
+		// the texture and material tags are resolved to their
+		// handles here, so drawing only passes the handles
+		int texture = -1;
+		if (object.texture.empty() == false)
+		{
+			texture = FindTexture(object.texture);
+			if (texture < 0)
+			{
+				std::cout << "Unknown texture in scene:" << object.texture << std::endl;
+			}
+		}
+		int material = -1;
+		if (object.material.empty() == false)
+		{
+			material = FindMaterialIndex(object.material);
+			if (material < 0)
+			{
+				std::cout << "Unknown material in scene:" << object.material << std::endl;
+			}
+		}
+
+		if (m_sceneDraws.empty() == false)
+		{
+			SCENE_DRAW& last = m_sceneDraws.back();
+			if ((last.shape == object.shape) &&
+				(IsInstancedShape(object.shape) == true) &&
+				(last.texture == texture) &&
+				(last.material == material) &&
+				((texture >= 0) || (last.color == object.color)) &&
+				(last.UVscale == object.UVscale))
+			{
+				last.nTransforms++;
+				continue;
+			}
+		}
+
+		SCENE_DRAW draw;
+		draw.shape = object.shape;
+		draw.firstTransform = (GLuint)(m_sceneTransforms.GetCount() - 1);
+		draw.nTransforms = 1;
+		draw.object = (GLuint)i;
+		draw.texture = texture;
+		draw.color = object.color;
+		draw.material = material;
+		draw.UVscale = object.UVscale;
+		m_sceneDraws.push_back(draw);
+	}
+}
+
+/***********************************************************
+ *  GetShapeBounds()
+ *
+ *  This method is used for getting the box around the mesh
+ *  a scene shape is drawn with, from the bounds of the
+ *  loaded mesh.  The half sphere and half torus get the
+ *  boxes of the full meshes they are drawn from.
+ ***********************************************************/
+void SceneManager::GetShapeBounds(SceneFile::SCENE_SHAPES shape, SceneBVH::Box& box)
+{
+	ShapeMeshes::SHAPE_MESHES mesh = ShapeMeshes::MESH_BOX;
+	switch (shape)
+	{
+	case SceneFile::SHAPE_CONE:
+		mesh = ShapeMeshes::MESH_CONE;
+		break;
+	case SceneFile::SHAPE_CYLINDER:
+		mesh = ShapeMeshes::MESH_CYLINDER;
+		break;
+	case SceneFile::SHAPE_PLANE:
+		mesh = ShapeMeshes::MESH_PLANE;
+		break;
+	case SceneFile::SHAPE_PRISM:
+		mesh = ShapeMeshes::MESH_PRISM;
+		break;
+	case SceneFile::SHAPE_PYRAMID3:
+		mesh = ShapeMeshes::MESH_PYRAMID3;
+		break;
+	case SceneFile::SHAPE_PYRAMID4:
+		mesh = ShapeMeshes::MESH_PYRAMID4;
+		break;
+	case SceneFile::SHAPE_SPHERE:
+	case SceneFile::SHAPE_HALF_SPHERE:
+		mesh = ShapeMeshes::MESH_SPHERE;
+		break;
+	case SceneFile::SHAPE_TAPERED_CYLINDER:
+		mesh = ShapeMeshes::MESH_TAPERED_CYLINDER;
+		break;
+	case SceneFile::SHAPE_TORUS:
+	case SceneFile::SHAPE_HALF_TORUS:
+		mesh = ShapeMeshes::MESH_TORUS;
+		break;
+	default:
+		break;
+	}
+
+	glm::vec3 center(0.0f);
+	glm::vec3 extent(g_ShapeExtent);
+	m_basicMeshes->GetMeshBounds(mesh, center, extent);
+	box.minimum = center - extent;
+	box.maximum = center + extent;
+}
+
+/***********************************************************
+ *  UpdateSceneBounds()
+ *
+ *  This method is used for building the hierarchy of the
+ *  world boxes of the scene objects once their matrices
+ *  are first calculated, and afterwards moving the boxes of
+ *  the objects whose matrices changed since the last frame
+ *  and refitting the nodes above them.
+ ***********************************************************/
+void SceneManager::UpdateSceneBounds()
+{
+	if (m_bSceneBVHBuilt == false)
+	{
+		std::vector<SceneBVH::Box> boxes(m_objectBounds.size());
+		for (size_t i = 0; i < boxes.size(); i++)
+		{
+			boxes[i] = SceneBVH::Transform(m_objectBounds[i], m_sceneTransforms.GetMatrix(m_firstObjectTransform + i));
+		}
+		m_sceneBVH.Build(boxes);
+		m_bSceneBVHBuilt = true;
+		return;
+	}
+
+	// the groups that moved are followed by their objects
+	const std::vector<size_t>& moved = m_sceneTransforms.GetMoved();
+	for (size_t i = 0; i < moved.size(); i++)
+	{
+		if (moved[i] < m_firstObjectTransform)
+		{
+			continue;
+		}
+
+		const size_t object = moved[i] - m_firstObjectTransform;
+		m_sceneBVH.SetBounds(
+			(uint32_t)object,
+			SceneBVH::Transform(m_objectBounds[object], m_sceneTransforms.GetMatrix(moved[i])));
+	}
+	m_sceneBVH.Refit();
+}
+
+/***********************************************************
+ *  CullSceneDraws()
+ *
+ *  This method is used for finding the objects inside the
+ *  view frustum of the camera set by SetViewCamera(), and
+ *  keeping the runs of every draw that draw them.  A draw
+ *  of many objects is split into the runs of its objects in
+ *  view, each drawn with its own call and keeping its
+ *  detail level under its own first object.  Every draw is
+ *  kept until the camera is set.
+ ***********************************************************/
+void SceneManager::CullSceneDraws()
+{
+	if (m_viewportHeight <= 0.0f)
+	{
+		m_visibleDraws = m_sceneDraws;
+		return;
+	}
+
+	m_visibleObjects.clear();
+	m_sceneBVH.Cull(m_projectionMatrix * m_viewMatrix, m_visibleObjects);
+	m_bObjectVisible.assign(m_objectBounds.size(), 0);
+	for (size_t i = 0; i < m_visibleObjects.size(); i++)
+	{
+		m_bObjectVisible[m_visibleObjects[i]] = 1;
+	}
+
+	m_visibleDraws.clear();
+	for (size_t i = 0; i < m_sceneDraws.size(); i++)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+		const SCENE_DRAW& draw = m_sceneDraws[i];
+		const size_t firstObject = draw.object;
 
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+		GLuint end = 0;
+		while (end < draw.nTransforms)
+		{
+			GLuint start = end;
+			while ((start < draw.nTransforms) && (m_bObjectVisible[firstObject + start] == 0))
+			{
+				start++;
+			}
+			end = start;
+			while ((end < draw.nTransforms) && (m_bObjectVisible[firstObject + end] != 0))
+			{
+				end++;
+			}
+
+			if (end > start)
+			{
+				SCENE_DRAW run = draw;
+				run.firstTransform = draw.firstTransform + start;
+				run.nTransforms = end - start;
+				run.object = draw.object + start;
+				m_visibleDraws.push_back(run);
+			}
+		}
 	}
 }
 
 /***********************************************************
- *  SetTextureUVScale()
+ *  DrawSceneShape()
  *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
+ *  This method is used for drawing one copy of a scene
+ *  shape with the current transform.  The draw id keeps
+ *  the detail level of the draw from frame to frame.
  ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
+void SceneManager::DrawSceneShape(SceneFile::SCENE_SHAPES shape, GLuint drawId)
 {
-	if (NULL != m_pShaderManager)
+	m_basicMeshes->SetDrawID(drawId);
+
+	switch (shape)
 	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+	case SceneFile::SHAPE_BOX:
+		m_basicMeshes->DrawBoxMesh();
+		break;
+	case SceneFile::SHAPE_CONE:
+		m_basicMeshes->DrawConeMesh();
+		break;
+	case SceneFile::SHAPE_CYLINDER:
+		m_basicMeshes->DrawCylinderMesh();
+		break;
+	case SceneFile::SHAPE_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case SceneFile::SHAPE_PRISM:
+		m_basicMeshes->DrawPrismMesh();
+		break;
+	case SceneFile::SHAPE_PYRAMID3:
+		m_basicMeshes->DrawPyramid3Mesh();
+		break;
+	case SceneFile::SHAPE_PYRAMID4:
+		m_basicMeshes->DrawPyramid4Mesh();
+		break;
+	case SceneFile::SHAPE_SPHERE:
+		m_basicMeshes->DrawSphereMesh();
+		break;
+	case SceneFile::SHAPE_HALF_SPHERE:
+		m_basicMeshes->DrawHalfSphereMesh();
+		break;
+	case SceneFile::SHAPE_TAPERED_CYLINDER:
+		m_basicMeshes->DrawTaperedCylinderMesh();
+		break;
+	case SceneFile::SHAPE_TORUS:
+		m_basicMeshes->DrawTorusMesh();
+		break;
+	case SceneFile::SHAPE_HALF_TORUS:
+		m_basicMeshes->DrawHalfTorusMesh();
+		break;
+	default:
+		break;
 	}
 }
 
 /***********************************************************
- *  SetShaderMaterial()
+ *  DrawSceneShapeInstanced()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for drawing one copy of a scene
+ *  shape for every passed in transform with a single draw
+ *  call, for the shapes that have an instanced draw.  The
+ *  draw id keeps the detail level of the draw from frame
+ *  to frame.
  ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+void SceneManager::DrawSceneShapeInstanced(
+	SceneFile::SCENE_SHAPES shape,
+	const glm::mat4* pTransforms,
+	GLuint nTransforms,
+	GLuint drawId)
 {
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
+	m_basicMeshes->SetDrawID(drawId);
+	SetShaderInstancing(true, false);
 
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
+	switch (shape)
+	{
+	case SceneFile::SHAPE_BOX:
+		m_basicMeshes->DrawBoxMeshInstanced(pTransforms, NULL, nTransforms);
+		break;
+	case SceneFile::SHAPE_CONE:
+		m_basicMeshes->DrawConeMeshInstanced(pTransforms, NULL, nTransforms);
+		break;
+	case SceneFile::SHAPE_CYLINDER:
+		m_basicMeshes->DrawCylinderMeshInstanced(pTransforms, NULL, nTransforms);
+		break;
+	case SceneFile::SHAPE_PLANE:
+		m_basicMeshes->DrawPlaneMeshInstanced(pTransforms, NULL, nTransforms);
+		break;
+	case SceneFile::SHAPE_SPHERE:
+		m_basicMeshes->DrawSphereMeshInstanced(pTransforms, NULL, nTransforms);
+		break;
+	case SceneFile::SHAPE_TORUS:
+		m_basicMeshes->DrawTorusMeshInstanced(pTransforms, NULL, nTransforms);
+		break;
+	default:
+		break;
 	}
+
+	SetShaderInstancing(false, false);
 }
 
 /**************************************************************/
@@ -381,9 +2657,11 @@ void SceneManager::SetShaderMaterial(
 void SceneManager::LoadSceneTextures()
 {
 	/*** STUDENTS - add the code BELOW for loading the textures that ***/
-	/*** will be used for mapping to objects in the 3D scene. Up to  ***/
-	/*** 16 textures can be loaded per scene. Refer to the code in   ***/
-	/*** the OpenGL Sample for help.                                 ***/
+	/*** will be used for mapping to objects in the 3D scene. Images ***/
+	/*** of the same size share a texture array, so there is no      ***/
+	/*** fixed limit on the number of textures per scene. Textures   ***/
+	/*** given an atlas name share a page, so the objects using them ***/
+	/*** are drawn without switching textures.                       ***/
 
 	bool bReturn = false;
 	bReturn = CreateGLTexture(
@@ -412,21 +2690,27 @@ void SceneManager::LoadSceneTextures()
 		"earth");
 	bReturn = CreateGLTexture(
 		"Textures/booksides.jpg",
-		"booksides");
+		"booksides",
+		"books");
 	bReturn = CreateGLTexture(
 		"Textures/bookspines.jpg",
-		"bookspines");
+		"bookspines",
+		"books");
 	bReturn = CreateGLTexture(
 		"Textures/bookstop.jpg",
-		"bookstop");
+		"bookstop",
+		"books");
 	bReturn = CreateGLTexture(
 		"Textures/booksback.jpg",
-		"booksback");
+		"booksback",
+		"books");
 
 
-	// after the texture image data is loaded into memory, the
-	// loaded textures need to be bound to texture slots - there
-	// are a total of 16 available slots for scene textures
+	// the images are loaded in the background, from the texture
+	// cache after the first run, and the levels the draws need
+	// are streamed in once they are loaded, the atlases are
+	// packed, the placeholder is created and the texture arrays
+	// are bound to units now
 	BindGLTextures();
 }
 
@@ -443,14 +2727,26 @@ void SceneManager::PrepareScene()
 	// loaded in memory no matter how many times it is drawn
 	// in the rendered 3D scene
 
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadSphereMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadTorusMesh();
-	m_basicMeshes->LoadBoxMesh();
+	// the objects of the scene are described in the scene
+	// file, which is reloaded whenever it is saved
+	m_sceneFile.Load(g_SceneFilename);
+
+	// the textures are decoded in the background while the
+	// meshes load, and show a placeholder until they arrive
 	LoadSceneTextures();
+
+	// the generated shapes are saved on the first run and
+	// loaded from the cache file on later runs, any that
+	// are not cached are generated in parallel
+	m_basicMeshes->OpenMeshCache(g_MeshCacheFilename);
+	m_basicMeshes->BeginLoading();
+	LoadSceneMeshes();
+	m_basicMeshes->FinishLoading();
+	m_basicMeshes->CloseMeshCache();
 	DefineObjectMaterials();
+	UploadMaterials();
 	SetupSceneLights();
+	BuildSceneDraws();
 }
 
 /***********************************************************
@@ -571,1004 +2867,96 @@ void SceneManager::SetupSceneLights()
  *  RenderScene()
  *
  *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
+ *  drawing the draw list built from the scene file.  Only
+ *  the objects inside the view are drawn, and their draws
+ *  are put in the render queue first, so the ones
+ *  sharing a texture array, material and shape are drawn one
+ *  after the other, front to back, and the transparent ones
+ *  are drawn last, back to front.
  ***********************************************************/
 void SceneManager::RenderScene()
 {
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/***                    WALL PLANE                              ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(50.0f, 1.0f, 20.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 20.0f, -3.5f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// set the texture and material for the wall
-	SetTextureUVScale(4.0f, 2.0f);
-	SetShaderTexture("wall");
-	SetShaderMaterial("wall");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-
-	/***                    GROUND PLANE                              ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(40.0f, 1.0f, 20.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 14.0f, -5.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// set floor texture and material
-	SetTextureUVScale(8.0f, 4.0f);
-	SetShaderTexture("floor");
-	SetShaderMaterial("wood");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-
-
-	/***************************************************************************************************************/
-	/***                                                 SHELF PLANES AND SUPPORT BARS                           ***/
-	/***************************************************************************************************************/
-	/***               BOTTOM SHELF PLANE                           ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 0.2f, 3.5f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 15.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderTexture("blackwood");
-	SetShaderMaterial("blackwood");
-	SetTextureUVScale(4.0f, 2.0f);
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-	/***               BOTTOM SHELF BACK PLANE                      ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 0.2f, 2.6f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 16.0f, -1.75f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderTexture("blackwood");	
-	SetShaderMaterial("blackwood");
-	SetTextureUVScale(4.0f, 2.0f);
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-	/***                   TOP SHELF PLANE                          ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 0.2f, 3.5f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 22.87f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderTexture("blackwood");
-	SetShaderMaterial("blackwood");
-	SetTextureUVScale(4.0f, 2.0f);
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-	/***                       Support Bar Left Back                ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// scale box into an elongated rectangle for support bar
-	scaleXYZ = glm::vec3(0.45f, 10.0f, 0.45f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// set position to left back corner vertical support bar
-	positionXYZ = glm::vec3(-10.0f, 19.0f, -1.75f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0, 0, 0, 1);
-	SetShaderMaterial("metal");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-	/***                       Support Bar Left Front               ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// scale box into an elongated rectangle for support bar
-	scaleXYZ = glm::vec3(0.45f, 10.0f, 0.45f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// set position to the left front vertical support bar
-	positionXYZ = glm::vec3(-10.0f, 19.0f, 1.75f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0, 0, 0, 1);
-	SetShaderMaterial("metal");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-	/***                       Support Bar Left H                   ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// scale box into an elongated rectangle for support bar
-	scaleXYZ = glm::vec3(0.45f, 3.0f, 0.45f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// set position to left top horizontal support bar
-	positionXYZ = glm::vec3(-10.0f, 23.76f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0, 0, 0, 1);
-	SetShaderMaterial("metal");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-	/***                       Support Bar Right Back               ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// scale box into an elongated rectangle for support bar
-	scaleXYZ = glm::vec3(0.45f, 10.0f, 0.45f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// set position to right back corner vertical support bar
-	positionXYZ = glm::vec3(10.0f, 19.0f, -1.75f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0, 0, 0, 1);
-	SetShaderMaterial("metal");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-
-	/***                       Support Bar Right Front              ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// scale box into an elongated rectangle for support bar
-	scaleXYZ = glm::vec3(0.45f, 10.0f, 0.45f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// set position to front right vertical support bar
-	positionXYZ = glm::vec3(10.0f, 19.0f, 1.75f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0, 0, 0, 1);
-	SetShaderMaterial("metal");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-	/***                       Support Bar Right H                  ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// scale box into an elongated rectangle for support bar
-	scaleXYZ = glm::vec3(0.45f, 3.0f, 0.45f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// set position to right top horizontal support bar
-	positionXYZ = glm::vec3(10.0f, 23.76f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0, 0, 0, 1);
-	SetShaderMaterial("metal");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-	/***                       Support Bar Back H                   ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// scale box into an elongated rectangle for support bar
-	scaleXYZ = glm::vec3(0.45f, 20.0f, 0.45f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 90.0f;
-
-	// set the XYZ position for the mesh
-	// set position to back top horizontal support bar
-	positionXYZ = glm::vec3(0.0f, 23.76f, -1.75f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0, 0, 0, 1);
-	SetShaderMaterial("metal");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-	/***************************************************************************************************************/
-	/***                                                 SNOWGLOBE OBJECT                                        ***/
-	/***************************************************************************************************************/
-
-
-	/***                   SNOWGLOBE SPHERE                         ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(1.0f, 1.0f, 1.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 60.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	//position globe on top shelf in the center on the x axis
-	positionXYZ = glm::vec3(0.0f, 24.5f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the snow globe texture
-	SetShaderTexture("globe");
-	SetTextureUVScale(1.0f, 1.0f);	// default texture UV scale
-
-	SetShaderMaterial("glass");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
-	/****************************************************************/
-
-	/***                   SNOWGLOBE BASE                           ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// scale the snow globe base to match the picture
-	scaleXYZ = glm::vec3(0.75f, 0.75f, 0.75f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 180.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// position the base just under the sphere on the top shelf, in the center
-	positionXYZ = glm::vec3(0.0f, 23.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for the snow globe base
-	SetShaderTexture("globe_base");	
-	SetTextureUVScale(2.0f, 1.0f);	// scale the texture UV mapping on the base
-
-	SetShaderMaterial("plastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-	/****************************************************************/
-
-	/***                   SNOWGLOBE BASE RimTop                    ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// scale torus to match the base
-	scaleXYZ = glm::vec3(0.70f, 0.75f, 0.2f);
-
-	// set the XYZ rotation for the mesh
-	// rotate torus along the x axis 90 degrees so it sits horizontal around the cylindrical base
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	//position to the top of the base cylinder
-	positionXYZ = glm::vec3(0.0f, 23.75f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.69, 0.69, 0.69, 1);		// grey color
-	SetShaderMaterial("plastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
-	/****************************************************************/
-
-	/***                   SNOWGLOBE BASE RimBottom                 ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// scale torus to match the base
-	scaleXYZ = glm::vec3(0.70f, 0.75f, 0.2f);
-
-	// set the XYZ rotation for the mesh
-	// rotate torus along the x axis 90 degrees so it sits horizontal around the cylindrical base
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	//position to the bottom of the base cylinder
-	positionXYZ = glm::vec3(0.0f, 23.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.69, 0.69, 0.69, 1);		//grey color
-	SetShaderMaterial("plastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
-	/****************************************************************/
-
-
-
-	/***************************************************************************************************************/
-	/***                                                 RUBIK'S CUBE OBJECT                                     ***/
-	/***************************************************************************************************************/
-
-	/***                       Rubiks Cube                          ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(1.5f, 1.5f, 1.5f);
-
-	// set the XYZ rotation for the mesh
-	// rotate cube 45 degrees along the y axis
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = 0.0f;
+	// copy the textures decoded since the last frame into
+	// their texture arrays
+	UploadDecodedTextures();
 
-	// set the XYZ position for the mesh
-	// position cube on bottom shelf in the center on the x axis
-	positionXYZ = glm::vec3(0.0f, 15.9f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for the rubiks cube
-	SetShaderTexture("rubiks");
-	SetTextureUVScale(0.33f, 0.5f);	// scale the texture UV mapping on the cube to make the texture fit better
-
-	SetShaderMaterial("plastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-	/***************************************************************************************************************/
-	/***                                           LEVITATING GLOBE                                              ***/
-	/***************************************************************************************************************/
-
-	/***                       Base Bottom                          ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(0.7f, 0.3f, 0.7f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// position the bottom base piece
-	positionXYZ = glm::vec3(-8.0f, 23.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for the base bottom piece
-	SetShaderTexture("silver");
-	SetTextureUVScale(1.0f, 1.0f);
-
-	//SetShaderColor(0.69, 0.69, 0.69, 1);
-	SetShaderMaterial("shinyplastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-	/****************************************************************/
-
-
-	/***                       Base Top                             ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(0.7f, 0.3f, 0.7f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// position base top piece
-	positionXYZ = glm::vec3(-8.0f, 26.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for the base top piece
-	SetShaderTexture("silver");
-	SetTextureUVScale(1.0f, 1.0f);
-
-	//SetShaderColor(0.69, 0.69, 0.69, 1);
-	SetShaderMaterial("shinyplastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-	/****************************************************************/
-
-
-	/***                       Arm                                  ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(0.2f, 2.4f, 0.1f);
-
-	// set the XYZ rotation for the mesh
-	// rotate arm 45 degrees along the y axis
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// position arm in correct orientation
-	positionXYZ = glm::vec3(-7.2f, 24.7f, -0.8f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for the arm support
-	SetShaderTexture("silver");
-	SetShaderMaterial("shinyplastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-	/***                       Arm Top                             ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(0.2f, 0.8f, 0.1f);
-
-	// set the XYZ rotation for the mesh
-	// rotate 45 degrees along the y axis and 60 degrees along the z axis
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = 60.0f;
-
-	// set the XYZ position for the mesh
-	// position top arm piece
-	positionXYZ = glm::vec3(-7.4f, 26.0f, -0.6f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for arm support
-	SetShaderTexture("silver");
-	SetShaderMaterial("shinyplastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-
-	/***                       Arm Bottom                           ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(0.2f, 0.8f, 0.1f);
-
-	// set the XYZ rotation for the mesh
-	// rotate bottom arm piece to line up with arm
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = -60.0f;
-
-	// set the XYZ position for the mesh
-	// position bottom arm piece
-	positionXYZ = glm::vec3(-7.4f, 23.4f, -0.6f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for arm support
-	SetShaderTexture("silver");
-	SetShaderMaterial("shinyplastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-	/***                       Globe                                ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(0.9f, 0.9f, 0.9f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// position the globe between the top and bottom base pieces
-	positionXYZ = glm::vec3(-8.0f, 24.7f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for the globe
-	SetShaderTexture("earth");
-	SetShaderMaterial("plastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
-	/****************************************************************/
-
-
-	/***                       Books Spines                          ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(0.05f, 2.5f, 3.3f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 90.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// position the stack of books to the right of the snow globe
-	positionXYZ = glm::vec3(7.5f, 24.2f, 0.95f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for the book spines
-	SetShaderTexture("bookspines");
-	SetShaderMaterial("plastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-	/***                       Books Top                            ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(1.9f, 0.05f, 3.3f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 90.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// position the cover of the top book
-	positionXYZ = glm::vec3(7.5f, 25.43f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for the cover of the top book
-	SetShaderTexture("bookstop");
-	SetShaderMaterial("plastic");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-
-	/***                       Books Right Side                     ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(1.9f, 2.5f, 0.05f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 90.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// position the right face of the books
-	positionXYZ = glm::vec3(9.15f, 24.2f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for the right side of the book stack
-	SetShaderTexture("booksides");
-	SetShaderMaterial("wood");
+	// pick up the changes saved to the scene file, shapes
+	// that were not used before are generated right away
+	if ((m_sceneFile.HasChanged() == true) && (m_sceneFile.Load(g_SceneFilename) == true))
+	{
+		m_basicMeshes->BeginLoading();
+		LoadSceneMeshes();
+		m_basicMeshes->FinishLoading();
+		BuildSceneDraws();
+	}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
+	// recalculate the matrices of the objects moved since
+	// the last frame, and move their boxes
+	m_sceneTransforms.Update();
+	UpdateSceneBounds();
 
+	// stream in the texture levels the draws need at their
+	// size on the screen, within the texture budget
+	UpdateTextureStreaming();
 
-	/***                       Books Left Side                      ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(1.9f, 2.5f, 0.05f);
+	// record the draws below and submit them together at the
+	// end when the multi-draw indirect path is available
+	BeginSceneBatch();
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 90.0f;
-	ZrotationDegrees = 0.0f;
+	// only the draws of the objects in view reach the queue
+	CullSceneDraws();
 
-	// set the XYZ position for the mesh
-	// position the left face of the books
-	positionXYZ = glm::vec3(5.85f, 24.2f, 0.0f);
+	// the recorded draws are sorted again by the mesh parts
+	// they turn into when the batch is submitted
+	m_sceneQueue.Clear();
+	m_sortTextureArrays.clear();
+	for (size_t i = 0; i < m_visibleDraws.size(); i++)
+	{
+		const SCENE_DRAW& draw = m_visibleDraws[i];
+
+		m_sceneQueue.Push(
+			RenderQueue::MakeKey(
+				g_ScenePass,
+				IsTransparentDraw(draw.texture, draw.color),
+				g_SceneProgram,
+				GetSortID(m_sortTextureArrays, (uint32_t)(GetTextureArray(draw.texture) + 1)),
+				(uint32_t)(draw.material + 1),
+				(uint32_t)draw.shape,
+				GetViewDepth(m_sceneTransforms.GetMatrix(draw.firstTransform))),
+			(uint32_t)i);
+	}
+	m_sceneQueue.Sort();
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set the texture for the left side of the book stack
-	SetShaderTexture("booksides");
-	SetShaderMaterial("wood");
-	SetTextureUVScale(-1.0f, 1.0f);  //invert texture on left side
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
-
-
-	/***                       Books Back                           ***/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	// approximate scale to match the picture
-	scaleXYZ = glm::vec3(0.05f, 2.5f, 3.3f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 90.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	// position the face of the back of the books
-	positionXYZ = glm::vec3(7.5f, 24.2f, -0.95f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	for (size_t i = 0; i < m_sceneQueue.GetCount(); i++)
+	{
+		const SCENE_DRAW& draw = m_visibleDraws[m_sceneQueue.GetItem(i)];
 
-	// Set the texture for the back side of the book stack
-	SetShaderTexture("booksback");
-	SetShaderMaterial("wood");
+		// set the texture or color, and the material
+		if (draw.texture >= 0)
+		{
+			SetShaderTexture(draw.texture);
+		}
+		else
+		{
+			SetShaderColor(draw.color.r, draw.color.g, draw.color.b, draw.color.a);
+		}
+		SetTextureUVScale(draw.UVscale.x, draw.UVscale.y);
+		SetShaderMaterial(draw.material);
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/****************************************************************/
+		// draw the mesh with the transformation values, the
+		// detail level is kept under the index of the first
+		// object since the queue changes the order of the draws
+		if (draw.nTransforms > 1)
+		{
+			DrawSceneShapeInstanced(draw.shape, m_sceneTransforms.GetMatrices() + draw.firstTransform, draw.nTransforms, draw.object);
+		}
+		else
+		{
+			SetModelTransform(m_sceneTransforms.GetMatrix(draw.firstTransform));
+			DrawSceneShape(draw.shape, draw.object);
+		}
+	}
 
+	// draw everything recorded above
+	SubmitSceneBatch();
 }
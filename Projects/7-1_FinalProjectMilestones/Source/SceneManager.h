@@ -9,10 +9,20 @@
 
 #pragma once
 
+#include "SceneBVH.h"
+#include "SceneFile.h"
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "TransformCache.h"
+#include "RenderQueue.h"
+#include "ResourceRegistry.h"
+#include "WorkerPool.h"
+#include "TextureAtlas.h"
+#include "TextureCache.h"
+#include "TextureEncoder.h"
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 /***********************************************************
@@ -32,7 +42,22 @@ public:
 	struct TEXTURE_INFO
 	{
 		std::string tag;
-		uint32_t ID;
+		uint32_t ID;	// the texture array holding the image
+		int array;		// index of the texture array, -1 until loaded
+		int layer;		// layer of the image in the texture array
+		int width;
+		int height;
+		int format;		// TextureEncoder format of the layer
+		int nLevels;	// levels of the full mip chain
+		int residentLevel;		// first level in the layer, nLevels for none
+		int wantedLevel;		// first level the draws of the frame need
+		uint32_t lastNeeded;	// last frame every resident level was needed
+		unsigned char* pChain;	// every level, NULL until loaded
+		int atlasPage;			// handle of the atlas page holding the image, -1 for none
+		glm::vec4 atlasRect;	// offset and size of the image in the page
+		int sharedTexture;		// handle of an identical texture it is drawn from, -1 for none
+		bool bLoaded;	// some levels are uploaded to its layer
+		bool bAlpha;	// the image has an alpha channel
 	};
 
 	struct OBJECT_MATERIAL
@@ -45,29 +70,331 @@ public:
 		std::string tag;
 	};
 
+	// the shader state a recorded draw is drawn with
+	struct DRAW_STATE
+	{
+		int texture;			// -1 when drawn with the color
+		glm::vec2 UVscale;
+		glm::vec4 color;
+		int material;			// -1 before a material is set
+	};
+
+	// per-draw data read by the shader in the multi-draw
+	// indirect path, laid out as the std430 DrawData struct
+	struct DRAW_DATA
+	{
+		glm::mat4 model;
+		glm::vec4 color;
+		glm::vec2 UVscale;
+		GLint material;				// index into the material table
+		GLint textureLayer;			// layer in the bound texture array
+		glm::vec4 atlasRect;		// rectangle of the layer the texture covers
+		GLfloat atlasMaxLod;		// last level of the array it is drawn from
+		GLfloat padding[3];
+	};
+
+	// one material of the material table read by the shader,
+	// laid out as the std140 MaterialData struct
+	struct MATERIAL_DATA
+	{
+		glm::vec4 ambientColor;		// w holds the ambient strength
+		glm::vec4 diffuseColor;
+		glm::vec4 specularColor;	// w holds the shininess
+	};
+
+	// one draw of the scene draw list, covering one object or
+	// a run of objects in the scene file that only differ in
+	// their transforms
+	struct SCENE_DRAW
+	{
+		SceneFile::SCENE_SHAPES shape;
+		GLuint firstTransform;	// first transform in the transform list
+		GLuint nTransforms;		// number of objects drawn
+		GLuint object;			// index of the first object drawn
+		int texture;			// handle of the texture, -1 for the color
+		glm::vec4 color;
+		int material;			// index of the material, -1 for none
+		glm::vec2 UVscale;
+	};
+
 private:
+	// the uniforms set for the draws, resolved once so the
+	// draws do not look them up by name
+	struct SHADER_UNIFORMS
+	{
+		ShaderManager::UniformHandle<glm::mat4> model;
+		ShaderManager::UniformHandle<glm::vec4> objectColor;
+		ShaderManager::UniformHandle<int> objectTexture;
+		ShaderManager::UniformHandle<bool> bUseTexture;
+		ShaderManager::UniformHandle<glm::vec2> UVscale;
+		ShaderManager::UniformHandle<bool> bUseInstancing;
+		ShaderManager::UniformHandle<bool> bUseInstanceColor;
+		ShaderManager::UniformHandle<bool> bUseIndirectDraws;
+		ShaderManager::UniformHandle<int> firstDrawIndex;
+		ShaderManager::UniformHandle<int> materialIndex;
+		ShaderManager::UniformHandle<int> textureLayer;
+		ShaderManager::UniformHandle<glm::vec4> atlasRect;
+		ShaderManager::UniformHandle<float> atlasMaxLod;
+	};
+
+	// one texture array holding the resident levels of
+	// textures of one size and format, one per layer
+	struct TEXTURE_ARRAY
+	{
+		GLuint ID;			// 0 once the array is deleted
+		int width;
+		int height;
+		int format;
+		int nLevels;
+		int nLayers;
+		std::vector<int> freeLayers;
+	};
+
+	// the mip chain of an image loaded by a texture worker
+	// thread that is waiting to be copied into its texture
+	// array layer
+	struct TEXTURE_IMAGE
+	{
+		int texture;			// handle of the texture
+		unsigned char* pData;	// every level, NULL on failure
+		size_t bytes;
+		int width;
+		int height;
+		int nLevels;
+		int colorChannels;		// channels in the image file
+		bool bCached;			// read from the texture cache
+		uint64_t contentKey;	// hash of the size, format and levels
+		std::string filename;
+	};
+
+	// the textures registered for an atlas, with their image
+	// files, loaded together on shared pages once packed
+	struct TEXTURE_ATLAS
+	{
+		std::string name;
+		std::vector<int> textures;
+		std::vector<std::string> filenames;
+	};
+
+	// one pixel buffer of the texture upload ring, with the
+	// fence of the last upload read from it
+	struct PIXEL_BUFFER
+	{
+		GLuint buffer;
+		GLsizeiptr capacity;
+		GLsync fence;
+	};
+
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
+	SHADER_UNIFORMS m_uniforms;
 	// pointer to basic shapes object
 	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
+	// loaded textures info, indexed by the texture handles,
+	// and the handle of every tag
+	std::vector<TEXTURE_INFO> m_textures;
+	std::unordered_map<std::string, int> m_textureHandles;
+	// the texture arrays the textures are layers of, and the
+	// array of the placeholder layer
+	std::vector<TEXTURE_ARRAY> m_textureArrays;
+	int m_placeholderArray;
+	// the texture array bound to every texture unit, -1 for
+	// none
+	std::vector<int> m_boundTextureArrays;
+	// the atlases registered since they were last packed
+	std::vector<TEXTURE_ATLAS> m_textureAtlases;
+	// the threads decoding the texture images, the decoded
+	// images they hand back, and the ones not uploaded yet
+	WorkerPool* m_pTextureWorkers;
+	CompletionQueue<TEXTURE_IMAGE> m_decodedImages;
+	std::vector<TEXTURE_IMAGE> m_pendingImages;
+	// the encoded mip chains of earlier runs, and the number
+	// of textures still loading
+	TextureCache m_textureCache;
+	// the textures by the hash of their image file and of
+	// their levels, so identical images are loaded once
+	ResourceRegistry m_textureContents;
+	int m_nTextureLoads;
+	// the ring of pixel buffers the images are uploaded
+	// through, and the next one to use
+	std::vector<PIXEL_BUFFER> m_pixelBuffers;
+	size_t m_nextPixelBuffer;
+	// the memory the resident texture levels take, the most
+	// they may take, and the frame counter the least recently
+	// needed levels are found by
+	size_t m_residentTextureBytes;
+	size_t m_textureBudget;
+	uint32_t m_textureFrame;
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// the uniform buffer holding the material table
+	GLuint m_materialBuffer;
+
+	// when true the scene is recorded every frame and drawn
+	// with a few multi-draw indirect calls
+	bool m_bUseIndirectDraws;
+	bool m_bRecordingDraws;
+	// the shader states and the draws recorded this frame
+	std::vector<DRAW_STATE> m_drawStates;
+	std::vector<ShapeMeshes::RecordedDraw> m_recordedDraws;
+	// the recorded draws sorted into runs that can be drawn
+	// together, and the per-draw data of the runs
+	RenderQueue m_drawQueue;
+	std::vector<ShapeMeshes::RecordedDraw> m_sortedDraws;
+	// the texture arrays and meshes met while filling a render
+	// queue, whose positions are the small ids put in the keys
+	std::vector<uint32_t> m_sortTextureArrays;
+	std::vector<uint32_t> m_sortMeshes;
+	std::vector<DRAW_DATA> m_drawData;
+	// the per-draw data as last uploaded to the buffer
+	std::vector<DRAW_DATA> m_uploadedDrawData;
+	GLuint m_drawDataBuffer;
+	GLsizeiptr m_drawDataCapacity;
 
-	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
+	// the scene description and the draw list built from it,
+	// with the model transforms of every group and object
+	SceneFile m_sceneFile;
+	std::vector<SCENE_DRAW> m_sceneDraws;
+	TransformCache m_sceneTransforms;
+	// the box around the shape of every scene object, in the
+	// space of the shape, and the transform of the first object
+	std::vector<SceneBVH::Box> m_objectBounds;
+	size_t m_firstObjectTransform;
+	// the hierarchy of the world boxes of the objects, built
+	// on the first frame after the draw list and refit for
+	// the objects that move
+	SceneBVH m_sceneBVH;
+	bool m_bSceneBVHBuilt;
+	// the objects inside the view of the frame, and the runs
+	// of the draw list that draw them
+	std::vector<uint32_t> m_visibleObjects;
+	std::vector<unsigned char> m_bObjectVisible;
+	std::vector<SCENE_DRAW> m_visibleDraws;
+	// the draw list in the order it is drawn this frame
+	RenderQueue m_sceneQueue;
+	// the view transform of the frame, for the depth of the
+	// draws in the render queues, and the projection and
+	// viewport height, for their size on the screen
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	float m_viewportHeight;
+	// the shape meshes loaded for the scene so far
+	bool m_bShapeLoaded[SceneFile::SHAPE_COUNT];
+
+	// register a texture and start loading its image file,
+	// or add it to an atlas to be loaded with its page
+	bool CreateGLTexture(const char* filename, std::string tag, std::string atlas = "");
+	int RegisterTexture(std::string tag, int width, int height, bool bAlpha);
+	void LoadGLTexture(int texture, std::string filename);
+	void StartTextureLoad();
+	// pack the registered atlases and start loading the pages
+	void BuildTextureAtlases();
+	// load the encoded mip chain of an image file or an atlas
+	// page, on a texture worker thread
+	void LoadTextureImage(TEXTURE_IMAGE& image, TextureEncoder::FORMAT format);
+	void LoadAtlasPage(
+		TEXTURE_IMAGE& image,
+		const TextureAtlas& atlas,
+		int page,
+		const std::vector<std::string>& filenames,
+		TextureEncoder::FORMAT format);
+	bool FindCachedTexture(uint64_t key, TEXTURE_IMAGE& image);
+	void EncodeTextureImage(
+		uint64_t key,
+		const unsigned char* pPixels,
+		TextureEncoder::FORMAT format,
+		TEXTURE_IMAGE& image);
+	// pack the atlases, create the placeholder and bind the
+	// texture arrays to texture units
 	void BindGLTextures();
+	// upload the smallest levels of the images decoded since
+	// the last frame
+	void UploadDecodedTextures();
+	// pick the levels the draws of the frame need and stream
+	// them in or out within the texture budget
+	void UpdateTextureStreaming();
+	int GetWantedTextureLevel(
+		const TEXTURE_INFO& texture,
+		const glm::vec2& UVscale,
+		const glm::mat4& model);
+	// move a texture to a layer holding its levels from the
+	// passed in level on
+	bool SetTextureLevel(int texture, int level);
+	bool AcquirePixelBuffer();
+	bool UploadTextureLevels(
+		const TEXTURE_INFO& texture,
+		int level,
+		int array,
+		int layer);
+	// get a free layer of a texture array of the passed in
+	// size and format, and give it back
+	int AllocateTextureLayer(
+		int width,
+		int height,
+		int format,
+		int& layer);
+	void ReleaseTextureLayer(int array, int layer);
+	// stop decoding and free the images not uploaded
+	void ReleaseTextureLoads();
+	// get the unit of a texture array, binding it if needed
+	int BindTextureArray(int array);
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
-	// find a loaded texture by tag
+	// find a loaded texture by tag, as the ID of its texture
+	// array or as its handle
 	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
-	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	int FindTexture(std::string tag);
+	// get the handle of the texture whose levels a texture
+	// handle is drawn from
+	int GetTextureSource(int texture);
+	// get the texture array and layer a texture handle is
+	// drawn from, the array is -1 for none
+	int GetTextureArray(int texture);
+	int GetTextureLayer(int texture);
+	// get the rectangle of the layer a texture handle is drawn
+	// from, and the last level it may be drawn from
+	glm::vec4 GetTextureRect(int texture);
+	float GetTextureMaxLod(int texture);
+	// find the index of a defined material by tag
+	int FindMaterialIndex(std::string tag);
+	// copy the defined materials into the material table
+	void UploadMaterials();
+
+	// start recording the draws of the frame when the
+	// multi-draw indirect path is used
+	void BeginSceneBatch();
+	// draw the recorded draws of the frame
+	void SubmitSceneBatch();
+	// look up the uniforms set for the draws
+	void ResolveShaderUniforms();
+	// add a changed copy of the current shader state
+	void PushDrawState(const DRAW_STATE& state);
+	// whether a draw with the passed in texture or color
+	// has to be blended, and its distance from the camera
+	bool IsTransparentDraw(int texture, const glm::vec4& color);
+	float GetViewDepth(const glm::mat4& model);
+	// the small id of a value in the fields of the sort keys
+	uint32_t GetSortID(std::vector<uint32_t>& values, uint32_t value);
+
+	// load the meshes of the shapes used by the scene file
+	// that are not loaded yet
+	void LoadSceneMeshes();
+	// build the draw list from the scene file objects
+	void BuildSceneDraws();
+	// get the box around a scene shape in the space of the
+	// shape
+	void GetShapeBounds(SceneFile::SCENE_SHAPES shape, SceneBVH::Box& box);
+	// build or refit the hierarchy of the object boxes, and
+	// keep the runs of the draws inside the view
+	void UpdateSceneBounds();
+	void CullSceneDraws();
+	// draw one or many copies of a scene shape
+	void DrawSceneShape(SceneFile::SCENE_SHAPES shape, GLuint drawId);
+	void DrawSceneShapeInstanced(
+		SceneFile::SCENE_SHAPES shape,
+		const glm::mat4* pTransforms,
+		GLuint nTransforms,
+		GLuint drawId);
 
 	// set the transformation values 
 	// into the transform buffer
@@ -78,6 +405,24 @@ private:
 		float ZrotationDegrees,
 		glm::vec3 positionXYZ);
 
+	// set an already calculated model transform
+	void SetModelTransform(const glm::mat4& modelView);
+
+	// calculate the model transform from the passed in
+	// transformation values
+	glm::mat4 CalculateTransformation(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// switch the shader between the model uniform and the
+	// per-instance transforms and colors
+	void SetShaderInstancing(
+		bool bUseInstancing,
+		bool bUseInstanceColor);
+
 	// set the color values into the shader
 	void SetShaderColor(
 		float redColorValue,
@@ -85,17 +430,23 @@ private:
 		float blueColorValue,
 		float alphaValue);
 
-	// set the texture data into the shader
+	// set the texture data into the shader, by tag or by
+	// its handle
 	void SetShaderTexture(
 		std::string textureTag);
+	void SetShaderTexture(
+		int texture);
 
 	// set the UV scale for the texture mapping
 	void SetTextureUVScale(
 		float u, float v);
 
-	// set the object material into the shader
+	// set the object material into the shader, by tag or by
+	// its index in the material table
 	void SetShaderMaterial(
 		std::string materialTag);
+	void SetShaderMaterial(
+		int material);
 
 public:
 
@@ -113,4 +464,48 @@ public:
 	// setup the scene lights
 	void SetupSceneLights();
 
+	// draw one copy of a basic mesh for every passed in
+	// transform with a single draw call, the colors are
+	// used instead of the shader color when there is one
+	// for every transform
+	void DrawBoxMeshInstanced(
+		const std::vector<glm::mat4>& transforms,
+		const std::vector<glm::vec4>& colors = std::vector<glm::vec4>());
+	void DrawCylinderMeshInstanced(
+		const std::vector<glm::mat4>& transforms,
+		const std::vector<glm::vec4>& colors = std::vector<glm::vec4>());
+	void DrawPlaneMeshInstanced(
+		const std::vector<glm::mat4>& transforms,
+		const std::vector<glm::vec4>& colors = std::vector<glm::vec4>());
+	void DrawSphereMeshInstanced(
+		const std::vector<glm::mat4>& transforms,
+		const std::vector<glm::vec4>& colors = std::vector<glm::vec4>());
+	void DrawTorusMeshInstanced(
+		const std::vector<glm::mat4>& transforms,
+		const std::vector<glm::vec4>& colors = std::vector<glm::vec4>());
+
+	// set the camera of the frame about to be rendered
+	void SetViewCamera(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		float viewportHeight);
+
+	// set the most memory the resident texture levels may
+	// take, in bytes
+	void SetTextureBudget(size_t bytes);
+
+	// move an object of the scene file, in the order the
+	// objects are listed in the file
+	void SetSceneObjectTransform(
+		size_t object,
+		glm::vec3 scaleXYZ,
+		glm::vec3 rotationDegreesXYZ,
+		glm::vec3 positionXYZ);
+	// move a group of the scene file with its objects
+	void SetSceneGroupTransform(
+		std::string groupName,
+		glm::vec3 scaleXYZ,
+		glm::vec3 rotationDegreesXYZ,
+		glm::vec3 positionXYZ);
+
 };
\ No newline at end of file
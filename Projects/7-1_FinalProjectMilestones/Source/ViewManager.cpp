@@ -326,4 +326,19 @@ void ViewManager::PrepareSceneView()
 		// set the view position of the camera into the shader for proper rendering
 		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
 	}
+
+	// keep the matrices for the scene to select detail levels
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+}
+
+/***********************************************************
+ *  GetViewportHeight()
+ *
+ *  This method is used for getting the height of the
+ *  display window in pixels
+ ***********************************************************/
+float ViewManager::GetViewportHeight() const
+{
+	return((float)WINDOW_HEIGHT);
 }
\ No newline at end of file
@@ -0,0 +1,296 @@
+///////////////////////////////////////////////////////////////////////////////
+// cachefile.cpp
+// ============
+// read and write the binary cache files, a header and a table of entries
+// followed by the data blocks of every entry
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CacheFile.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	// alignment of the data blocks in the file
+	const uint64_t g_DataAlignment = 16;
+
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return((offset + g_DataAlignment - 1) & ~(g_DataAlignment - 1));
+	}
+
+	// read and write a 64-bit field of an entry
+	uint64_t GetField(const unsigned char* pEntry, uint32_t field)
+	{
+		uint64_t value = 0;
+		memcpy(&value, pEntry + field, sizeof(value));
+		return(value);
+	}
+
+	void SetField(unsigned char* pEntry, uint32_t field, uint64_t value)
+	{
+		memcpy(pEntry + field, &value, sizeof(value));
+	}
+}
+
+/***********************************************************
+ *  CacheFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CacheFile::CacheFile()
+{
+	memset(&m_format, 0, sizeof(m_format));
+	m_bOpen = false;
+	m_pEntries = NULL;
+	m_nEntries = 0;
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping the cache file.  A file
+ *  that is missing, from another version or format, or
+ *  damaged is treated as an empty cache, and is replaced
+ *  when the cache is closed.
+ ***********************************************************/
+bool CacheFile::Open(const char* filename, const Format& format)
+{
+	Close();
+
+	m_filename = filename;
+	m_format = format;
+	m_bOpen = true;
+
+	if (m_file.Open(filename) == false)
+	{
+		return(false);
+	}
+
+	const unsigned char* pData = m_file.GetData();
+	const uint64_t fileSize = m_file.GetSize();
+	const Header* pHeader = (const Header*)pData;
+
+	bool bValid = (fileSize >= sizeof(Header)) &&
+		(memcmp(pHeader->magic, format.magic, sizeof(format.magic)) == 0) &&
+		(pHeader->version == format.version) &&
+		(pHeader->formatTag == format.formatTag) &&
+		(fileSize >= sizeof(Header) + (uint64_t)pHeader->nEntries * format.entrySize);
+
+	const unsigned char* pEntries = pData + sizeof(Header);
+	for (uint32_t i = 0; (bValid == true) && (i < pHeader->nEntries); i++)
+	{
+		const unsigned char* pEntry = pEntries + (size_t)i * format.entrySize;
+		for (uint32_t block = 0; (bValid == true) && (block < format.nBlocks); block++)
+		{
+			const uint64_t offset = GetField(pEntry, format.blockFields[block]);
+			const uint64_t bytes = GetField(pEntry, format.blockFields[block] + sizeof(uint64_t));
+			bValid = (offset <= fileSize) && (bytes <= fileSize - offset);
+		}
+	}
+
+	if (bValid == false)
+	{
+		m_file.Close();
+		return(false);
+	}
+
+	m_pEntries = pEntries;
+	m_nEntries = pHeader->nEntries;
+	m_bUsed.assign(m_nEntries, false);
+	return(true);
+}
+
+/***********************************************************
+ *  DropEntries()
+ *
+ *  This method is used for releasing the mapped file when
+ *  the cache using it finds an entry it can not use, so
+ *  the cache starts out empty.
+ ***********************************************************/
+void CacheFile::DropEntries()
+{
+	m_file.Close();
+	m_pEntries = NULL;
+	m_nEntries = 0;
+	m_bUsed.clear();
+}
+
+/***********************************************************
+ *  GetEntry()
+ *
+ *  This method is used for getting an entry of the mapped
+ *  file, valid until the cache is closed.
+ ***********************************************************/
+const void* CacheFile::GetEntry(uint32_t index) const
+{
+	return(m_pEntries + (size_t)index * m_format.entrySize);
+}
+
+/***********************************************************
+ *  FindEntry()
+ *
+ *  This method is used for finding an entry by key.  Found
+ *  entries are kept when the file is rewritten.
+ ***********************************************************/
+const void* CacheFile::FindEntry(uint64_t key)
+{
+	for (uint32_t i = 0; i < m_nEntries; i++)
+	{
+		const unsigned char* pEntry = m_pEntries + (size_t)i * m_format.entrySize;
+		if (GetField(pEntry, 0) == key)
+		{
+			m_bUsed[i] = true;
+			return(pEntry);
+		}
+	}
+	return(NULL);
+}
+
+/***********************************************************
+ *  GetData()
+ *
+ *  This method is used for getting a pointer into the
+ *  mapped file, valid until the cache is closed.
+ ***********************************************************/
+const void* CacheFile::GetData(uint64_t offset) const
+{
+	return(m_file.GetData() + offset);
+}
+
+/***********************************************************
+ *  AddEntry()
+ *
+ *  This method is used for copying an entry and its data
+ *  blocks into the list of entries to write when the cache
+ *  is closed.
+ ***********************************************************/
+void CacheFile::AddEntry(const void* entry, const void* const* pBlocks)
+{
+	if (m_bOpen == false)
+	{
+		return;
+	}
+
+	const size_t start = m_newEntries.size();
+	m_newEntries.insert(m_newEntries.end(), (const unsigned char*)entry, (const unsigned char*)entry + m_format.entrySize);
+	for (uint32_t block = 0; block < m_format.nBlocks; block++)
+	{
+		const uint64_t bytes = GetField(&m_newEntries[start], m_format.blockFields[block] + sizeof(uint64_t));
+		const unsigned char* pBlock = (const unsigned char*)pBlocks[block];
+
+		SetField(&m_newEntries[start], m_format.blockFields[block], m_newData.size());
+		m_newData.insert(m_newData.end(), pBlock, pBlock + bytes);
+	}
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for writing the used and added
+ *  entries to the cache file, when any were added, and
+ *  releasing the mapping.
+ ***********************************************************/
+bool CacheFile::Close()
+{
+	bool bSuccess = true;
+	const uint32_t entrySize = m_format.entrySize;
+	const uint32_t nBlocks = m_format.nBlocks;
+
+	if ((m_bOpen == true) && (m_newEntries.empty() == false))
+	{
+		std::vector<unsigned char> entries;
+		std::vector<const unsigned char*> blockData;
+
+		for (uint32_t i = 0; i < m_nEntries; i++)
+		{
+			if (m_bUsed[i] == true)
+			{
+				const unsigned char* pEntry = m_pEntries + (size_t)i * entrySize;
+				entries.insert(entries.end(), pEntry, pEntry + entrySize);
+				for (uint32_t block = 0; block < nBlocks; block++)
+				{
+					blockData.push_back(m_file.GetData() + GetField(pEntry, m_format.blockFields[block]));
+				}
+			}
+		}
+		for (size_t start = 0; start < m_newEntries.size(); start += entrySize)
+		{
+			const unsigned char* pEntry = &m_newEntries[start];
+			entries.insert(entries.end(), pEntry, pEntry + entrySize);
+			for (uint32_t block = 0; block < nBlocks; block++)
+			{
+				blockData.push_back(&m_newData[0] + GetField(pEntry, m_format.blockFields[block]));
+			}
+		}
+		const size_t nEntries = entries.size() / entrySize;
+
+		// lay out the blocks of every entry after the entry table
+		uint64_t offset = sizeof(Header) + entries.size();
+		for (size_t i = 0; i < nEntries; i++)
+		{
+			unsigned char* pEntry = &entries[i * entrySize];
+			for (uint32_t block = 0; block < nBlocks; block++)
+			{
+				offset = AlignOffset(offset);
+				SetField(pEntry, m_format.blockFields[block], offset);
+				offset += GetField(pEntry, m_format.blockFields[block] + sizeof(uint64_t));
+			}
+		}
+
+		std::vector<unsigned char> fileData((size_t)offset, 0);
+		Header header;
+		memcpy(header.magic, m_format.magic, sizeof(header.magic));
+		header.version = m_format.version;
+		header.formatTag = m_format.formatTag;
+		header.nEntries = (uint32_t)nEntries;
+		memcpy(&fileData[0], &header, sizeof(header));
+		memcpy(&fileData[sizeof(Header)], &entries[0], entries.size());
+		for (size_t i = 0; i < nEntries; i++)
+		{
+			const unsigned char* pEntry = &entries[i * entrySize];
+			for (uint32_t block = 0; block < nBlocks; block++)
+			{
+				memcpy(
+					&fileData[(size_t)GetField(pEntry, m_format.blockFields[block])],
+					blockData[i * nBlocks + block],
+					(size_t)GetField(pEntry, m_format.blockFields[block] + sizeof(uint64_t)));
+			}
+		}
+
+		// the old file must be unmapped before it can be replaced
+		m_file.Close();
+
+		std::ofstream stream(m_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		stream.write((const char*)&fileData[0], fileData.size());
+		bSuccess = stream.good();
+	}
+
+	DropEntries();
+	m_newEntries.clear();
+	m_newData.clear();
+	m_bOpen = false;
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  MakeKey()
+ *
+ *  This method is used for hashing the passed in bytes into
+ *  a 64-bit key with FNV-1a.  Passing in the key of other
+ *  bytes gives the key of both together.
+ ***********************************************************/
+uint64_t CacheFile::MakeKey(const void* pData, size_t bytes, uint64_t key)
+{
+	const unsigned char* pBytes = (const unsigned char*)pData;
+
+	for (size_t i = 0; i < bytes; i++)
+	{
+		key ^= pBytes[i];
+		key *= 1099511628211ULL;
+	}
+	return(key);
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// cachefile.h
+// ============
+// read and write the binary cache files, a header and a table of entries
+// followed by the data blocks of every entry
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  CacheFile
+ *
+ *  This class contains the code shared by the cache files.
+ *  A file starts with a header, followed by a table of
+ *  entries and then the data blocks of every entry, each
+ *  aligned to 16 bytes.  The entries are structures of the
+ *  cache using the file, which start with their 64-bit key
+ *  and hold the file offset and size of each of their data
+ *  blocks as two 64-bit values.  Entries that are found
+ *  are marked as used, and when entries are added, closing
+ *  the file rewrites it with only the used and added ones.
+ ***********************************************************/
+class CacheFile
+{
+public:
+	// the most data blocks an entry can have
+	static const uint32_t MAX_BLOCKS = 2;
+
+	// the layout of a cache file, the offsets of the fields
+	// of the entries holding the file offsets of their data
+	// blocks, each followed by the size of the block
+	struct Format
+	{
+		char magic[4];
+		uint32_t version;		// increased when the layout changes
+		uint32_t formatTag;		// format of the data in the blocks
+		uint32_t entrySize;
+		uint32_t nBlocks;
+		uint32_t blockFields[MAX_BLOCKS];
+	};
+
+	// constructor
+	CacheFile();
+
+	// map the passed in cache file, keeping its entries when
+	// it was written with the same format
+	bool Open(const char* filename, const Format& format);
+	// write the cache file if entries were added and release it
+	bool Close();
+	bool IsOpen() const { return(m_bOpen); }
+	// forget the entries of the mapped file, so it is replaced
+	// when the cache is closed
+	void DropEntries();
+
+	// get the entries of the mapped file
+	uint32_t GetEntryCount() const { return(m_nEntries); }
+	const void* GetEntry(uint32_t index) const;
+	// find the entry with the passed in key and mark it used,
+	// returns NULL when there is none
+	const void* FindEntry(uint64_t key);
+	// get a pointer to the data at a file offset of an entry
+	const void* GetData(uint64_t offset) const;
+	// add an entry and a copy of its blocks to be written when
+	// the cache is closed, the sizes are read from the entry
+	void AddEntry(const void* entry, const void* const* pBlocks);
+
+	// hash the passed in bytes into a 64-bit key with FNV-1a,
+	// continuing from a previous key when one is passed in
+	static uint64_t MakeKey(const void* pData, size_t bytes, uint64_t key = 14695981039346656037ULL);
+
+private:
+	// the header at the start of the file
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t formatTag;
+		uint32_t nEntries;
+	};
+
+	std::string m_filename;
+	Format m_format;
+	bool m_bOpen;
+
+	// the mapped file and its entry table
+	MappedFile m_file;
+	const unsigned char* m_pEntries;
+	uint32_t m_nEntries;
+	std::vector<bool> m_bUsed;
+
+	// entries added during this run, with their block offsets
+	// relative to the start of m_newData
+	std::vector<unsigned char> m_newEntries;
+	std::vector<unsigned char> m_newData;
+};
@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.cpp
+// ============
+// map a file read-only into memory so that its contents can be used
+// in place without reading them into an intermediate buffer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************
+ *  MappedFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MappedFile::MappedFile()
+{
+	m_pData = NULL;
+	m_size = 0;
+	m_hFile = NULL;
+	m_hMapping = NULL;
+}
+
+/***********************************************************
+ *  ~MappedFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping the whole passed in
+ *  file into memory for reading.
+ ***********************************************************/
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return(false);
+	}
+
+	LARGE_INTEGER fileSize;
+	if ((GetFileSizeEx(hFile, &fileSize) == FALSE) || (fileSize.QuadPart == 0) ||
+		((unsigned long long)fileSize.QuadPart > (size_t)-1))
+	{
+		CloseHandle(hFile);
+		return(false);
+	}
+
+	HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hMapping == NULL)
+	{
+		CloseHandle(hFile);
+		return(false);
+	}
+
+	void* pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (pView == NULL)
+	{
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return(false);
+	}
+
+	m_hFile = hFile;
+	m_hMapping = hMapping;
+	m_pData = (const unsigned char*)pView;
+	m_size = (size_t)fileSize.QuadPart;
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+	{
+		return(false);
+	}
+
+	struct stat fileInfo;
+	if ((fstat(fd, &fileInfo) != 0) || (fileInfo.st_size == 0))
+	{
+		close(fd);
+		return(false);
+	}
+
+	void* pView = mmap(NULL, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (pView == MAP_FAILED)
+	{
+		return(false);
+	}
+
+	m_pData = (const unsigned char*)pView;
+	m_size = (size_t)fileInfo.st_size;
+#endif
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for releasing the mapping.  Pointers
+ *  into the mapped data are invalid afterwards.
+ ***********************************************************/
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (m_pData != NULL)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (m_hMapping != NULL)
+	{
+		CloseHandle((HANDLE)m_hMapping);
+	}
+	if (m_hFile != NULL)
+	{
+		CloseHandle((HANDLE)m_hFile);
+	}
+#else
+	if (m_pData != NULL)
+	{
+		munmap((void*)m_pData, m_size);
+	}
+#endif
+
+	m_pData = NULL;
+	m_size = 0;
+	m_hFile = NULL;
+	m_hMapping = NULL;
+}
@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// map a file read-only into memory so that its contents can be used
+// in place without reading them into an intermediate buffer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class contains the code for memory mapping a whole
+ *  file for reading.  The mapping stays valid until Close()
+ *  is called or the object is destroyed.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+	// map the passed in file, returns false if the file
+	// could not be opened or is empty
+	bool Open(const char* filename);
+	// release the mapping and the file
+	void Close();
+
+	bool IsOpen() const { return(m_pData != NULL); }
+	const unsigned char* GetData() const { return(m_pData); }
+	size_t GetSize() const { return(m_size); }
+
+private:
+	// the mapping can not be copied
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	const unsigned char* m_pData;
+	size_t m_size;
+
+	// platform handles of the open file and mapping
+	void* m_hFile;
+	void* m_hMapping;
+};
@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.cpp
+// ============
+// collect the draws of a frame with packed sort keys and put them in
+// the order that needs the fewest state changes
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderQueue.h"
+
+#include <cstring>
+
+namespace
+{
+	// the number of bits of every field of the sort key
+	const int g_PassBits = 2;
+	const int g_ProgramBits = 4;
+	const int g_TextureBits = 5;
+	const int g_MaterialBits = 8;
+	const int g_MeshBits = 12;
+	const int g_DepthBits = 32;
+
+	const int g_TransparentShift = 64 - g_PassBits - 1;
+	// the state fields below the transparency flag, the mesh
+	// field ends where the opaque depth starts
+	const int g_StateBits = g_ProgramBits + g_TextureBits + g_MaterialBits + g_MeshBits;
+
+	// digits of one radix pass
+	const int g_RadixBits = 8;
+	const int g_RadixSize = 1 << g_RadixBits;
+
+	uint64_t Field(uint32_t value, int bits)
+	{
+		return((uint64_t)value & ((1ull << bits) - 1));
+	}
+}
+
+/***********************************************************
+ *  RenderQueue()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderQueue::RenderQueue()
+{
+}
+
+/***********************************************************
+ *  MakeKey()
+ *
+ *  This method is used for packing the sort key of a draw.
+ *  The bits of a float that is not negative sort the same
+ *  way as its value, so the depth is stored as its bits,
+ *  inverted for transparent draws to sort them far to near.
+ ***********************************************************/
+uint64_t RenderQueue::MakeKey(
+	uint32_t pass,
+	bool bTransparent,
+	uint32_t program,
+	uint32_t texture,
+	uint32_t material,
+	uint32_t mesh,
+	float depth)
+{
+	// draws behind the camera are treated as right at it
+	if (!(depth > 0.0f))
+	{
+		depth = 0.0f;
+	}
+	uint32_t depthBits = 0;
+	memcpy(&depthBits, &depth, sizeof(depthBits));
+
+	uint64_t state =
+		(Field(program, g_ProgramBits) << (g_TextureBits + g_MaterialBits + g_MeshBits)) |
+		(Field(texture, g_TextureBits) << (g_MaterialBits + g_MeshBits)) |
+		(Field(material, g_MaterialBits) << g_MeshBits) |
+		Field(mesh, g_MeshBits);
+
+	uint64_t key = Field(pass, g_PassBits) << (g_TransparentShift + 1);
+	if (bTransparent == true)
+	{
+		key |= 1ull << g_TransparentShift;
+		key |= Field(~depthBits, g_DepthBits) << g_StateBits;
+		key |= state;
+	}
+	else
+	{
+		key |= state << g_DepthBits;
+		key |= depthBits;
+	}
+
+	return(key);
+}
+
+/***********************************************************
+ *  IsTransparent()
+ *
+ *  This method is used for checking the transparency flag
+ *  of a sort key.
+ ***********************************************************/
+bool RenderQueue::IsTransparent(uint64_t key)
+{
+	return(((key >> g_TransparentShift) & 1) != 0);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every item.
+ ***********************************************************/
+void RenderQueue::Clear()
+{
+	m_keys.clear();
+	m_items.clear();
+}
+
+/***********************************************************
+ *  Push()
+ *
+ *  This method is used for adding an item with its key.
+ ***********************************************************/
+void RenderQueue::Push(uint64_t key, uint32_t item)
+{
+	m_keys.push_back(key);
+	m_items.push_back(item);
+}
+
+/***********************************************************
+ *  Sort()
+ *
+ *  This method is used for sorting the items by their keys,
+ *  eight bits at a time from the lowest.  Every pass is a
+ *  stable counting sort, and passes over digits that are
+ *  the same in every key are skipped, which is most of the
+ *  high state fields in a small scene.
+ ***********************************************************/
+void RenderQueue::Sort()
+{
+	const size_t count = m_keys.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	uint64_t sameBits = ~0ull;
+	for (size_t i = 1; i < count; i++)
+	{
+		sameBits &= ~(m_keys[i] ^ m_keys[0]);
+	}
+
+	m_sortKeys.resize(count);
+	m_sortItems.resize(count);
+
+	size_t offsets[g_RadixSize];
+	for (int shift = 0; shift < 64; shift += g_RadixBits)
+	{
+		if (((sameBits >> shift) & (g_RadixSize - 1)) == (uint64_t)(g_RadixSize - 1))
+		{
+			continue;
+		}
+
+		memset(offsets, 0, sizeof(offsets));
+		for (size_t i = 0; i < count; i++)
+		{
+			offsets[(m_keys[i] >> shift) & (g_RadixSize - 1)]++;
+		}
+
+		size_t total = 0;
+		for (int digit = 0; digit < g_RadixSize; digit++)
+		{
+			size_t digitCount = offsets[digit];
+			offsets[digit] = total;
+			total += digitCount;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			size_t target = offsets[(m_keys[i] >> shift) & (g_RadixSize - 1)]++;
+			m_sortKeys[target] = m_keys[i];
+			m_sortItems[target] = m_items[i];
+		}
+
+		m_keys.swap(m_sortKeys);
+		m_items.swap(m_sortItems);
+	}
+}
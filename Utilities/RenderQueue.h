@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.h
+// ============
+// collect the draws of a frame with packed sort keys and put them in
+// the order that needs the fewest state changes
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  RenderQueue
+ *
+ *  This class contains the code for sorting the draws of a
+ *  frame.  Every item is an index chosen by the caller with
+ *  a 64-bit key built by MakeKey(), which packs from the
+ *  highest bits down:
+ *
+ *    opaque       pass | 0 | program | texture | material
+ *                 | mesh | depth
+ *    transparent  pass | 1 | inverted depth | program
+ *                 | texture | material | mesh
+ *
+ *  so opaque draws are grouped by state and drawn front to
+ *  back inside every group, and transparent draws come last
+ *  and are drawn back to front.  The keys are sorted with a
+ *  radix sort that keeps the order of equal keys.
+ ***********************************************************/
+class RenderQueue
+{
+public:
+	// constructor
+	RenderQueue();
+
+	// pack the sort key of one draw - the values are cut to
+	// the bits they have in the key, and the depth is the
+	// distance in front of the camera
+	static uint64_t MakeKey(
+		uint32_t pass,
+		bool bTransparent,
+		uint32_t program,
+		uint32_t texture,
+		uint32_t material,
+		uint32_t mesh,
+		float depth);
+	static bool IsTransparent(uint64_t key);
+
+	// remove every item
+	void Clear();
+	// add an item with its sort key
+	void Push(uint64_t key, uint32_t item);
+	// sort the items by ascending key
+	void Sort();
+
+	size_t GetCount() const { return(m_keys.size()); }
+	uint64_t GetKey(size_t index) const { return(m_keys[index]); }
+	uint32_t GetItem(size_t index) const { return(m_items[index]); }
+
+private:
+	std::vector<uint64_t> m_keys;
+	std::vector<uint32_t> m_items;
+	// the second buffers every radix pass writes into
+	std::vector<uint64_t> m_sortKeys;
+	std::vector<uint32_t> m_sortItems;
+};
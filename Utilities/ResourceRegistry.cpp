@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourceregistry.cpp
+// ============
+// find loaded resources by a hash of their contents, so that identical
+// resources loaded under different names can share one copy
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ResourceRegistry.h"
+
+#include <cstring>
+
+namespace
+{
+	// the multiplier and shift of the 64-bit MurmurHash2
+	// mixing steps
+	const uint64_t g_HashMultiplier = 0xc6a4a7935bd1e995ULL;
+	const int g_HashShift = 47;
+}
+
+/***********************************************************
+ *  ResourceRegistry()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ResourceRegistry::ResourceRegistry()
+{
+	m_nDuplicates = 0;
+	m_savedBytes = 0;
+}
+
+/***********************************************************
+ *  MakeKey()
+ *
+ *  This method is used for hashing the passed in data into
+ *  a 64-bit key with the 64-bit MurmurHash2 steps.  The data
+ *  is read eight bytes at a time, which keeps hashing large
+ *  images and vertex buffers much faster than the byte at a
+ *  time FNV-1a of the cache keys.
+ ***********************************************************/
+uint64_t ResourceRegistry::MakeKey(const void* pData, size_t bytes, uint64_t seed)
+{
+	const unsigned char* pBytes = (const unsigned char*)pData;
+	uint64_t hash = seed ^ ((uint64_t)bytes * g_HashMultiplier);
+
+	const size_t nWords = bytes / sizeof(uint64_t);
+	for (size_t i = 0; i < nWords; i++)
+	{
+		// the data does not have to be aligned
+		uint64_t word = 0;
+		memcpy(&word, pBytes + i * sizeof(uint64_t), sizeof(word));
+
+		word *= g_HashMultiplier;
+		word ^= word >> g_HashShift;
+		word *= g_HashMultiplier;
+		hash ^= word;
+		hash *= g_HashMultiplier;
+	}
+
+	const size_t nTailBytes = bytes % sizeof(uint64_t);
+	if (nTailBytes > 0)
+	{
+		uint64_t tail = 0;
+		memcpy(&tail, pBytes + nWords * sizeof(uint64_t), nTailBytes);
+		hash ^= tail;
+		hash *= g_HashMultiplier;
+	}
+
+	hash ^= hash >> g_HashShift;
+	hash *= g_HashMultiplier;
+	hash ^= hash >> g_HashShift;
+	return(hash);
+}
+
+/***********************************************************
+ *  FindResource()
+ *
+ *  This method is used for getting the resource registered
+ *  with the passed in key, or -1 when there is none.
+ ***********************************************************/
+int ResourceRegistry::FindResource(uint64_t key) const
+{
+	std::unordered_map<uint64_t, int>::const_iterator found = m_resources.find(key);
+	if (found == m_resources.end())
+	{
+		return(-1);
+	}
+
+	return(found->second);
+}
+
+/***********************************************************
+ *  AddResource()
+ *
+ *  This method is used for registering a resource under
+ *  the passed in key, when the key is not registered yet.
+ ***********************************************************/
+void ResourceRegistry::AddResource(uint64_t key, int resource)
+{
+	m_resources.insert(std::make_pair(key, resource));
+}
+
+/***********************************************************
+ *  AddDuplicate()
+ *
+ *  This method is used for counting a copy of a resource
+ *  that shares the registered one, and the memory the copy
+ *  would have taken.
+ ***********************************************************/
+void ResourceRegistry::AddDuplicate(size_t bytes)
+{
+	m_nDuplicates++;
+	m_savedBytes += bytes;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for forgetting every registered
+ *  resource, when the resources are freed, and resetting
+ *  the counts.
+ ***********************************************************/
+void ResourceRegistry::Clear()
+{
+	m_resources.clear();
+	m_nDuplicates = 0;
+	m_savedBytes = 0;
+}
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourceregistry.h
+// ============
+// find loaded resources by a hash of their contents, so that identical
+// resources loaded under different names can share one copy
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+/***********************************************************
+ *  ResourceRegistry
+ *
+ *  This class contains the code for hashing the contents
+ *  of a resource into a 64-bit key and mapping the key to
+ *  the resource loaded first with those contents, so that
+ *  later copies can use it instead of being loaded again.
+ *  The key is trusted the same way the cache keys are, the
+ *  contents are not compared.  The registry also counts
+ *  the copies that were shared and the memory they saved.
+ ***********************************************************/
+class ResourceRegistry
+{
+public:
+	// constructor
+	ResourceRegistry();
+
+	// hash the passed in data into a 64-bit key, continuing
+	// from the key of the data hashed before it
+	static uint64_t MakeKey(const void* pData, size_t bytes, uint64_t seed = 0);
+
+	// get the resource registered with the passed in key,
+	// or -1 when there is none
+	int FindResource(uint64_t key) const;
+	// register a resource under the passed in key, a key
+	// that is already registered keeps its resource
+	void AddResource(uint64_t key, int resource);
+	// count a copy of the passed in size that shares a
+	// registered resource
+	void AddDuplicate(size_t bytes);
+
+	int GetDuplicateCount() const { return(m_nDuplicates); }
+	size_t GetSavedBytes() const { return(m_savedBytes); }
+
+	// forget every registered resource and the counts
+	void Clear();
+
+private:
+	std::unordered_map<uint64_t, int> m_resources;
+	int m_nDuplicates;
+	size_t m_savedBytes;
+};
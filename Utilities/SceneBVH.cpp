@@ -0,0 +1,384 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebvh.cpp
+// ============
+// keep a bounding volume hierarchy over the boxes of the scene objects
+// and find the objects inside the view frustum
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneBVH.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// most items in a leaf
+	const uint32_t g_LeafItems = 4;
+	// the planes are tested in this many lanes, the six
+	// frustum planes and two that every box is inside of
+	const int g_PlaneLanes = 8;
+	// deepest traversal, the median splits keep the tree
+	// far shallower
+	const int g_MaxStackDepth = 64;
+
+	// the frustum planes as one array per component, with the
+	// absolute values of the normals for the box radius
+	struct Frustum
+	{
+		float x[g_PlaneLanes];
+		float y[g_PlaneLanes];
+		float z[g_PlaneLanes];
+		float w[g_PlaneLanes];
+		float absX[g_PlaneLanes];
+		float absY[g_PlaneLanes];
+		float absZ[g_PlaneLanes];
+	};
+
+	// the result of testing a box against the frustum
+	enum BOX_TEST
+	{
+		BOX_OUTSIDE,
+		BOX_INTERSECTING,
+		BOX_INSIDE
+	};
+
+	// the box around two boxes
+	SceneBVH::Box MergeBoxes(const SceneBVH::Box& a, const SceneBVH::Box& b)
+	{
+		SceneBVH::Box box;
+		box.minimum = glm::min(a.minimum, b.minimum);
+		box.maximum = glm::max(a.maximum, b.maximum);
+		return(box);
+	}
+
+	// the distance of the box center from every plane is
+	// compared with the radius of the box along the normal,
+	// the planes do not have to be normalized for that
+	BOX_TEST TestBox(const Frustum& frustum, const SceneBVH::Box& box)
+	{
+		const glm::vec3 center = (box.minimum + box.maximum) * 0.5f;
+		const glm::vec3 extent = (box.maximum - box.minimum) * 0.5f;
+
+		int outside = 0;
+		int intersecting = 0;
+		for (int i = 0; i < g_PlaneLanes; i++)
+		{
+			const float distance = frustum.x[i] * center.x + frustum.y[i] * center.y + frustum.z[i] * center.z + frustum.w[i];
+			const float radius = frustum.absX[i] * extent.x + frustum.absY[i] * extent.y + frustum.absZ[i] * extent.z;
+			outside |= (distance + radius < 0.0f) ? 1 : 0;
+			intersecting |= (distance - radius < 0.0f) ? 1 : 0;
+		}
+
+		if (outside != 0)
+		{
+			return(BOX_OUTSIDE);
+		}
+		return((intersecting != 0) ? BOX_INTERSECTING : BOX_INSIDE);
+	}
+}
+
+/***********************************************************
+ *  SceneBVH()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneBVH::SceneBVH()
+{
+	m_bRefit = false;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every item and node.
+ ***********************************************************/
+void SceneBVH::Clear()
+{
+	m_boxes.clear();
+	m_items.clear();
+	m_itemLeaves.clear();
+	m_nodes.clear();
+	m_bChanged.clear();
+	m_bRefit = false;
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the tree over the
+ *  passed in boxes from scratch.
+ ***********************************************************/
+void SceneBVH::Build(const std::vector<Box>& boxes)
+{
+	Clear();
+	if (boxes.empty() == true)
+	{
+		return;
+	}
+
+	m_boxes = boxes;
+	m_items.resize(m_boxes.size());
+	for (size_t i = 0; i < m_items.size(); i++)
+	{
+		m_items[i] = (uint32_t)i;
+	}
+	m_itemLeaves.resize(m_boxes.size());
+
+	// a tree over n items has fewer than 2n nodes
+	m_nodes.reserve(2 * m_boxes.size());
+	BuildNode(0, (uint32_t)m_items.size(), 0);
+	m_bChanged.assign(m_nodes.size(), 0);
+}
+
+/***********************************************************
+ *  BuildNode()
+ *
+ *  This method is used for adding the node over a run of
+ *  the item list, and the nodes below it.  The run is
+ *  split in half at the median of the item centers along
+ *  the longest axis of the box around the centers.
+ ***********************************************************/
+uint32_t SceneBVH::BuildNode(uint32_t firstItem, uint32_t nItems, uint32_t parent)
+{
+	const uint32_t index = (uint32_t)m_nodes.size();
+	m_nodes.push_back(Node());
+	m_nodes[index].firstItem = firstItem;
+	m_nodes[index].nItems = nItems;
+	m_nodes[index].secondChild = 0;
+	m_nodes[index].parent = parent;
+
+	Box box = m_boxes[m_items[firstItem]];
+	Box centers;
+	centers.minimum = (box.minimum + box.maximum) * 0.5f;
+	centers.maximum = centers.minimum;
+	for (uint32_t i = firstItem + 1; i < firstItem + nItems; i++)
+	{
+		const Box& itemBox = m_boxes[m_items[i]];
+		const glm::vec3 center = (itemBox.minimum + itemBox.maximum) * 0.5f;
+		box = MergeBoxes(box, itemBox);
+		centers.minimum = glm::min(centers.minimum, center);
+		centers.maximum = glm::max(centers.maximum, center);
+	}
+	m_nodes[index].box = box;
+
+	if (nItems <= g_LeafItems)
+	{
+		for (uint32_t i = firstItem; i < firstItem + nItems; i++)
+		{
+			m_itemLeaves[m_items[i]] = index;
+		}
+		return(index);
+	}
+
+	const glm::vec3 size = centers.maximum - centers.minimum;
+	int axis = 0;
+	if (size.y > size[axis])
+	{
+		axis = 1;
+	}
+	if (size.z > size[axis])
+	{
+		axis = 2;
+	}
+
+	const uint32_t nFirstHalf = nItems / 2;
+	std::nth_element(
+		m_items.begin() + firstItem,
+		m_items.begin() + firstItem + nFirstHalf,
+		m_items.begin() + firstItem + nItems,
+		[this, axis](uint32_t a, uint32_t b)
+		{
+			return((m_boxes[a].minimum[axis] + m_boxes[a].maximum[axis]) <
+				(m_boxes[b].minimum[axis] + m_boxes[b].maximum[axis]));
+		});
+
+	// the first child follows the node, the second follows
+	// the nodes below the first
+	BuildNode(firstItem, nFirstHalf, index);
+	const uint32_t secondChild = BuildNode(firstItem + nFirstHalf, nItems - nFirstHalf, index);
+	m_nodes[index].secondChild = secondChild;
+
+	return(index);
+}
+
+/***********************************************************
+ *  SetBounds()
+ *
+ *  This method is used for changing the box of an item,
+ *  and flagging its leaf and the nodes above it up to the
+ *  first one that is already flagged.
+ ***********************************************************/
+void SceneBVH::SetBounds(uint32_t item, const Box& box)
+{
+	if (item >= m_boxes.size())
+	{
+		return;
+	}
+
+	m_boxes[item] = box;
+
+	uint32_t node = m_itemLeaves[item];
+	while (m_bChanged[node] == 0)
+	{
+		m_bChanged[node] = 1;
+		if (node == 0)
+		{
+			break;
+		}
+		node = m_nodes[node].parent;
+	}
+	m_bRefit = true;
+}
+
+/***********************************************************
+ *  Refit()
+ *
+ *  This method is used for fitting the boxes of the
+ *  flagged nodes to their items or children.  The children
+ *  are stored after their parent, so a pass over the nodes
+ *  from the last one refits the children first.
+ ***********************************************************/
+void SceneBVH::Refit()
+{
+	if (m_bRefit == false)
+	{
+		return;
+	}
+
+	for (size_t i = m_nodes.size(); i > 0; i--)
+	{
+		const size_t index = i - 1;
+		if (m_bChanged[index] == 0)
+		{
+			continue;
+		}
+
+		Node& node = m_nodes[index];
+		if (node.secondChild == 0)
+		{
+			node.box = m_boxes[m_items[node.firstItem]];
+			for (uint32_t j = node.firstItem + 1; j < node.firstItem + node.nItems; j++)
+			{
+				node.box = MergeBoxes(node.box, m_boxes[m_items[j]]);
+			}
+		}
+		else
+		{
+			node.box = MergeBoxes(m_nodes[index + 1].box, m_nodes[node.secondChild].box);
+		}
+		m_bChanged[index] = 0;
+	}
+	m_bRefit = false;
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for finding the items inside the
+ *  frustum of the passed in view-projection matrix.  The
+ *  planes are taken from the rows of the matrix, and the
+ *  tree is walked from the root, skipping the nodes outside
+ *  of the frustum and adding every item below the nodes
+ *  inside it.  The items in the leaves that cross a plane
+ *  are tested one by one.
+ ***********************************************************/
+void SceneBVH::Cull(const glm::mat4& viewProjection, std::vector<uint32_t>& visible) const
+{
+	if (m_nodes.empty() == true)
+	{
+		return;
+	}
+
+	// left, right, bottom, top, near and far, then the two
+	// padding planes
+	Frustum frustum;
+	for (int i = 0; i < g_PlaneLanes; i++)
+	{
+		glm::vec4 plane(0.0f, 0.0f, 0.0f, 1.0f);
+		if (i < 6)
+		{
+			const int row = i / 2;
+			const float sign = ((i % 2) == 0) ? 1.0f : -1.0f;
+			plane = glm::vec4(
+				viewProjection[0][3] + sign * viewProjection[0][row],
+				viewProjection[1][3] + sign * viewProjection[1][row],
+				viewProjection[2][3] + sign * viewProjection[2][row],
+				viewProjection[3][3] + sign * viewProjection[3][row]);
+		}
+		frustum.x[i] = plane.x;
+		frustum.y[i] = plane.y;
+		frustum.z[i] = plane.z;
+		frustum.w[i] = plane.w;
+		frustum.absX[i] = fabsf(plane.x);
+		frustum.absY[i] = fabsf(plane.y);
+		frustum.absZ[i] = fabsf(plane.z);
+	}
+
+	uint32_t stack[g_MaxStackDepth];
+	int depth = 0;
+	stack[depth++] = 0;
+	while (depth > 0)
+	{
+		const uint32_t index = stack[--depth];
+		const Node& node = m_nodes[index];
+
+		const BOX_TEST test = TestBox(frustum, node.box);
+		if (test == BOX_OUTSIDE)
+		{
+			continue;
+		}
+
+		if ((test == BOX_INSIDE) || ((node.secondChild == 0) && (node.nItems == 1)))
+		{
+			visible.insert(visible.end(), m_items.begin() + node.firstItem, m_items.begin() + node.firstItem + node.nItems);
+		}
+		else if (node.secondChild == 0)
+		{
+			for (uint32_t i = node.firstItem; i < node.firstItem + node.nItems; i++)
+			{
+				if (TestBox(frustum, m_boxes[m_items[i]]) != BOX_OUTSIDE)
+				{
+					visible.push_back(m_items[i]);
+				}
+			}
+		}
+		else if (depth + 2 <= g_MaxStackDepth)
+		{
+			stack[depth++] = node.secondChild;
+			stack[depth++] = index + 1;
+		}
+		else
+		{
+			// never reached with the median splits, but the
+			// items are kept rather than lost
+			visible.insert(visible.end(), m_items.begin() + node.firstItem, m_items.begin() + node.firstItem + node.nItems);
+		}
+	}
+}
+
+/***********************************************************
+ *  Transform()
+ *
+ *  This method is used for getting the box around a box
+ *  transformed by an affine matrix.  The center is
+ *  transformed, and the half size along every world axis
+ *  is the sum of the absolute matrix terms times the half
+ *  sizes along the box axes.
+ ***********************************************************/
+SceneBVH::Box SceneBVH::Transform(const Box& box, const glm::mat4& matrix)
+{
+	const glm::vec3 center = (box.minimum + box.maximum) * 0.5f;
+	const glm::vec3 extent = (box.maximum - box.minimum) * 0.5f;
+
+	const glm::vec3 worldCenter = glm::vec3(matrix * glm::vec4(center, 1.0f));
+	const glm::vec3 worldExtent =
+		glm::abs(glm::vec3(matrix[0])) * extent.x +
+		glm::abs(glm::vec3(matrix[1])) * extent.y +
+		glm::abs(glm::vec3(matrix[2])) * extent.z;
+
+	Box worldBox;
+	worldBox.minimum = worldCenter - worldExtent;
+	worldBox.maximum = worldCenter + worldExtent;
+	return(worldBox);
+}
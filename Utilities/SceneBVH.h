@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebvh.h
+// ============
+// keep a bounding volume hierarchy over the boxes of the scene objects
+// and find the objects inside the view frustum
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  SceneBVH
+ *
+ *  This class contains the code for culling the scene
+ *  objects against the view frustum.  The tree is built
+ *  once over the world boxes of the objects, splitting the
+ *  objects at the median of their centers along the longest
+ *  axis until a few are left in every leaf.  When objects
+ *  move only the boxes of the nodes above them are refit,
+ *  so the tree stays valid without being built again.  The
+ *  nodes are stored depth first, so the objects below any
+ *  node are one run of the item list, and a node inside
+ *  the frustum adds its run without testing the nodes
+ *  below it.  The six planes are tested together in loops
+ *  of a fixed length, which the compiler can turn into SIMD
+ *  code.
+ ***********************************************************/
+class SceneBVH
+{
+public:
+	// an axis aligned box
+	struct Box
+	{
+		glm::vec3 minimum;
+		glm::vec3 maximum;
+	};
+
+	// constructor
+	SceneBVH();
+
+	// remove every item and node
+	void Clear();
+	// build the tree over the passed in boxes, the items are
+	// numbered by their place in the list
+	void Build(const std::vector<Box>& boxes);
+	// change the box of an item, the nodes above it are
+	// refit by the next Refit()
+	void SetBounds(uint32_t item, const Box& box);
+	// fit the nodes above the changed items to their boxes
+	void Refit();
+	// append the items whose boxes are at least partly inside
+	// the frustum of the passed in view-projection matrix
+	void Cull(const glm::mat4& viewProjection, std::vector<uint32_t>& visible) const;
+
+	size_t GetItemCount() const { return(m_boxes.size()); }
+
+	// get the box around a box transformed by a matrix
+	static Box Transform(const Box& box, const glm::mat4& matrix);
+
+private:
+	// one node of the tree, the first child of an inner node
+	// follows it and the second is stored, the items below
+	// the node are a run of the item list
+	struct Node
+	{
+		Box box;
+		uint32_t firstItem;
+		uint32_t nItems;
+		uint32_t secondChild;	// 0 for a leaf
+		uint32_t parent;
+	};
+
+	// build the node over a run of the item list, returns its
+	// index
+	uint32_t BuildNode(uint32_t firstItem, uint32_t nItems, uint32_t parent);
+
+	// the box of every item, the items in the order of the
+	// leaves and the leaf of every item
+	std::vector<Box> m_boxes;
+	std::vector<uint32_t> m_items;
+	std::vector<uint32_t> m_itemLeaves;
+	// the nodes, the root first, and the flags of the nodes
+	// above changed items
+	std::vector<Node> m_nodes;
+	std::vector<unsigned char> m_bChanged;
+	bool m_bRefit;
+};
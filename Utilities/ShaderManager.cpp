@@ -14,6 +14,159 @@ using namespace std;
 
 #include "ShaderManager.h"
 
+/***********************************************************
+ *  ShaderManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderManager::ShaderManager()
+{
+	m_programID = 0;
+	m_activeProgramID = 0;
+	m_stateCallsIssued = 0;
+	m_stateCallsElided = 0;
+}
+
+/***********************************************************
+ *  ResetStateCounters()
+ *
+ *  This method is used for starting to count the issued and
+ *  elided calls from zero again.
+ ***********************************************************/
+void ShaderManager::ResetStateCounters()
+{
+	m_stateCallsIssued = 0;
+	m_stateCallsElided = 0;
+}
+
+/***********************************************************
+ *  ResetStateCache()
+ *
+ *  This method is used for forgetting the tracked uniform
+ *  values and active program, so the next calls are all
+ *  sent to OpenGL.
+ ***********************************************************/
+void ShaderManager::ResetStateCache()
+{
+	m_uniformShadows.clear();
+	m_activeProgramID = 0;
+}
+
+/***********************************************************
+ *  ReflectUniforms()
+ *
+ *  This method is used for filling the uniform table with
+ *  the locations of every active uniform of the linked
+ *  program.  An array is reported by its first element, so
+ *  the name without the index and the other elements are
+ *  added as well.  The members of storage blocks have no
+ *  location and are left out.
+ ***********************************************************/
+void ShaderManager::ReflectUniforms()
+{
+	m_uniformLocations.clear();
+
+	GLint nUniforms = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(m_programID, GL_ACTIVE_UNIFORMS, &nUniforms);
+	glGetProgramiv(m_programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	if (nUniforms <= 0)
+	{
+		return;
+	}
+
+	std::vector<GLchar> nameBuffer(maxNameLength + 1);
+	for (GLint i = 0; i < nUniforms; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint arraySize = 0;
+		GLenum type = 0;
+		glGetActiveUniform(m_programID, (GLuint)i, (GLsizei)nameBuffer.size(), &nameLength, &arraySize, &type, &nameBuffer[0]);
+
+		std::string name(&nameBuffer[0], nameLength);
+		GLint location = glGetUniformLocation(m_programID, name.c_str());
+		if (location < 0)
+		{
+			continue;
+		}
+		m_uniformLocations[name] = location;
+
+		const std::string firstElement = "[0]";
+		if ((name.size() > firstElement.size()) &&
+			(name.compare(name.size() - firstElement.size(), firstElement.size(), firstElement) == 0))
+		{
+			std::string arrayName = name.substr(0, name.size() - firstElement.size());
+			m_uniformLocations[arrayName] = location;
+
+			for (GLint element = 1; element < arraySize; element++)
+			{
+				std::string elementName = arrayName + "[" + std::to_string(element) + "]";
+				GLint elementLocation = glGetUniformLocation(m_programID, elementName.c_str());
+				if (elementLocation >= 0)
+				{
+					m_uniformLocations[elementName] = elementLocation;
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  getUniformLocation()
+ *
+ *  This method is used for finding the location of a
+ *  uniform by name in the uniform table.
+ ***********************************************************/
+GLint ShaderManager::getUniformLocation(const std::string &name) const
+{
+	std::unordered_map<std::string, GLint>::const_iterator found = m_uniformLocations.find(name);
+	if (found == m_uniformLocations.end())
+	{
+		return(-1);
+	}
+
+	return(found->second);
+}
+
+/***********************************************************
+ *  IsUniformChanged()
+ *
+ *  This method is used for filtering out the uniform calls
+ *  that would set the value the uniform already has.  The
+ *  values are tracked per location of the current program,
+ *  and a location of -1, which OpenGL ignores, is never
+ *  sent.
+ ***********************************************************/
+bool ShaderManager::IsUniformChanged(GLint location, const void* pValue, unsigned int bytes) const
+{
+	if (location < 0)
+	{
+		m_stateCallsElided++;
+		return(false);
+	}
+
+	if ((size_t)location >= m_uniformShadows.size())
+	{
+		UNIFORM_SHADOW unset;
+		unset.bSet = false;
+		unset.bytes = 0;
+		m_uniformShadows.resize(location + 1, unset);
+	}
+
+	UNIFORM_SHADOW& shadow = m_uniformShadows[location];
+	if ((shadow.bSet == true) && (shadow.bytes == bytes) && (memcmp(shadow.value, pValue, bytes) == 0))
+	{
+		m_stateCallsElided++;
+		return(false);
+	}
+
+	shadow.bSet = true;
+	shadow.bytes = bytes;
+	memcpy(shadow.value, pValue, bytes);
+	m_stateCallsIssued++;
+	return(true);
+}
+
 /***********************************************************
  *  LoadShaders()
  *
@@ -92,6 +245,9 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 	printf("Linking shader program...");
 	GLuint ProgramID = glCreateProgram();
 	m_programID = ProgramID;
+	// the values tracked for the previous program do not
+	// apply to the new one
+	ResetStateCache();
 	glAttachShader(ProgramID, VertexShaderID);
 	glAttachShader(ProgramID, FragmentShaderID);
 	glLinkProgram(ProgramID);
@@ -106,6 +262,10 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 	}
 
 	printf("success\n");
+
+	// look up the uniform locations once, instead of on
+	// every set call
+	ReflectUniforms();
 	
 	glDetachShader(ProgramID, VertexShaderID);
 	glDetachShader(ProgramID, FragmentShaderID);
@@ -7,6 +7,8 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -15,6 +17,9 @@ class ShaderManager
 {
 public:
 	unsigned int m_programID;
+
+	// constructor
+	ShaderManager();
 	
 	GLuint LoadShaders(
 		const char* vertex_file_path, 
@@ -24,80 +29,220 @@ public:
 	// ------------------------------------------------------------------------
 	inline void use()
 	{
+		if (m_activeProgramID == m_programID)
+		{
+			m_stateCallsElided++;
+			return;
+		}
 		glUseProgram(m_programID);
+		m_activeProgramID = m_programID;
+		m_stateCallsIssued++;
+	}
+
+	// the number of uniform and program calls sent to OpenGL,
+	// and the number dropped because they would not change
+	// anything, since the counters were last reset
+	// ------------------------------------------------------------------------
+	unsigned int GetStateCallsIssued() const { return(m_stateCallsIssued); }
+	unsigned int GetStateCallsElided() const { return(m_stateCallsElided); }
+	void ResetStateCounters();
+	// forget the tracked values, for when the program or its
+	// uniforms were changed without the set functions
+	void ResetStateCache();
+
+	// a uniform location of the program resolved once, typed by
+	// the value it takes - resolve it again after LoadShaders()
+	// ------------------------------------------------------------------------
+	template<typename T>
+	struct UniformHandle
+	{
+		GLint location;
+
+		UniformHandle() : location(-1) {}
+		explicit UniformHandle(GLint uniformLocation) : location(uniformLocation) {}
+	};
+
+	// find a uniform in the table filled when the program was
+	// linked, returns -1 for a uniform the program does not use
+	GLint getUniformLocation(const std::string &name) const;
+
+	template<typename T>
+	inline UniformHandle<T> getUniform(const std::string &name) const
+	{
+		return(UniformHandle<T>(getUniformLocation(name)));
 	}
 
-	// utility uniform functions
+	// utility uniform functions, the ones taking a name look
+	// the location up in the uniform table first
 	// ------------------------------------------------------------------------
 	inline void setBoolValue(const std::string &name, bool value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), (int)value);
+		setBoolValue(getUniform<bool>(name), value);
+	}
+	inline void setBoolValue(UniformHandle<bool> handle, bool value) const
+	{
+		int intValue = (int)value;
+		if (IsUniformChanged(handle.location, &intValue, sizeof(intValue)) == true)
+		{
+			glUniform1i(handle.location, intValue);
+		}
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setIntValue(const std::string &name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		setIntValue(getUniform<int>(name), value);
+	}
+	inline void setIntValue(UniformHandle<int> handle, int value) const
+	{
+		if (IsUniformChanged(handle.location, &value, sizeof(value)) == true)
+		{
+			glUniform1i(handle.location, value);
+		}
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setFloatValue(const std::string &name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
+		setFloatValue(getUniform<float>(name), value);
+	}
+	inline void setFloatValue(UniformHandle<float> handle, float value) const
+	{
+		if (IsUniformChanged(handle.location, &value, sizeof(value)) == true)
+		{
+			glUniform1f(handle.location, value);
+		}
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec2Value(const std::string &name, const glm::vec2 &value) const
 	{
-		glUniform2fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		setVec2Value(getUniform<glm::vec2>(name), value);
+	}
+	inline void setVec2Value(UniformHandle<glm::vec2> handle, const glm::vec2 &value) const
+	{
+		if (IsUniformChanged(handle.location, &value[0], sizeof(value)) == true)
+		{
+			glUniform2fv(handle.location, 1, &value[0]);
+		}
 	}
-
 	inline void setVec2Value(const std::string &name, float x, float y) const
 	{
-		glUniform2f(glGetUniformLocation(m_programID, name.c_str()), x, y);
+		setVec2Value(name, glm::vec2(x, y));
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec3Value(const std::string &name, const glm::vec3 &value) const
 	{
-		glUniform3fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		setVec3Value(getUniform<glm::vec3>(name), value);
+	}
+	inline void setVec3Value(UniformHandle<glm::vec3> handle, const glm::vec3 &value) const
+	{
+		if (IsUniformChanged(handle.location, &value[0], sizeof(value)) == true)
+		{
+			glUniform3fv(handle.location, 1, &value[0]);
+		}
 	}
 	inline void setVec3Value(const std::string &name, float x, float y, float z) const
 	{
-		glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
+		setVec3Value(name, glm::vec3(x, y, z));
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec4Value(const std::string &name, const glm::vec4 &value) const
 	{
-		glUniform4fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		setVec4Value(getUniform<glm::vec4>(name), value);
+	}
+	inline void setVec4Value(UniformHandle<glm::vec4> handle, const glm::vec4 &value) const
+	{
+		if (IsUniformChanged(handle.location, &value[0], sizeof(value)) == true)
+		{
+			glUniform4fv(handle.location, 1, &value[0]);
+		}
 	}
 	inline void setVec4Value(const std::string &name, float x, float y, float z, float w)
 	{
-		glUniform4f(glGetUniformLocation(m_programID, name.c_str()), x, y, z, w);
+		setVec4Value(name, glm::vec4(x, y, z, w));
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat2Value(const std::string &name, const glm::mat2 &mat) const
+	inline void setMat2Value(const std::string &name, const glm::mat2 &value) const
 	{
-		glUniformMatrix2fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		setMat2Value(getUniform<glm::mat2>(name), value);
+	}
+	inline void setMat2Value(UniformHandle<glm::mat2> handle, const glm::mat2 &value) const
+	{
+		if (IsUniformChanged(handle.location, &value[0][0], sizeof(value)) == true)
+		{
+			glUniformMatrix2fv(handle.location, 1, GL_FALSE, &value[0][0]);
+		}
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat3Value(const std::string &name, const glm::mat3 &mat) const
+	inline void setMat3Value(const std::string &name, const glm::mat3 &value) const
+	{
+		setMat3Value(getUniform<glm::mat3>(name), value);
+	}
+	inline void setMat3Value(UniformHandle<glm::mat3> handle, const glm::mat3 &value) const
 	{
-		glUniformMatrix3fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		if (IsUniformChanged(handle.location, &value[0][0], sizeof(value)) == true)
+		{
+			glUniformMatrix3fv(handle.location, 1, GL_FALSE, &value[0][0]);
+		}
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat4Value(const std::string &name, const glm::mat4 &mat) const
+	inline void setMat4Value(const std::string &name, const glm::mat4 &value) const
 	{
-		glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+		setMat4Value(getUniform<glm::mat4>(name), value);
+	}
+	inline void setMat4Value(UniformHandle<glm::mat4> handle, const glm::mat4 &value) const
+	{
+		if (IsUniformChanged(handle.location, glm::value_ptr(value), sizeof(value)) == true)
+		{
+			glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+		}
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setSampler2DValue(const std::string& name, const int &value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		setSampler2DValue(getUniform<int>(name), value);
+	}
+	inline void setSampler2DValue(UniformHandle<int> handle, const int &value) const
+	{
+		if (IsUniformChanged(handle.location, &value, sizeof(value)) == true)
+		{
+			glUniform1i(handle.location, value);
+		}
 	}
+
+private:
+	// the locations of the active uniforms by name, filled in
+	// when the program is linked
+	std::unordered_map<std::string, GLint> m_uniformLocations;
+
+	// fill the uniform table from the linked program
+	void ReflectUniforms();
+
+	// the last value set for a uniform location of the program
+	struct UNIFORM_SHADOW
+	{
+		bool bSet;
+		unsigned int bytes;
+		float value[16];	// large enough for a mat4
+	};
+
+	// the tracked uniform values, indexed by location, and the
+	// active program - mutable since setting a uniform does
+	// not change the manager as seen by its users
+	mutable std::vector<UNIFORM_SHADOW> m_uniformShadows;
+	GLuint m_activeProgramID;
+	mutable unsigned int m_stateCallsIssued;
+	mutable unsigned int m_stateCallsElided;
+
+	// check the passed in value against the last one set for
+	// the location and remember it, returns false when setting
+	// it would not change anything
+	bool IsUniformChanged(GLint location, const void* pValue, unsigned int bytes) const;
 };
\ No newline at end of file
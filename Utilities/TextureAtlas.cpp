@@ -0,0 +1,175 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureatlas.cpp
+// ============
+// pack texture images into shared atlas pages, with borders that keep
+// the images apart in the smaller mip levels
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	// the images also start on whole compressed blocks
+	const int g_BlockSize = 4;
+
+	// the texel of an image that a texel outside of it wraps
+	// around to
+	int WrapTexel(int texel, int size)
+	{
+		return(((texel % size) + size) % size);
+	}
+}
+
+/***********************************************************
+ *  TextureAtlas()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureAtlas::TextureAtlas(int pageSize, int border)
+{
+	m_pageSize = pageSize;
+	m_border = border;
+}
+
+/***********************************************************
+ *  AddImage()
+ *
+ *  This method is used for adding an image of the passed in
+ *  size to be placed by the next Pack() call.
+ ***********************************************************/
+int TextureAtlas::AddImage(int width, int height)
+{
+	Rect rect;
+	rect.page = -1;
+	rect.x = 0;
+	rect.y = 0;
+	rect.width = width;
+	rect.height = height;
+	m_rects.push_back(rect);
+
+	return((int)m_rects.size() - 1);
+}
+
+/***********************************************************
+ *  Pack()
+ *
+ *  This method is used for placing the added images on the
+ *  pages.  The images are sorted from the tallest down and
+ *  put in the first row with room for them, and a new row
+ *  is started below the last one, or on a new page when the
+ *  last page is full.  The pages are only as large as the
+ *  rows on them.
+ ***********************************************************/
+void TextureAtlas::Pack()
+{
+	// one row of images on a page, as tall as its first image
+	struct Row
+	{
+		int page;
+		int y;
+		int height;
+		int width;
+	};
+	std::vector<Row> rows;
+	const int alignment = (std::max)(m_border, g_BlockSize);
+
+	m_pageWidths.clear();
+	m_pageHeights.clear();
+
+	std::vector<int> order(m_rects.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = (int)i;
+	}
+	std::stable_sort(order.begin(), order.end(), [this](int a, int b)
+	{
+		return(m_rects[a].height > m_rects[b].height);
+	});
+
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		Rect& rect = m_rects[order[i]];
+		const int width = ((rect.width + 2 * m_border + alignment - 1) / alignment) * alignment;
+		const int height = ((rect.height + 2 * m_border + alignment - 1) / alignment) * alignment;
+
+		rect.page = -1;
+		if ((width > m_pageSize) || (height > m_pageSize))
+		{
+			continue;
+		}
+
+		size_t row = 0;
+		while ((row < rows.size()) &&
+			((rows[row].height < height) || (rows[row].width + width > m_pageSize)))
+		{
+			row++;
+		}
+		if (row == rows.size())
+		{
+			Row next;
+			next.width = 0;
+			next.height = height;
+			if ((m_pageHeights.empty() == false) && (m_pageHeights.back() + height <= m_pageSize))
+			{
+				next.page = (int)m_pageHeights.size() - 1;
+				next.y = m_pageHeights.back();
+			}
+			else
+			{
+				next.page = (int)m_pageHeights.size();
+				next.y = 0;
+				m_pageWidths.push_back(0);
+				m_pageHeights.push_back(0);
+			}
+			rows.push_back(next);
+		}
+
+		Row& place = rows[row];
+		rect.page = place.page;
+		rect.x = place.width + m_border;
+		rect.y = place.y + m_border;
+		place.width += width;
+		m_pageWidths[place.page] = (std::max)(m_pageWidths[place.page], place.width);
+		m_pageHeights[place.page] = (std::max)(m_pageHeights[place.page], place.y + place.height);
+	}
+}
+
+/***********************************************************
+ *  CopyImage()
+ *
+ *  This method is used for copying the RGBA pixels of an
+ *  image into its place on its page, together with the
+ *  border around it, which repeats the image as far as it
+ *  reaches.
+ ***********************************************************/
+void TextureAtlas::CopyImage(
+	int image,
+	const unsigned char* pPixels,
+	unsigned char* pPage) const
+{
+	const Rect& rect = m_rects[image];
+	if (rect.page < 0)
+	{
+		return;
+	}
+
+	const size_t pageWidth = (size_t)m_pageWidths[rect.page];
+	const size_t rowBytes = (size_t)rect.width * 4;
+
+	for (int y = -m_border; y < rect.height + m_border; y++)
+	{
+		const unsigned char* pSource = pPixels + (size_t)WrapTexel(y, rect.height) * rowBytes;
+		unsigned char* pTarget = pPage + ((size_t)(rect.y + y) * pageWidth + (size_t)rect.x) * 4;
+
+		memcpy(pTarget, pSource, rowBytes);
+		for (int x = 1; x <= m_border; x++)
+		{
+			memcpy(pTarget - x * 4, pSource + (size_t)WrapTexel(-x, rect.width) * 4, 4);
+			memcpy(pTarget + rowBytes + (x - 1) * 4, pSource + (size_t)WrapTexel(rect.width + x - 1, rect.width) * 4, 4);
+		}
+	}
+}
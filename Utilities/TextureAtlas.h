@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureatlas.h
+// ============
+// pack texture images into shared atlas pages, with borders that keep
+// the images apart in the smaller mip levels
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+
+/***********************************************************
+ *  TextureAtlas
+ *
+ *  This class contains the code for placing images on atlas
+ *  pages and copying them there.  The images are packed in
+ *  rows, the tallest first, and every image is surrounded
+ *  by a border of the image wrapped around, so a repeated
+ *  image filters across its edges as it would on its own.
+ *  The images start on multiples of the border width, so
+ *  the levels down to the one where the border is a single
+ *  texel never mix two images.
+ ***********************************************************/
+class TextureAtlas
+{
+public:
+	// the place of an image on the pages, not counting its
+	// border, the page is -1 when the image is larger than
+	// a page
+	struct Rect
+	{
+		int page;
+		int x;
+		int y;
+		int width;
+		int height;
+	};
+
+	// constructor
+	TextureAtlas(int pageSize, int border);
+
+	// add an image to be packed and get its index
+	int AddImage(int width, int height);
+	// place the added images on the pages
+	void Pack();
+
+	int GetPageCount() const { return((int)m_pageWidths.size()); }
+	// the used size of a page, at most the page size
+	int GetPageWidth(int page) const { return(m_pageWidths[page]); }
+	int GetPageHeight(int page) const { return(m_pageHeights[page]); }
+	const Rect& GetRect(int image) const { return(m_rects[image]); }
+	int GetBorder() const { return(m_border); }
+
+	// copy an RGBA image and its border into the RGBA pixels
+	// of its page
+	void CopyImage(
+		int image,
+		const unsigned char* pPixels,
+		unsigned char* pPage) const;
+
+private:
+	int m_pageSize;
+	int m_border;
+	std::vector<Rect> m_rects;
+	std::vector<int> m_pageWidths;
+	std::vector<int> m_pageHeights;
+};
@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.cpp
+// ============
+// store encoded texture mip chains in a binary file so that later runs
+// can upload them without decoding the image files again
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCache.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+	const char g_TextureCacheMagic[4] = { 'S', 'T', 'C', 'H' };
+	// increase when the layout of the file or the encoding
+	// of the levels changes
+	const uint32_t g_TextureCacheVersion = 2;
+}
+
+/***********************************************************
+ *  TextureCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureCache::TextureCache()
+{
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping the cache file.  A file
+ *  that is missing, from another version or damaged is
+ *  treated as an empty cache, and is replaced when the
+ *  cache is closed.
+ ***********************************************************/
+bool TextureCache::Open(const char* filename)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	CacheFile::Format format;
+	memcpy(format.magic, g_TextureCacheMagic, sizeof(g_TextureCacheMagic));
+	format.version = g_TextureCacheVersion;
+	format.formatTag = 0;
+	format.entrySize = sizeof(Entry);
+	format.nBlocks = 1;
+	format.blockFields[0] = offsetof(Entry, dataOffset);
+	format.blockFields[1] = 0;
+
+	return(m_file.Open(filename, format));
+}
+
+/***********************************************************
+ *  FindTexture()
+ *
+ *  This method is used for finding a cached texture by key.
+ *  Found entries are kept when the file is rewritten.
+ ***********************************************************/
+bool TextureCache::FindTexture(uint64_t key, Entry& entry)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const Entry* pEntry = (const Entry*)m_file.FindEntry(key);
+	if (pEntry == NULL)
+	{
+		return(false);
+	}
+
+	entry = *pEntry;
+	return(true);
+}
+
+/***********************************************************
+ *  GetData()
+ *
+ *  This method is used for getting a pointer into the
+ *  mapped file, valid until the cache is closed.
+ ***********************************************************/
+const void* TextureCache::GetData(uint64_t offset) const
+{
+	return(m_file.GetData(offset));
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for copying a texture into the list
+ *  of textures to write when the cache is closed.
+ ***********************************************************/
+void TextureCache::AddTexture(
+	const Entry& entry,
+	const void* data)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_file.AddEntry(&entry, &data);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for writing the used and added
+ *  textures to the cache file, when any were added, and
+ *  releasing the mapping.
+ ***********************************************************/
+bool TextureCache::Close()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return(m_file.Close());
+}
+
+/***********************************************************
+ *  MakeKey()
+ *
+ *  This method is used for hashing the contents of an image
+ *  file and the format into a 64-bit key.
+ ***********************************************************/
+uint64_t TextureCache::MakeKey(const void* pData, size_t bytes, uint32_t format)
+{
+	const uint64_t key = CacheFile::MakeKey(pData, bytes);
+	const unsigned char formatBytes[4] = {
+		(unsigned char)(format & 0xFF),
+		(unsigned char)((format >> 8) & 0xFF),
+		(unsigned char)((format >> 16) & 0xFF),
+		(unsigned char)((format >> 24) & 0xFF) };
+	return(CacheFile::MakeKey(formatBytes, sizeof(formatBytes), key));
+}
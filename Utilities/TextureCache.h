@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.h
+// ============
+// store encoded texture mip chains in a binary file so that later runs
+// can upload them without decoding the image files again
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "CacheFile.h"
+
+#include <cstdint>
+#include <mutex>
+
+/***********************************************************
+ *  TextureCache
+ *
+ *  This class contains the code for reading and writing the
+ *  texture cache file.  The file starts with a header,
+ *  followed by a table of entries and then the mip chain
+ *  of every entry, already in the format it is uploaded
+ *  in.  Entries are looked up by a key computed from the
+ *  contents of the image file and the format, so a changed
+ *  image is simply not found.  When textures are added,
+ *  closing the cache rewrites the file with only the
+ *  entries used during this run.  Textures can be looked
+ *  up and added from several threads at once.  The file
+ *  itself is read and written by CacheFile.
+ ***********************************************************/
+class TextureCache
+{
+public:
+	// constructor
+	TextureCache();
+
+	// the description of one cached texture as stored in
+	// the file
+	struct Entry
+	{
+		uint64_t key;			// key of the image file and format
+		uint32_t width;			// size of the first level
+		uint32_t height;
+		uint32_t format;		// TextureEncoder format of the levels
+		uint32_t nLevels;		// number of stored mip levels
+		uint32_t colorChannels;	// channels in the image file
+		uint32_t reserved;
+		uint64_t dataOffset;	// file offset of the mip chain
+		uint64_t dataBytes;		// size of the mip chain
+	};
+
+	// map the passed in cache file
+	bool Open(const char* filename);
+	// write the cache file if textures were added and release it
+	bool Close();
+	bool IsOpen() const { return(m_file.IsOpen()); }
+
+	// find the cached texture with the passed in key and copy
+	// its entry
+	bool FindTexture(uint64_t key, Entry& entry);
+	// get a pointer to the data at a file offset of an entry
+	const void* GetData(uint64_t offset) const;
+	// add a texture to be written when the cache is closed
+	void AddTexture(
+		const Entry& entry,
+		const void* data);
+
+	// combine the contents of an image file and the format
+	// it is encoded in into a key
+	static uint64_t MakeKey(const void* pData, size_t bytes, uint32_t format);
+
+private:
+	// the cache can not be copied
+	TextureCache(const TextureCache&);
+	TextureCache& operator=(const TextureCache&);
+
+	// guards the used flags and the added textures of the file
+	std::mutex m_mutex;
+	// the file with the entry table and the mip chains
+	CacheFile m_file;
+};
@@ -0,0 +1,462 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureencoder.cpp
+// ============
+// build the mip chain of a texture image and encode its levels into
+// the block compressed formats the texture arrays are stored in
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureEncoder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+	// texels in one compressed block
+	const int g_BlockTexels = 16;
+	// power iterations used to find the principal axis
+	const int g_AxisIterations = 8;
+
+	// quantize a color to 565 and expand it back to 8 bits
+	uint16_t QuantizeColor(const float* pColor)
+	{
+		int red = (int)std::floor((std::min)((std::max)(pColor[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+		int green = (int)std::floor((std::min)((std::max)(pColor[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+		int blue = (int)std::floor((std::min)((std::max)(pColor[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+		return((uint16_t)((red << 11) | (green << 5) | blue));
+	}
+
+	void ExpandColor(uint16_t color, float* pColor)
+	{
+		int red = (color >> 11) & 31;
+		int green = (color >> 5) & 63;
+		int blue = color & 31;
+		pColor[0] = (float)((red << 3) | (red >> 2));
+		pColor[1] = (float)((green << 2) | (green >> 4));
+		pColor[2] = (float)((blue << 3) | (blue >> 2));
+	}
+
+	size_t GetBlockBytes(TextureEncoder::FORMAT format)
+	{
+		return((format == TextureEncoder::FORMAT_BC1) ? 8 : 16);
+	}
+}
+
+/***********************************************************
+ *  TextureEncoder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureEncoder::TextureEncoder()
+{
+}
+
+/***********************************************************
+ *  GetLevelCount()
+ *
+ *  This method is used for counting the levels of the full
+ *  mip chain of an image.
+ ***********************************************************/
+int TextureEncoder::GetLevelCount(int width, int height)
+{
+	int nLevels = 1;
+	while ((width > 1) || (height > 1))
+	{
+		width = (std::max)(width / 2, 1);
+		height = (std::max)(height / 2, 1);
+		nLevels++;
+	}
+	return(nLevels);
+}
+
+/***********************************************************
+ *  GetLevelBytes()
+ *
+ *  This method is used for getting the size of one level
+ *  of the mip chain.  A compressed level is stored in whole
+ *  blocks, even when it is smaller than one block.
+ ***********************************************************/
+size_t TextureEncoder::GetLevelBytes(FORMAT format, int width, int height, int level)
+{
+	const size_t levelWidth = (size_t)(std::max)(width >> level, 1);
+	const size_t levelHeight = (size_t)(std::max)(height >> level, 1);
+
+	if (format == FORMAT_RGBA8)
+	{
+		return(levelWidth * levelHeight * 4);
+	}
+
+	return(((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * GetBlockBytes(format));
+}
+
+/***********************************************************
+ *  GetChainBytes()
+ *
+ *  This method is used for getting the size of the full
+ *  mip chain of an image.
+ ***********************************************************/
+size_t TextureEncoder::GetChainBytes(FORMAT format, int width, int height)
+{
+	size_t bytes = 0;
+	const int nLevels = GetLevelCount(width, height);
+	for (int level = 0; level < nLevels; level++)
+	{
+		bytes += GetLevelBytes(format, width, height, level);
+	}
+	return(bytes);
+}
+
+/***********************************************************
+ *  EncodeChain()
+ *
+ *  This method is used for encoding the passed in image as
+ *  the first level and filtering every following level
+ *  from the one before it.
+ ***********************************************************/
+void TextureEncoder::EncodeChain(
+	FORMAT format,
+	const unsigned char* pPixels,
+	int width,
+	int height,
+	unsigned char* pOutput)
+{
+	const int nLevels = GetLevelCount(width, height);
+	const unsigned char* pLevel = pPixels;
+	int levelWidth = width;
+	int levelHeight = height;
+
+	for (int level = 0; level < nLevels; level++)
+	{
+		EncodeLevel(format, pLevel, levelWidth, levelHeight, pOutput);
+		pOutput += GetLevelBytes(format, width, height, level);
+
+		if (level + 1 < nLevels)
+		{
+			// the level being filtered is in the other buffer
+			std::vector<unsigned char>& next = m_levels[level % 2];
+			const int nextWidth = (std::max)(levelWidth / 2, 1);
+			const int nextHeight = (std::max)(levelHeight / 2, 1);
+			next.resize((size_t)nextWidth * nextHeight * 4);
+			Downsample(pLevel, levelWidth, levelHeight, &next[0]);
+
+			pLevel = &next[0];
+			levelWidth = nextWidth;
+			levelHeight = nextHeight;
+		}
+	}
+}
+
+/***********************************************************
+ *  EncodeLevel()
+ *
+ *  This method is used for encoding one level.  The texels
+ *  of every block are gathered into one array per channel,
+ *  repeating the last row and column for the blocks past
+ *  the edge of the level.
+ ***********************************************************/
+void TextureEncoder::EncodeLevel(
+	FORMAT format,
+	const unsigned char* pPixels,
+	int width,
+	int height,
+	unsigned char* pOutput)
+{
+	if (format == FORMAT_RGBA8)
+	{
+		memcpy(pOutput, pPixels, (size_t)width * height * 4);
+		return;
+	}
+
+	const size_t blockBytes = GetBlockBytes(format);
+	const int blocksWide = (width + 3) / 4;
+	const int blocksHigh = (height + 3) / 4;
+
+	float red[g_BlockTexels];
+	float green[g_BlockTexels];
+	float blue[g_BlockTexels];
+	float alpha[g_BlockTexels];
+
+	for (int blockY = 0; blockY < blocksHigh; blockY++)
+	{
+		for (int blockX = 0; blockX < blocksWide; blockX++)
+		{
+			for (int y = 0; y < 4; y++)
+			{
+				const int pixelY = (std::min)(blockY * 4 + y, height - 1);
+				for (int x = 0; x < 4; x++)
+				{
+					const int pixelX = (std::min)(blockX * 4 + x, width - 1);
+					const unsigned char* pTexel = pPixels + ((size_t)pixelY * width + pixelX) * 4;
+					red[y * 4 + x] = pTexel[0];
+					green[y * 4 + x] = pTexel[1];
+					blue[y * 4 + x] = pTexel[2];
+					alpha[y * 4 + x] = pTexel[3];
+				}
+			}
+
+			unsigned char* pBlock = pOutput + ((size_t)blockY * blocksWide + blockX) * blockBytes;
+			if (format == FORMAT_BC3)
+			{
+				EncodeAlphaBlock(alpha, pBlock);
+				pBlock += 8;
+			}
+			EncodeColorBlock(red, green, blue, pBlock);
+		}
+	}
+}
+
+/***********************************************************
+ *  Downsample()
+ *
+ *  This method is used for averaging every 2x2 texels of a
+ *  level into one texel of the next level.  A level that
+ *  is one texel wide or high is only halved the other way.
+ ***********************************************************/
+void TextureEncoder::Downsample(
+	const unsigned char* pPixels,
+	int width,
+	int height,
+	unsigned char* pOutput)
+{
+	const int nextWidth = (std::max)(width / 2, 1);
+	const int nextHeight = (std::max)(height / 2, 1);
+
+	for (int y = 0; y < nextHeight; y++)
+	{
+		const unsigned char* pRow0 = pPixels + (size_t)(std::min)(y * 2, height - 1) * width * 4;
+		const unsigned char* pRow1 = pPixels + (size_t)(std::min)(y * 2 + 1, height - 1) * width * 4;
+		unsigned char* pNext = pOutput + (size_t)y * nextWidth * 4;
+
+		for (int x = 0; x < nextWidth; x++)
+		{
+			const int x0 = (std::min)(x * 2, width - 1) * 4;
+			const int x1 = (std::min)(x * 2 + 1, width - 1) * 4;
+			for (int channel = 0; channel < 4; channel++)
+			{
+				const int sum = pRow0[x0 + channel] + pRow0[x1 + channel] + pRow1[x0 + channel] + pRow1[x1 + channel];
+				pNext[x * 4 + channel] = (unsigned char)((sum + 2) / 4);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  EncodeColorBlock()
+ *
+ *  This method is used for encoding the colors of a block
+ *  as BC1.  The endpoints are the extremes of the colors
+ *  projected on the principal axis of their covariance,
+ *  found by power iteration, and every texel gets the index
+ *  of the nearest of the four colors between the quantized
+ *  endpoints.  The loops over the 16 texels work on the
+ *  separate channel arrays, so the compiler can turn them
+ *  into SIMD code.  The first endpoint is always the larger
+ *  one, which selects the four color mode.
+ ***********************************************************/
+void TextureEncoder::EncodeColorBlock(
+	const float* pRed,
+	const float* pGreen,
+	const float* pBlue,
+	unsigned char* pOutput)
+{
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < g_BlockTexels; i++)
+	{
+		mean[0] += pRed[i];
+		mean[1] += pGreen[i];
+		mean[2] += pBlue[i];
+	}
+	for (int k = 0; k < 3; k++)
+	{
+		mean[k] /= (float)g_BlockTexels;
+	}
+
+	// covariance as rr, rg, rb, gg, gb, bb
+	float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < g_BlockTexels; i++)
+	{
+		const float red = pRed[i] - mean[0];
+		const float green = pGreen[i] - mean[1];
+		const float blue = pBlue[i] - mean[2];
+		covariance[0] += red * red;
+		covariance[1] += red * green;
+		covariance[2] += red * blue;
+		covariance[3] += green * green;
+		covariance[4] += green * blue;
+		covariance[5] += blue * blue;
+	}
+
+	// start from the row of the channel with the largest
+	// spread, which is never orthogonal to the axis
+	float axis[3];
+	if ((covariance[0] >= covariance[3]) && (covariance[0] >= covariance[5]))
+	{
+		axis[0] = covariance[0]; axis[1] = covariance[1]; axis[2] = covariance[2];
+	}
+	else if (covariance[3] >= covariance[5])
+	{
+		axis[0] = covariance[1]; axis[1] = covariance[3]; axis[2] = covariance[4];
+	}
+	else
+	{
+		axis[0] = covariance[2]; axis[1] = covariance[4]; axis[2] = covariance[5];
+	}
+	for (int iteration = 0; iteration < g_AxisIterations; iteration++)
+	{
+		const float next[3] = {
+			covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+			covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+			covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2] };
+		const float largest = (std::max)((std::max)(std::fabs(next[0]), std::fabs(next[1])), std::fabs(next[2]));
+		if (largest <= FLT_EPSILON)
+		{
+			break;
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			axis[k] = next[k] / largest;
+		}
+	}
+	const float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	for (int k = 0; k < 3; k++)
+	{
+		axis[k] = (length > FLT_EPSILON) ? axis[k] / length : 0.0f;
+	}
+
+	float minimum = FLT_MAX;
+	float maximum = -FLT_MAX;
+	for (int i = 0; i < g_BlockTexels; i++)
+	{
+		const float projection =
+			(pRed[i] - mean[0]) * axis[0] +
+			(pGreen[i] - mean[1]) * axis[1] +
+			(pBlue[i] - mean[2]) * axis[2];
+		minimum = (std::min)(minimum, projection);
+		maximum = (std::max)(maximum, projection);
+	}
+
+	float endpoints[2][3];
+	for (int k = 0; k < 3; k++)
+	{
+		endpoints[0][k] = mean[k] + axis[k] * maximum;
+		endpoints[1][k] = mean[k] + axis[k] * minimum;
+	}
+	uint16_t color0 = QuantizeColor(endpoints[0]);
+	uint16_t color1 = QuantizeColor(endpoints[1]);
+	if (color0 < color1)
+	{
+		std::swap(color0, color1);
+	}
+
+	// the palette the decoder builds from the endpoints
+	float palette[4][3];
+	ExpandColor(color0, palette[0]);
+	ExpandColor(color1, palette[1]);
+	for (int k = 0; k < 3; k++)
+	{
+		palette[2][k] = (2.0f * palette[0][k] + palette[1][k]) / 3.0f;
+		palette[3][k] = (palette[0][k] + 2.0f * palette[1][k]) / 3.0f;
+	}
+
+	uint32_t indices = 0;
+	if (color0 != color1)
+	{
+		float distances[4][g_BlockTexels];
+		for (int entry = 0; entry < 4; entry++)
+		{
+			for (int i = 0; i < g_BlockTexels; i++)
+			{
+				const float red = pRed[i] - palette[entry][0];
+				const float green = pGreen[i] - palette[entry][1];
+				const float blue = pBlue[i] - palette[entry][2];
+				distances[entry][i] = red * red + green * green + blue * blue;
+			}
+		}
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			uint32_t best = 0;
+			for (uint32_t entry = 1; entry < 4; entry++)
+			{
+				if (distances[entry][i] < distances[best][i])
+				{
+					best = entry;
+				}
+			}
+			indices |= best << (i * 2);
+		}
+	}
+
+	pOutput[0] = (unsigned char)(color0 & 0xFF);
+	pOutput[1] = (unsigned char)(color0 >> 8);
+	pOutput[2] = (unsigned char)(color1 & 0xFF);
+	pOutput[3] = (unsigned char)(color1 >> 8);
+	for (int i = 0; i < 4; i++)
+	{
+		pOutput[4 + i] = (unsigned char)((indices >> (i * 8)) & 0xFF);
+	}
+}
+
+/***********************************************************
+ *  EncodeAlphaBlock()
+ *
+ *  This method is used for encoding the alphas of a block
+ *  as the alpha half of BC3.  The endpoints are the largest
+ *  and smallest alpha, which selects the mode with six
+ *  values between them, and every texel gets the index of
+ *  the nearest of the eight values.
+ ***********************************************************/
+void TextureEncoder::EncodeAlphaBlock(
+	const float* pAlpha,
+	unsigned char* pOutput)
+{
+	float minimum = 255.0f;
+	float maximum = 0.0f;
+	for (int i = 0; i < g_BlockTexels; i++)
+	{
+		minimum = (std::min)(minimum, pAlpha[i]);
+		maximum = (std::max)(maximum, pAlpha[i]);
+	}
+	const int alpha0 = (int)maximum;
+	const int alpha1 = (int)minimum;
+
+	uint64_t indices = 0;
+	if (alpha0 != alpha1)
+	{
+		// the values of the indices in the order the decoder
+		// numbers them
+		float palette[8];
+		palette[0] = (float)alpha0;
+		palette[1] = (float)alpha1;
+		for (int k = 1; k < 7; k++)
+		{
+			palette[k + 1] = (float)(((7 - k) * alpha0 + k * alpha1) / 7);
+		}
+
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			uint64_t best = 0;
+			float bestDistance = std::fabs(pAlpha[i] - palette[0]);
+			for (uint64_t entry = 1; entry < 8; entry++)
+			{
+				const float distance = std::fabs(pAlpha[i] - palette[entry]);
+				if (distance < bestDistance)
+				{
+					best = entry;
+					bestDistance = distance;
+				}
+			}
+			indices |= best << (i * 3);
+		}
+	}
+
+	pOutput[0] = (unsigned char)alpha0;
+	pOutput[1] = (unsigned char)alpha1;
+	for (int i = 0; i < 6; i++)
+	{
+		pOutput[2 + i] = (unsigned char)((indices >> (i * 8)) & 0xFF);
+	}
+}
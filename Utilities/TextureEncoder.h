@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureencoder.h
+// ============
+// build the mip chain of a texture image and encode its levels into
+// the block compressed formats the texture arrays are stored in
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  TextureEncoder
+ *
+ *  This class contains the code for turning a decoded RGBA
+ *  image into the data of every mip level in one of the
+ *  texture formats.  The levels are box filtered down to
+ *  1x1 and stored one after the other, the largest first.
+ *  BC1 stores every 4x4 block of colors in 8 bytes as two
+ *  565 endpoints with 2-bit indices between them, and BC3
+ *  adds 8 bytes of alpha with two 8-bit endpoints and 3-bit
+ *  indices.  The endpoints are fitted along the principal
+ *  axis of the colors of the block.  An encoder can be used
+ *  by one thread at a time, so every thread needs its own.
+ ***********************************************************/
+class TextureEncoder
+{
+public:
+	// the formats the levels can be encoded in
+	enum FORMAT
+	{
+		FORMAT_RGBA8 = 0,	// uncompressed, 4 bytes per texel
+		FORMAT_BC1,			// opaque colors, 8 bytes per block
+		FORMAT_BC3			// colors with alpha, 16 bytes per block
+	};
+
+	// constructor
+	TextureEncoder();
+
+	// number of levels of the full mip chain down to 1x1
+	static int GetLevelCount(int width, int height);
+	// size of one level, the level size is halved from the
+	// passed in image size for every level
+	static size_t GetLevelBytes(FORMAT format, int width, int height, int level);
+	// size of the full mip chain
+	static size_t GetChainBytes(FORMAT format, int width, int height);
+
+	// build and encode the full mip chain of the passed in
+	// RGBA image into pOutput, which holds GetChainBytes()
+	void EncodeChain(
+		FORMAT format,
+		const unsigned char* pPixels,
+		int width,
+		int height,
+		unsigned char* pOutput);
+
+private:
+	// the two halves of the mip level being filtered
+	std::vector<unsigned char> m_levels[2];
+
+	// encode one RGBA level
+	void EncodeLevel(
+		FORMAT format,
+		const unsigned char* pPixels,
+		int width,
+		int height,
+		unsigned char* pOutput);
+	// filter a level down to the next one
+	void Downsample(
+		const unsigned char* pPixels,
+		int width,
+		int height,
+		unsigned char* pOutput);
+
+	// encode the colors or the alphas of a 4x4 block, the
+	// channels are passed as separate arrays of 16 values
+	void EncodeColorBlock(
+		const float* pRed,
+		const float* pGreen,
+		const float* pBlue,
+		unsigned char* pOutput);
+	void EncodeAlphaBlock(
+		const float* pAlpha,
+		unsigned char* pOutput);
+};
@@ -0,0 +1,294 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformcache.cpp
+// ============
+// keep the model matrices of a hierarchy of objects and recalculate
+// only the ones whose scale, rotation or position, or whose parent's
+// matrix, changed
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// number of matrices recalculated together, small enough
+	// for the working arrays to stay in the cache
+	const size_t g_BatchSize = 256;
+	const float g_DegreesToRadians = 3.14159265358979f / 180.0f;
+}
+
+const size_t TransformCache::NoParent;
+
+/***********************************************************
+ *  TransformCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformCache::TransformCache()
+{
+	m_firstDirty = 0;
+	for (int k = 0; k < 3; k++)
+	{
+		m_batchAngles[k].resize(g_BatchSize);
+		m_batchScale[k].resize(g_BatchSize);
+		m_batchCos[k].resize(g_BatchSize);
+		m_batchSin[k].resize(g_BatchSize);
+	}
+	for (int k = 0; k < 9; k++)
+	{
+		m_batchTerms[k].resize(g_BatchSize);
+	}
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every transform.
+ ***********************************************************/
+void TransformCache::Clear()
+{
+	for (int k = 0; k < 3; k++)
+	{
+		m_scale[k].clear();
+		m_rotation[k].clear();
+		m_position[k].clear();
+	}
+	m_parent.clear();
+	m_localMatrices.clear();
+	m_matrices.clear();
+	m_bDirty.clear();
+	m_dirty.clear();
+	m_bMoved.clear();
+	m_moved.clear();
+	m_firstDirty = 0;
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for adding a transform at the end of
+ *  the cache.  A parent that was not added before is
+ *  ignored, which keeps the parents ahead of their children.
+ ***********************************************************/
+size_t TransformCache::Add(
+	const glm::vec3& scale,
+	const glm::vec3& rotation,
+	const glm::vec3& position,
+	size_t parent)
+{
+	size_t index = m_matrices.size();
+
+	if (m_dirty.empty() == true)
+	{
+		m_firstDirty = index;
+	}
+
+	for (int k = 0; k < 3; k++)
+	{
+		m_scale[k].push_back(scale[k]);
+		m_rotation[k].push_back(rotation[k]);
+		m_position[k].push_back(position[k]);
+	}
+	m_parent.push_back((parent < index) ? parent : NoParent);
+	m_localMatrices.push_back(glm::mat4(1.0f));
+	m_matrices.push_back(glm::mat4(1.0f));
+	m_bDirty.push_back(1);
+	m_dirty.push_back(index);
+	m_bMoved.push_back(0);
+
+	return(index);
+}
+
+/***********************************************************
+ *  Set()
+ *
+ *  This method is used for changing a transform.  Setting
+ *  the values it already has does not flag it.
+ ***********************************************************/
+void TransformCache::Set(
+	size_t index,
+	const glm::vec3& scale,
+	const glm::vec3& rotation,
+	const glm::vec3& position)
+{
+	if (index >= m_matrices.size())
+	{
+		return;
+	}
+
+	bool bChanged = false;
+	for (int k = 0; k < 3; k++)
+	{
+		bChanged = bChanged ||
+			(m_scale[k][index] != scale[k]) ||
+			(m_rotation[k][index] != rotation[k]) ||
+			(m_position[k][index] != position[k]);
+		m_scale[k][index] = scale[k];
+		m_rotation[k][index] = rotation[k];
+		m_position[k][index] = position[k];
+	}
+
+	if ((bChanged == true) && (m_bDirty[index] == 0))
+	{
+		m_firstDirty = (m_dirty.empty() == true) ? index : (std::min)(m_firstDirty, index);
+		m_bDirty[index] = 1;
+		m_dirty.push_back(index);
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for recalculating the matrices of
+ *  the flagged transforms.  Every batch gathers its inputs
+ *  into contiguous arrays, and the sines, cosines and the
+ *  scaled rotation terms are each calculated in a simple
+ *  loop over those arrays, which the compiler can turn into
+ *  SIMD code, before the results are written to the local
+ *  matrices.  The rotation is expanded in closed form
+ *  instead of multiplying the five matrices.  The final
+ *  matrices are then recalculated in one pass from the
+ *  first flagged transform, for the flagged transforms and
+ *  the transforms whose parent moved, so only the changed
+ *  subtrees are multiplied out.
+ ***********************************************************/
+size_t TransformCache::Update()
+{
+	m_moved.clear();
+
+	const size_t nDirty = m_dirty.size();
+	if (nDirty == 0)
+	{
+		return(0);
+	}
+
+	for (size_t first = 0; first < nDirty; first += g_BatchSize)
+	{
+		const size_t count = (std::min)(g_BatchSize, nDirty - first);
+		const size_t* pIndices = &m_dirty[first];
+
+		for (int k = 0; k < 3; k++)
+		{
+			float* pAngles = &m_batchAngles[k][0];
+			float* pScale = &m_batchScale[k][0];
+			const float* pRotation = &m_rotation[k][0];
+			const float* pScaleIn = &m_scale[k][0];
+			for (size_t i = 0; i < count; i++)
+			{
+				pAngles[i] = pRotation[pIndices[i]] * g_DegreesToRadians;
+				pScale[i] = pScaleIn[pIndices[i]];
+			}
+		}
+
+		for (int k = 0; k < 3; k++)
+		{
+			const float* pAngles = &m_batchAngles[k][0];
+			float* pCos = &m_batchCos[k][0];
+			float* pSin = &m_batchSin[k][0];
+			for (size_t i = 0; i < count; i++)
+			{
+				pCos[i] = std::cos(pAngles[i]);
+				pSin[i] = std::sin(pAngles[i]);
+			}
+		}
+
+		// rotationX * rotationY * rotationZ, each column
+		// multiplied by the scale along its axis
+		const float* ca = &m_batchCos[0][0];
+		const float* sa = &m_batchSin[0][0];
+		const float* cb = &m_batchCos[1][0];
+		const float* sb = &m_batchSin[1][0];
+		const float* cc = &m_batchCos[2][0];
+		const float* sc = &m_batchSin[2][0];
+		const float* sx = &m_batchScale[0][0];
+		const float* sy = &m_batchScale[1][0];
+		const float* sz = &m_batchScale[2][0];
+		float* t[9];
+		for (int k = 0; k < 9; k++)
+		{
+			t[k] = &m_batchTerms[k][0];
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			t[0][i] = (cb[i] * cc[i]) * sx[i];
+			t[1][i] = (ca[i] * sc[i] + sa[i] * sb[i] * cc[i]) * sx[i];
+			t[2][i] = (sa[i] * sc[i] - ca[i] * sb[i] * cc[i]) * sx[i];
+			t[3][i] = (-cb[i] * sc[i]) * sy[i];
+			t[4][i] = (ca[i] * cc[i] - sa[i] * sb[i] * sc[i]) * sy[i];
+			t[5][i] = (sa[i] * cc[i] + ca[i] * sb[i] * sc[i]) * sy[i];
+			t[6][i] = sb[i] * sz[i];
+			t[7][i] = (-sa[i] * cb[i]) * sz[i];
+			t[8][i] = (ca[i] * cb[i]) * sz[i];
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const size_t index = pIndices[i];
+			glm::mat4& matrix = m_localMatrices[index];
+
+			matrix[0] = glm::vec4(t[0][i], t[1][i], t[2][i], 0.0f);
+			matrix[1] = glm::vec4(t[3][i], t[4][i], t[5][i], 0.0f);
+			matrix[2] = glm::vec4(t[6][i], t[7][i], t[8][i], 0.0f);
+			matrix[3] = glm::vec4(m_position[0][index], m_position[1][index], m_position[2][index], 1.0f);
+		}
+	}
+
+	// the flags of the transforms before the first flagged
+	// one are stale, but none of them moved
+	size_t nMoved = 0;
+	for (size_t index = m_firstDirty; index < m_matrices.size(); index++)
+	{
+		const size_t parent = m_parent[index];
+		const bool bParentMoved = (parent != NoParent) && (parent >= m_firstDirty) && (m_bMoved[parent] != 0);
+
+		m_bMoved[index] = ((m_bDirty[index] != 0) || (bParentMoved == true)) ? 1 : 0;
+		if (m_bMoved[index] == 0)
+		{
+			continue;
+		}
+
+		if (parent == NoParent)
+		{
+			m_matrices[index] = m_localMatrices[index];
+		}
+		else
+		{
+			m_matrices[index] = m_matrices[parent] * m_localMatrices[index];
+		}
+		m_bDirty[index] = 0;
+		m_moved.push_back(index);
+		nMoved++;
+	}
+
+	m_dirty.clear();
+	return(nMoved);
+}
+
+/***********************************************************
+ *  Compose()
+ *
+ *  This method is used for calculating a single model
+ *  matrix with the same closed form Update() uses.
+ ***********************************************************/
+glm::mat4 TransformCache::Compose(
+	const glm::vec3& scale,
+	const glm::vec3& rotation,
+	const glm::vec3& position)
+{
+	const float ca = std::cos(rotation.x * g_DegreesToRadians);
+	const float sa = std::sin(rotation.x * g_DegreesToRadians);
+	const float cb = std::cos(rotation.y * g_DegreesToRadians);
+	const float sb = std::sin(rotation.y * g_DegreesToRadians);
+	const float cc = std::cos(rotation.z * g_DegreesToRadians);
+	const float sc = std::sin(rotation.z * g_DegreesToRadians);
+
+	glm::mat4 matrix;
+	matrix[0] = glm::vec4(cb * cc, ca * sc + sa * sb * cc, sa * sc - ca * sb * cc, 0.0f) * scale.x;
+	matrix[1] = glm::vec4(-cb * sc, ca * cc - sa * sb * sc, sa * cc + ca * sb * sc, 0.0f) * scale.y;
+	matrix[2] = glm::vec4(sb, -sa * cb, ca * cb, 0.0f) * scale.z;
+	matrix[3] = glm::vec4(position, 1.0f);
+	return(matrix);
+}
@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformcache.h
+// ============
+// keep the model matrices of a hierarchy of objects and recalculate
+// only the ones whose scale, rotation or position, or whose parent's
+// matrix, changed
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  TransformCache
+ *
+ *  This class contains the code for caching model matrices.
+ *  The scale, rotation and position of every transform are
+ *  stored as separate arrays of floats, and a changed
+ *  transform is only flagged until Update() recalculates
+ *  the flagged matrices together.  A transform can be
+ *  placed relative to a parent added before it, so the
+ *  array is always sorted with parents first and a single
+ *  pass in order moves the children of changed transforms.
+ *  The matrices are stored contiguously in the order the
+ *  transforms were added, so a run of them can be passed
+ *  to an instanced draw.
+ ***********************************************************/
+class TransformCache
+{
+public:
+	// the parent of a transform that is not in a hierarchy
+	static const size_t NoParent = (size_t)-1;
+
+	// constructor
+	TransformCache();
+
+	// remove every transform
+	void Clear();
+	// add a transform, returns its index - the parent must
+	// have been added before, and the matrix is calculated
+	// by the next Update()
+	size_t Add(
+		const glm::vec3& scale,
+		const glm::vec3& rotation,
+		const glm::vec3& position,
+		size_t parent = NoParent);
+	// change a transform, the matrix is recalculated by the
+	// next Update()
+	void Set(
+		size_t index,
+		const glm::vec3& scale,
+		const glm::vec3& rotation,
+		const glm::vec3& position);
+	// recalculate the matrices of the changed transforms and
+	// of their children, returns the number of recalculated
+	// matrices
+	size_t Update();
+
+	size_t GetCount() const { return(m_matrices.size()); }
+	const glm::mat4* GetMatrices() const { return(m_matrices.empty() ? NULL : &m_matrices[0]); }
+	const glm::mat4& GetMatrix(size_t index) const { return(m_matrices[index]); }
+	size_t GetParent(size_t index) const { return(m_parent[index]); }
+	// the transforms whose matrix the last Update() recalculated
+	const std::vector<size_t>& GetMoved() const { return(m_moved); }
+
+	// calculate translation * rotationX * rotationY * rotationZ
+	// * scale, with the rotations in degrees
+	static glm::mat4 Compose(
+		const glm::vec3& scale,
+		const glm::vec3& rotation,
+		const glm::vec3& position);
+
+private:
+	// the transform values, one array per component
+	std::vector<float> m_scale[3];
+	std::vector<float> m_rotation[3];
+	std::vector<float> m_position[3];
+
+	std::vector<size_t> m_parent;
+
+	// the matrices relative to the parents and the final
+	// matrices, the flags of the changed transforms, the list
+	// of their indices and the first of them
+	std::vector<glm::mat4> m_localMatrices;
+	std::vector<glm::mat4> m_matrices;
+	std::vector<unsigned char> m_bDirty;
+	std::vector<size_t> m_dirty;
+	size_t m_firstDirty;
+	// set while updating for the transforms whose final
+	// matrix was recalculated, and the list of them
+	std::vector<unsigned char> m_bMoved;
+	std::vector<size_t> m_moved;
+
+	// working arrays of one batch of recalculated matrices,
+	// the gathered inputs and the scaled rotation terms
+	std::vector<float> m_batchAngles[3];
+	std::vector<float> m_batchScale[3];
+	std::vector<float> m_batchCos[3];
+	std::vector<float> m_batchSin[3];
+	std::vector<float> m_batchTerms[9];
+};
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+// workerpool.cpp
+// ============
+// run tasks on a fixed set of background threads and hand their
+// results back to the main thread
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "WorkerPool.h"
+
+/***********************************************************
+ *  WorkerPool()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+WorkerPool::WorkerPool(unsigned int nThreads)
+{
+	m_bStopping = false;
+
+	if (nThreads == 0)
+	{
+		nThreads = std::thread::hardware_concurrency();
+	}
+	if (nThreads == 0)
+	{
+		nThreads = 1;
+	}
+
+	for (unsigned int i = 0; i < nThreads; i++)
+	{
+		m_threads.push_back(std::thread(&WorkerPool::WorkerLoop, this));
+	}
+}
+
+/***********************************************************
+ *  ~WorkerPool()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_condition.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queueing a task to run on the
+ *  next free thread.
+ ***********************************************************/
+void WorkerPool::Submit(const std::function<void()>& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.push_back(task);
+	}
+	m_condition.notify_one();
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is used for running queued tasks on a pool
+ *  thread.  The queue is drained before the thread exits.
+ ***********************************************************/
+void WorkerPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this] { return((m_bStopping == true) || (m_tasks.empty() == false)); });
+			if (m_tasks.empty() == true)
+			{
+				return;
+			}
+			task = m_tasks.front();
+			m_tasks.pop_front();
+		}
+		task();
+	}
+}
@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+// workerpool.h
+// ============
+// run tasks on a fixed set of background threads and hand their
+// results back to the main thread
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  WorkerPool
+ *
+ *  This class contains the code for running submitted tasks
+ *  on background threads in the order they were submitted.
+ *  Destroying the pool waits for every submitted task.
+ ***********************************************************/
+class WorkerPool
+{
+public:
+	// constructor - zero threads uses one per hardware thread
+	WorkerPool(unsigned int nThreads = 0);
+	// destructor
+	~WorkerPool();
+
+	// queue a task to run on one of the threads
+	void Submit(const std::function<void()>& task);
+
+	unsigned int GetThreadCount() const { return((unsigned int)m_threads.size()); }
+
+private:
+	// the pool can not be copied
+	WorkerPool(const WorkerPool&);
+	WorkerPool& operator=(const WorkerPool&);
+
+	// run queued tasks until the pool is destroyed
+	void WorkerLoop();
+
+	std::vector<std::thread> m_threads;
+	std::deque<std::function<void()> > m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_bStopping;
+};
+
+/***********************************************************
+ *  CompletionQueue
+ *
+ *  This class contains the code for passing finished work
+ *  from the worker threads to the thread that consumes it,
+ *  such as the thread owning the OpenGL context.
+ ***********************************************************/
+template<typename T>
+class CompletionQueue
+{
+public:
+	// add a finished item, from any thread
+	void Push(const T& item)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_items.push_back(item);
+		}
+		m_condition.notify_one();
+	}
+
+	// wait for the next finished item
+	T Pop()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this] { return(m_items.empty() == false); });
+		T item = m_items.front();
+		m_items.pop_front();
+		return(item);
+	}
+
+	// take the next finished item if there is one
+	bool TryPop(T& item)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_items.empty() == true)
+		{
+			return(false);
+		}
+		item = m_items.front();
+		m_items.pop_front();
+		return(true);
+	}
+
+private:
+	std::deque<T> m_items;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+};
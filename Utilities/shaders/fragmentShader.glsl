@@ -20,27 +20,115 @@ struct LightSource
 };
 
 #define TOTAL_LIGHTS 4
+// size of the material table, matching the scene manager
+#define MAX_MATERIALS 64
+
+// per-draw data of the multi-draw indirect path, matching the
+// vertex shader
+struct DrawData
+{
+   mat4 model;
+   vec4 color;
+   vec2 UVscale;
+   int materialIndex;    // index into the material table, -1 for none
+   int textureLayer;     // layer in the bound texture array
+   vec4 atlasRect;       // rectangle of the layer the texture covers
+   float atlasMaxLod;    // last level of the array it is drawn from
+};
+
+// one material of the material table
+struct MaterialData
+{
+   vec4 ambientColor;    // w holds the ambient strength
+   vec4 diffuseColor;
+   vec4 specularColor;   // w holds the shininess
+};
+
+// every material of the scene, uploaded once and selected by index
+layout (std140, binding = 1) uniform MaterialBuffer
+{
+   MaterialData materials[MAX_MATERIALS];
+};
+
+layout (std430, binding = 0) readonly buffer DrawDataBuffer
+{
+   DrawData drawData[];
+};
 
 in vec3 fragmentPosition;
 in vec3 fragmentVertexNormal;
 in vec2 fragmentTextureCoordinate;
+in vec4 fragmentInstanceColor;
+flat in int fragmentDrawIndex;
 
 out vec4 outFragmentColor;
 
 uniform bool bUseTexture=false;
 uniform bool bUseLighting=false;
 uniform vec4 objectColor = vec4(1.0f);
-uniform sampler2D objectTexture;
+uniform bool bUseInstanceColor = false;
+uniform bool bUseIndirectDraws = false;
+// the textures are layers of texture arrays, one per image size
+uniform sampler2DArray objectTexture;
+uniform int textureLayer = 0;
+// the rectangle of the layer the texture covers, which is only
+// part of it for the images of an atlas page, and the last level
+// the texture is drawn from
+uniform vec4 atlasRect = vec4(0.0f, 0.0f, 1.0f, 1.0f);
+uniform float atlasMaxLod = 1000.0f;
 uniform vec3 viewPosition;
 uniform vec2 UVscale = vec2(1.0f, 1.0f);
 uniform LightSource lightSources[TOTAL_LIGHTS];
-uniform Material material;
+// material of the draw, -1 for none
+uniform int materialIndex = -1;
 
 // function prototypes
-vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+vec3 CalcLightSource(LightSource light, Material surface, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+vec4 SampleTexture(vec2 coordinate, int layer, vec4 rect, float maxLod);
 
 void main()
 {
+   // instanced draws can give every instance its own color
+   vec4 color = objectColor;
+   if(bUseInstanceColor == true)
+   {
+      color = fragmentInstanceColor;
+   }
+
+   // indirect draws read their color, UV scale, material and
+   // texture from the per-draw data instead of the uniforms
+   vec2 textureScale = UVscale;
+   int surfaceIndex = materialIndex;
+   int layer = textureLayer;
+   vec4 rect = atlasRect;
+   float maxLod = atlasMaxLod;
+   if(bUseIndirectDraws == true)
+   {
+      color = drawData[fragmentDrawIndex].color;
+      textureScale = drawData[fragmentDrawIndex].UVscale;
+      surfaceIndex = drawData[fragmentDrawIndex].materialIndex;
+      layer = drawData[fragmentDrawIndex].textureLayer;
+      rect = drawData[fragmentDrawIndex].atlasRect;
+      maxLod = drawData[fragmentDrawIndex].atlasMaxLod;
+   }
+
+   vec4 textureColor = vec4(1.0f);
+   if(bUseTexture == true)
+   {
+      textureColor = SampleTexture(fragmentTextureCoordinate * textureScale, layer, rect, maxLod);
+   }
+
+   // draws without a material get no material lighting
+   Material surface = Material(vec3(0.0f), 0.0f, vec3(0.0f), vec3(0.0f), 0.0f);
+   if((surfaceIndex >= 0) && (surfaceIndex < MAX_MATERIALS))
+   {
+      surface.ambientColor = materials[surfaceIndex].ambientColor.xyz;
+      surface.ambientStrength = materials[surfaceIndex].ambientColor.w;
+      surface.diffuseColor = materials[surfaceIndex].diffuseColor.xyz;
+      surface.specularColor = materials[surfaceIndex].specularColor.xyz;
+      surface.shininess = materials[surfaceIndex].specularColor.w;
+   }
+
    if(bUseLighting == true)
    {
       // properties
@@ -50,34 +138,46 @@ void main()
 
       for(int i = 0; i < TOTAL_LIGHTS; i++)
       {
-         phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection); 
+         phongResult += CalcLightSource(lightSources[i], surface, lightNormal, fragmentPosition, viewDirection); 
       }   
     
       if(bUseTexture == true)
       {
-         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
          outFragmentColor = vec4(phongResult * textureColor.xyz, textureColor.a);
       }
       else
       {
-         outFragmentColor = vec4(phongResult * objectColor.xyz, objectColor.w);
+         outFragmentColor = vec4(phongResult * color.xyz, color.w);
       }
    }
    else 
    {
       if(bUseTexture == true)
       {
-         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         outFragmentColor = textureColor;
       }
       else
       {
-         outFragmentColor = objectColor;
+         outFragmentColor = color;
       }
    }
 }
 
+// samples the texture of the draw in its rectangle of the layer,
+// repeating it there rather than with the wrap mode, since the
+// rectangle is only part of the layer for atlas images.  The level
+// is picked from the coordinates before they are wrapped, so the
+// seams of the repeat do not jump to the smallest level, and kept
+// to the levels the border around an atlas image keeps clean
+vec4 SampleTexture(vec2 coordinate, int layer, vec4 rect, float maxLod)
+{
+   float lod = min(textureQueryLod(objectTexture, coordinate * rect.zw).y, maxLod);
+   vec2 rectCoordinate = rect.xy + fract(coordinate) * rect.zw;
+   return(textureLod(objectTexture, vec3(rectCoordinate, float(layer)), lod));
+}
+
 // calculates the color when using a directional light.
-vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+vec3 CalcLightSource(LightSource light, Material surface, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
 {
    vec3 ambient;
    vec3 diffuse;
@@ -85,7 +185,7 @@ vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, v
 
    //**Calculate Ambient lighting**
 
-   ambient = light.ambientColor + (material.ambientColor * material.ambientStrength);
+   ambient = light.ambientColor + (surface.ambientColor * surface.ambientStrength);
 
    //**Calculate Diffuse lighting**
 
@@ -94,7 +194,7 @@ vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, v
    // Calculate diffuse impact by generating dot product of normal and light
    float impact = max(dot(lightNormal, lightDirection), 0.0);
    // Generate diffuse material color   
-   diffuse = impact * material.diffuseColor; 
+   diffuse = impact * surface.diffuseColor; 
 
    //**Calculate Specular lighting**
 
@@ -102,7 +202,7 @@ vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, v
    vec3 reflectDir = reflect(-lightDirection, lightNormal);
    // Calculate specular component
    float specularComponent = pow(max(dot(viewDirection, reflectDir), 0.0), light.focalStrength);
-   specular = (light.specularIntensity * material.shininess) * specularComponent * material.specularColor;
+   specular = (light.specularIntensity * surface.shininess) * specularComponent * surface.specularColor;
   
    return(ambient + diffuse + specular);
 }
\ No newline at end of file
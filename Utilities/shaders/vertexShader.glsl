@@ -1,20 +1,72 @@
-#version 330 core
+#version 440 core
+// gl_DrawIDARB is only available with the draw parameters extension,
+// without it the multi-draw indirect path is never used
+#extension GL_ARB_shader_draw_parameters : enable
 layout (location = 0) in vec3 inVertexPosition;
+// the normal and texture coordinate are either floats or, in the
+// compact vertex format, normalized 2_10_10_10 integers and half
+// floats - both are expanded to floats before reaching the shader
 layout (location = 1) in vec3 inVertexNormal;
 layout (location = 2) in vec2 inTextureCoordinate;
+// per-instance model transform (locations 3 to 6) and color,
+// only read by instanced draws
+layout (location = 3) in mat4 inInstanceModel;
+layout (location = 7) in vec4 inInstanceColor;
+
+// per-draw data of the multi-draw indirect path, also read by the
+// fragment shader for the color, UV scale, material and texture
+// layer and rectangle of the draw
+struct DrawData
+{
+   mat4 model;
+   vec4 color;
+   vec2 UVscale;
+   int materialIndex;    // index into the material table, -1 for none
+   int textureLayer;     // layer in the bound texture array
+   vec4 atlasRect;       // rectangle of the layer the texture covers
+   float atlasMaxLod;    // last level of the array it is drawn from
+};
+
+layout (std430, binding = 0) readonly buffer DrawDataBuffer
+{
+   DrawData drawData[];
+};
 
 out vec3 fragmentPosition;
 out vec3 fragmentVertexNormal;
 out vec2 fragmentTextureCoordinate;
+out vec4 fragmentInstanceColor;
+flat out int fragmentDrawIndex;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform bool bUseInstancing = false;
+uniform bool bUseIndirectDraws = false;
+// index of the first draw of the current multi-draw call
+uniform int firstDrawIndex = 0;
 
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = inVertexNormal;
+   mat4 modelMatrix = model;
+   if(bUseInstancing == true)
+   {
+      modelMatrix = inInstanceModel;
+   }
+
+   fragmentDrawIndex = 0;
+#ifdef GL_ARB_shader_draw_parameters
+   if(bUseIndirectDraws == true)
+   {
+      fragmentDrawIndex = firstDrawIndex + gl_DrawIDARB;
+      modelMatrix = drawData[fragmentDrawIndex].model;
+   }
+#endif
+
+   fragmentPosition = vec3(modelMatrix * vec4(inVertexPosition, 1.0));
+   gl_Position = projection * view * modelMatrix * vec4(inVertexPosition, 1.0f);
+   // renormalize to remove the quantization error of packed normals
+   fragmentVertexNormal = normalize(inVertexNormal);
    fragmentTextureCoordinate = inTextureCoordinate;
+   fragmentInstanceColor = inInstanceColor;
 }
\ No newline at end of file